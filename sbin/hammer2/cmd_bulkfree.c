@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2011-2013 The DragonFly Project.  All rights reserved.
+ *
+ * This code is derived from software contributed to The DragonFly Project
+ * by Matthew Dillon <dillon@dragonflybsd.org>
+ * by Venkatesh Srinivas <vsrinivas@dragonflybsd.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of The DragonFly Project nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific, prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "hammer2.h"
+
+/*
+ * Run a bulkfree pass on the filesystem containing path.  memstr
+ * optionally limits the kernel ram used by the scan ([k|m|g] suffix).
+ *
+ * Blocks are staged as possibly-free by one pass and actually freed by
+ * a later pass, with at least one filesystem sync in between.
+ */
+int
+cmd_bulkfree(const char *path, const char *memstr)
+{
+	hammer2_ioc_bulkfree_t bfi;
+	char *ptr;
+	int ecode = 0;
+	int fd;
+
+	bzero(&bfi, sizeof(bfi));
+	if (memstr) {
+		bfi.size = strtoull(memstr, &ptr, 0);
+		switch(*ptr) {
+		case 'g':
+		case 'G':
+			bfi.size *= 1024;
+			/* fall through */
+		case 'm':
+		case 'M':
+			bfi.size *= 1024;
+			/* fall through */
+		case 'k':
+		case 'K':
+			bfi.size *= 1024;
+			++ptr;
+			break;
+		default:
+			break;
+		}
+		if (*ptr) {
+			fprintf(stderr, "bulkfree: bad memory limit %s\n",
+				memstr);
+			return 1;
+		}
+	}
+
+	fd = hammer2_ioctl_handle(path);
+	if (fd < 0)
+		return 1;
+	if (ioctl(fd, HAMMER2IOC_BULKFREE_SCAN, &bfi) < 0) {
+		perror("ioctl");
+		ecode = 1;
+	} else {
+		printf("bulkfree: %ju referenced, %ju staged, %ju freed, "
+		       "%ju restored, %ju fixups, %ju zones spooled\n",
+		       (uintmax_t)bfi.count_referenced,
+		       (uintmax_t)bfi.count_staged,
+		       (uintmax_t)bfi.count_freed,
+		       (uintmax_t)bfi.count_restored,
+		       (uintmax_t)bfi.count_fixups,
+		       (uintmax_t)bfi.count_spilled);
+	}
+	close(fd);
+	return ecode;
+}
@@ -0,0 +1,277 @@
+/*	$OpenBSD$	*/
+
+/*
+ * Compression benchmark for the hammer2 utility.
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "hammer2.h"
+
+#include <zlib.h>
+#define ZSTD_STATIC_LINKING_ONLY
+#include <lib/libzstd/zstd.h>
+
+#define COMPBENCH_BLKSIZE	HAMMER2_PBUFSIZE
+
+struct compbench {
+	const char	*name;
+	int		level;
+	uint64_t	raw;		/* logical bytes */
+	uint64_t	phys;		/* bytes hammer2 would allocate */
+	double		ctime;		/* seconds compressing */
+	double		dtime;		/* seconds decompressing */
+};
+
+static double
+compbench_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec + ts.tv_nsec / 1e9);
+}
+
+/*
+ * Physical allocation for a compressed block, as done by the write
+ * path: the block is stored uncompressed unless it fits in half of the
+ * logical size, and small results are packed in 1KB units.
+ */
+static uint64_t
+compbench_phys(size_t csize)
+{
+	size_t bsize;
+
+	if (csize == 0)
+		return (COMPBENCH_BLKSIZE);
+	if (csize <= HAMMER2_FREEMAP_BLOCK_SIZE)
+		return (roundup(csize, HAMMER2_ALLOC_MIN));
+	for (bsize = HAMMER2_FREEMAP_BLOCK_SIZE; bsize < csize; bsize <<= 1)
+		;
+	return (bsize);
+}
+
+static int
+compbench_zlib(struct compbench *cb, const char *src, size_t bytes,
+	       char *cbuf, char *dbuf)
+{
+	z_stream strm;
+	double t;
+	size_t csize;
+	int ret;
+
+	bzero(&strm, sizeof(strm));
+	t = compbench_now();
+	if (deflateInit(&strm, cb->level) != Z_OK)
+		return (1);
+	strm.next_in = (void *)(uintptr_t)src;
+	strm.avail_in = bytes;
+	strm.next_out = (void *)cbuf;
+	strm.avail_out = bytes / 2;
+	ret = deflate(&strm, Z_FINISH);
+	csize = (ret == Z_STREAM_END) ? bytes / 2 - strm.avail_out : 0;
+	deflateEnd(&strm);
+	cb->ctime += compbench_now() - t;
+
+	cb->raw += bytes;
+	cb->phys += compbench_phys(csize);
+	if (csize == 0)
+		return (0);
+
+	bzero(&strm, sizeof(strm));
+	t = compbench_now();
+	if (inflateInit(&strm) != Z_OK)
+		return (1);
+	strm.next_in = (void *)cbuf;
+	strm.avail_in = csize;
+	strm.next_out = (void *)dbuf;
+	strm.avail_out = bytes;
+	ret = inflate(&strm, Z_FINISH);
+	inflateEnd(&strm);
+	cb->dtime += compbench_now() - t;
+
+	if (ret != Z_STREAM_END || bcmp(src, dbuf, bytes) != 0)
+		return (1);
+	return (0);
+}
+
+/*
+ * Uses static contexts sized the same way as the kernel does, so a
+ * sizing error shows up here as a compression failure.
+ */
+static int
+compbench_zstd(struct compbench *cb, const char *src, size_t bytes,
+	       char *cbuf, char *dbuf, ZSTD_CCtx *cctx, ZSTD_DCtx *dctx)
+{
+	double t;
+	size_t csize;
+	size_t dsize;
+
+	t = compbench_now();
+	csize = ZSTD_compressCCtx(cctx, cbuf, bytes / 2, src, bytes,
+				  cb->level);
+	cb->ctime += compbench_now() - t;
+	if (ZSTD_isError(csize)) {
+		if (ZSTD_getErrorCode(csize) != ZSTD_error_dstSize_tooSmall)
+			return (1);
+		csize = 0;
+	}
+
+	cb->raw += bytes;
+	cb->phys += compbench_phys(csize);
+	if (csize == 0)
+		return (0);
+
+	/*
+	 * Decompress from the zero-padded physical block like the read
+	 * path does.
+	 */
+	bzero(cbuf + csize, compbench_phys(csize) - csize);
+	t = compbench_now();
+	csize = ZSTD_findFrameCompressedSize(cbuf, compbench_phys(csize));
+	dsize = ZSTD_decompressDCtx(dctx, dbuf, bytes, cbuf, csize);
+	cb->dtime += compbench_now() - t;
+
+	if (ZSTD_isError(dsize) || dsize != bytes ||
+	    bcmp(src, dbuf, bytes) != 0) {
+		return (1);
+	}
+	return (0);
+}
+
+static void
+compbench_print(struct compbench *cb)
+{
+	printf("%-5s %2d  %6.2f%%  %9.1f  %9.1f\n",
+	       cb->name, cb->level,
+	       cb->raw ? 100.0 * cb->phys / cb->raw : 0.0,
+	       cb->ctime > 0 ? cb->raw / cb->ctime / 1048576.0 : 0.0,
+	       cb->dtime > 0 ? cb->raw / cb->dtime / 1048576.0 : 0.0);
+}
+
+/*
+ * Round-trip the file through each compressor in 64KB blocks and report
+ * the space hammer2 would allocate and the compression and
+ * decompression rates.  The file is read into memory first.  Blocks
+ * which do not compress to half their size count at full size and are
+ * not decompressed, as in the filesystem.
+ */
+int
+cmd_compbench(const char *path)
+{
+	struct compbench *cbs;
+	struct compbench *cb;
+	struct stat st;
+	ZSTD_CCtx *cctx;
+	ZSTD_DCtx *dctx;
+	void *cwork;
+	void *dwork;
+	size_t csize;
+	size_t off;
+	size_t bytes;
+	char *data;
+	char *cbuf;
+	char *dbuf;
+	int ncbs;
+	int ecode;
+	int fd;
+	int i;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0 || fstat(fd, &st) < 0) {
+		fprintf(stderr, "compbench: %s: %s\n", path, strerror(errno));
+		return 1;
+	}
+	if (st.st_size < COMPBENCH_BLKSIZE) {
+		fprintf(stderr, "compbench: %s: need at least %d bytes\n",
+			path, COMPBENCH_BLKSIZE);
+		close(fd);
+		return 1;
+	}
+	bytes = st.st_size - st.st_size % COMPBENCH_BLKSIZE;
+	data = malloc(bytes);
+	cbuf = malloc(COMPBENCH_BLKSIZE);
+	dbuf = malloc(COMPBENCH_BLKSIZE);
+	if (data == NULL || cbuf == NULL || dbuf == NULL) {
+		fprintf(stderr, "compbench: out of memory\n");
+		exit(1);
+	}
+	if (read(fd, data, bytes) != (ssize_t)bytes) {
+		fprintf(stderr, "compbench: %s: short read\n", path);
+		close(fd);
+		return 1;
+	}
+	close(fd);
+
+	/*
+	 * zlib levels 6-9 and zstd levels 1-9, as accepted by setcomp.
+	 */
+	ncbs = 4 + 9;
+	cbs = calloc(ncbs, sizeof(*cbs));
+	for (i = 0; i < 4; ++i) {
+		cbs[i].name = "zlib";
+		cbs[i].level = 6 + i;
+	}
+	for (i = 0; i < 9; ++i) {
+		cbs[4 + i].name = "zstd";
+		cbs[4 + i].level = 1 + i;
+	}
+
+	csize = ZSTD_estimateCCtxSize_usingCParams(
+			ZSTD_getCParams(9, COMPBENCH_BLKSIZE, 0));
+	cwork = malloc(csize);
+	dwork = malloc(ZSTD_estimateDCtxSize());
+	cctx = ZSTD_initStaticCCtx(cwork, csize);
+	dctx = ZSTD_initStaticDCtx(dwork, ZSTD_estimateDCtxSize());
+	if (cctx == NULL || dctx == NULL) {
+		fprintf(stderr, "compbench: cannot set up zstd contexts\n");
+		exit(1);
+	}
+
+	ecode = 0;
+	printf("%s: %zu bytes, %d byte blocks\n",
+	       path, bytes, COMPBENCH_BLKSIZE);
+	printf("algo  lv   physical  comp MB/s  dcmp MB/s\n");
+	for (i = 0; i < ncbs; ++i) {
+		cb = &cbs[i];
+		for (off = 0; off < bytes; off += COMPBENCH_BLKSIZE) {
+			if (strcmp(cb->name, "zlib") == 0) {
+				ecode = compbench_zlib(cb, data + off,
+						       COMPBENCH_BLKSIZE,
+						       cbuf, dbuf);
+			} else {
+				ecode = compbench_zstd(cb, data + off,
+						       COMPBENCH_BLKSIZE,
+						       cbuf, dbuf,
+						       cctx, dctx);
+			}
+			if (ecode) {
+				fprintf(stderr,
+					"compbench: %s:%d round trip failed "
+					"at offset %zu\n",
+					cb->name, cb->level, off);
+				goto done;
+			}
+		}
+		compbench_print(cb);
+	}
+done:
+	free(cwork);
+	free(dwork);
+	free(cbs);
+	free(dbuf);
+	free(cbuf);
+	free(data);
+
+	return ecode;
+}
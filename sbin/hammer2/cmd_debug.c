@@ -358,12 +358,15 @@ static void show_bref(int fd, int tab, int bi, hammer2_blockref_t *bref,
 			int dofreemap);
 static void tabprintf(int tab, const char *ctl, ...);
 
+static uint32_t ShowVolFlags;	/* voldata.flags of the tree being shown */
+
 int
 cmd_show(const char *devpath, int dofreemap)
 {
 	hammer2_blockref_t broot;
 	hammer2_blockref_t best;
 	hammer2_media_data_t media;
+	uint32_t best_flags;
 	int fd;
 	int i;
 	int best_i;
@@ -379,6 +382,7 @@ cmd_show(const char *devpath, int dofreemap)
 	 * -vvv will show the tree for all four volume headers.
 	 */
 	best_i = -1;
+	best_flags = 0;
 	bzero(&best, sizeof(best));
 	for (i = 0; i < 4; ++i) {
 		bzero(&broot, sizeof(broot));
@@ -392,13 +396,18 @@ cmd_show(const char *devpath, int dofreemap)
 			if (best_i < 0 || best.mirror_tid < broot.mirror_tid) {
 				best_i = i;
 				best = broot;
+				best_flags = media.voldata.flags;
 			}
-			if (VerboseOpt >= 3)
+			if (VerboseOpt >= 3) {
+				ShowVolFlags = media.voldata.flags;
 				show_bref(fd, 0, i, &broot, dofreemap);
+			}
 		}
 	}
-	if (VerboseOpt < 3)
+	if (VerboseOpt < 3) {
+		ShowVolFlags = best_flags;
 		show_bref(fd, 0, best_i, &best, dofreemap);
+	}
 	close(fd);
 
 	return 0;
@@ -416,9 +425,11 @@ show_bref(int fd, int tab, int bi, hammer2_blockref_t *bref, int dofreemap)
 	int namelen;
 	int obrace = 1;
 	size_t bytes;
+	size_t cbytes;
 	const char *type_str;
 	char *str = NULL;
 	uint32_t cv;
+	uint64_t cv64;
 
 	switch(bref->type) {
 	case HAMMER2_BREF_TYPE_EMPTY:
@@ -458,6 +469,13 @@ show_bref(int fd, int tab, int bi, hammer2_blockref_t *bref, int dofreemap)
 
 	bytes = (size_t)1 << (bref->data_off & HAMMER2_OFF_MASK_RADIX);
 
+	/*
+	 * The check code of a packed block only covers its psize.
+	 */
+	cbytes = bytes;
+	if (ShowVolFlags & HAMMER2_VOLF_PACKED)
+		cbytes = HAMMER2_BREF_PSIZE(bref);
+
 	{
 		hammer2_off_t io_off;
 		hammer2_off_t io_base;
@@ -508,7 +526,7 @@ show_bref(int fd, int tab, int bi, hammer2_blockref_t *bref, int dofreemap)
 			printf("(meth %02x) ", bref->methods);
 			break;
 		case HAMMER2_CHECK_ISCSI32:
-			cv = hammer2_icrc32(&media, bytes);
+			cv = hammer2_icrc32(&media, cbytes);
 			if (bref->check.iscsi32.value != cv) {
 				printf("(icrc %02x:%08x/%08x) ",
 				       bref->methods,
@@ -519,7 +537,15 @@ show_bref(int fd, int tab, int bi, hammer2_blockref_t *bref, int dofreemap)
 			}
 			break;
 		case HAMMER2_CHECK_CRC64:
-			printf("(meth %02x) ", bref->methods);
+			cv64 = hammer2_crc64(&media, cbytes);
+			if (bref->check.crc64.value != cv64) {
+				printf("(crc64 %02x:%016jx/%016jx) ",
+				       bref->methods,
+				       (uintmax_t)bref->check.crc64.value,
+				       (uintmax_t)cv64);
+			} else {
+				printf("(meth %02x) ", bref->methods);
+			}
 			break;
 		case HAMMER2_CHECK_SHA192:
 			printf("(meth %02x) ", bref->methods);
@@ -0,0 +1,221 @@
+/*	$OpenBSD$	*/
+
+/*
+ * Device buffer (dio) index benchmark for the hammer2 utility.
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "hammer2.h"
+
+#include <sys/tree.h>
+
+/*
+ * Userland model of hammer2_io_getblk()/hammer2_io_putblk() lookups.
+ * The RB tree under one lock is the index hammer2_io.c used to have,
+ * the hash mirrors the current hmp->iohash (bucket count, hash function
+ * and per-bucket lock).  Both use pthread mutexes for their spinlocks.
+ */
+#define DIOBENCH_HASH_SIZE	1024		/* HAMMER2_IOHASH_SIZE */
+#define DIOBENCH_HASH_MASK	(DIOBENCH_HASH_SIZE - 1)
+#define DIOBENCH_LOOPS		1000000
+
+struct diobench_dio {
+	RB_ENTRY(diobench_dio) rbnode;
+	LIST_ENTRY(diobench_dio) hnext;
+	off_t		pbase;
+	u_int		refs;
+};
+
+static int
+diobench_cmp(struct diobench_dio *dio1, struct diobench_dio *dio2)
+{
+	if (dio1->pbase < dio2->pbase)
+		return (-1);
+	if (dio1->pbase > dio2->pbase)
+		return (1);
+	return (0);
+}
+
+RB_HEAD(diobench_tree, diobench_dio);
+RB_GENERATE_STATIC(diobench_tree, diobench_dio, rbnode, diobench_cmp);
+
+struct diobench_hash {
+	pthread_mutex_t	mtx;
+	LIST_HEAD(, diobench_dio) list;
+} __aligned(64);
+
+struct diobench {
+	int		hashed;
+	int		ndios;
+	pthread_mutex_t	treemtx;
+	struct diobench_tree tree;
+	struct diobench_hash *hash;
+	uint64_t	misses;
+};
+
+static struct diobench_hash *
+diobench_hashbucket(struct diobench *db, off_t pbase)
+{
+	int hv;
+
+	hv = (int)(pbase >> HAMMER2_LBUFRADIX) ^
+	     (int)(pbase >> (HAMMER2_LBUFRADIX + 10));
+	return (&db->hash[hv & DIOBENCH_HASH_MASK]);
+}
+
+/*
+ * One getblk/putblk pair: find the dio and bump its refs under the index
+ * lock, then drop the ref without the lock as hammer2_io_putblk() does.
+ */
+static void
+diobench_lookup(struct diobench *db, off_t pbase)
+{
+	struct diobench_hash *hash;
+	struct diobench_dio *dio;
+	struct diobench_dio key;
+
+	if (db->hashed) {
+		hash = diobench_hashbucket(db, pbase);
+		pthread_mutex_lock(&hash->mtx);
+		LIST_FOREACH(dio, &hash->list, hnext) {
+			if (dio->pbase == pbase)
+				break;
+		}
+		if (dio)
+			__sync_fetch_and_add(&dio->refs, 1);
+		pthread_mutex_unlock(&hash->mtx);
+	} else {
+		key.pbase = pbase;
+		pthread_mutex_lock(&db->treemtx);
+		dio = RB_FIND(diobench_tree, &db->tree, &key);
+		if (dio)
+			__sync_fetch_and_add(&dio->refs, 1);
+		pthread_mutex_unlock(&db->treemtx);
+	}
+	if (dio)
+		__sync_fetch_and_sub(&dio->refs, 1);
+	else
+		__sync_fetch_and_add(&db->misses, 1);
+}
+
+/*
+ * The dio picks come from a cheap xorshift generator so the random
+ * number source does not dominate the lookup cost.
+ */
+static void *
+diobench_thread(void *arg)
+{
+	struct diobench *db = arg;
+	uint32_t seed;
+	off_t pbase;
+	int i;
+
+	seed = arc4random() | 1;
+	for (i = 0; i < DIOBENCH_LOOPS; ++i) {
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+		pbase = (off_t)(seed % db->ndios) * HAMMER2_LBUFSIZE;
+		diobench_lookup(db, pbase);
+	}
+	return (NULL);
+}
+
+static double
+diobench_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec + ts.tv_nsec / 1e9);
+}
+
+/*
+ * Run DIOBENCH_LOOPS random lookups per thread over ndios cached dios
+ * (16KB apart) against the old RB tree and the hash, with 1, 2, 4, ...
+ * threads up to nthreads, and report lookups per second.
+ */
+int
+cmd_diobench(int nthreads, int ndios)
+{
+	struct diobench db;
+	struct diobench_hash *hash;
+	struct diobench_dio *dios;
+	pthread_t *tds;
+	double t;
+	int hashed;
+	int n;
+	int i;
+
+	if (nthreads < 1 || ndios < 1) {
+		fprintf(stderr, "diobench: bad thread or dio count\n");
+		return 1;
+	}
+	dios = calloc(ndios, sizeof(*dios));
+	tds = calloc(nthreads, sizeof(*tds));
+	bzero(&db, sizeof(db));
+	db.hash = calloc(DIOBENCH_HASH_SIZE, sizeof(*db.hash));
+	if (dios == NULL || tds == NULL || db.hash == NULL) {
+		fprintf(stderr, "diobench: out of memory\n");
+		exit(1);
+	}
+
+	db.ndios = ndios;
+	pthread_mutex_init(&db.treemtx, NULL);
+	RB_INIT(&db.tree);
+	for (i = 0; i < DIOBENCH_HASH_SIZE; ++i) {
+		pthread_mutex_init(&db.hash[i].mtx, NULL);
+		LIST_INIT(&db.hash[i].list);
+	}
+	for (i = 0; i < ndios; ++i) {
+		dios[i].pbase = (off_t)i * HAMMER2_LBUFSIZE;
+		RB_INSERT(diobench_tree, &db.tree, &dios[i]);
+		hash = diobench_hashbucket(&db, dios[i].pbase);
+		LIST_INSERT_HEAD(&hash->list, &dios[i], hnext);
+	}
+
+	printf("%d dios, %d lookups per thread\n", ndios, DIOBENCH_LOOPS);
+	printf("index   threads  Mlookups/s\n");
+	for (n = 1; ; n = (n * 2 < nthreads) ? n * 2 : nthreads) {
+		for (hashed = 0; hashed <= 1; ++hashed) {
+			db.hashed = hashed;
+			t = diobench_now();
+			for (i = 0; i < n; ++i)
+				pthread_create(&tds[i], NULL,
+					       diobench_thread, &db);
+			for (i = 0; i < n; ++i)
+				pthread_join(tds[i], NULL);
+			t = diobench_now() - t;
+			if (t <= 0)
+				t = 1e-9;
+			printf("%-6s  %7d  %10.2f\n",
+			       hashed ? "hash" : "rbtree", n,
+			       (double)n * DIOBENCH_LOOPS / t / 1e6);
+		}
+		if (n == nthreads)
+			break;
+	}
+	if (db.misses)
+		fprintf(stderr, "diobench: %ju lookups missed\n",
+			(uintmax_t)db.misses);
+
+	for (i = 0; i < DIOBENCH_HASH_SIZE; ++i)
+		pthread_mutex_destroy(&db.hash[i].mtx);
+	pthread_mutex_destroy(&db.treemtx);
+	free(db.hash);
+	free(tds);
+	free(dios);
+
+	return (db.misses ? 1 : 0);
+}
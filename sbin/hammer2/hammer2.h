@@ -160,6 +160,9 @@ int cmd_rsaenc(const char **keys, int nkeys);
 int cmd_rsadec(const char **keys, int nkeys);
 int cmd_setcomp(const char *comp_str, char **paths);
 int cmd_setcheck(const char *comp_str, char **paths);
+int cmd_bulkfree(const char *path, const char *memstr);
+int cmd_compbench(const char *path);
+int cmd_diobench(int nthreads, int ndios);
 
 /*
  * Misc functions
@@ -174,6 +177,7 @@ hammer2_key_t dirhash(const unsigned char *name, size_t len);
 
 uint32_t hammer2_icrc32(const void *buf, size_t size);
 uint32_t hammer2_icrc32c(const void *buf, size_t size, uint32_t crc);
+uint64_t hammer2_crc64(const void *buf, size_t size);
 
 void hammer2_shell_parse(dmsg_msg_t *msg, int unmanaged);
 void print_inode(char* inode_string);
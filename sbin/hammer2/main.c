@@ -393,6 +393,30 @@ main(int ac, char **av)
 		ecode = cmd_setcheck("crc64", &av[1]);
 	} else if (strcmp(av[0], "setsha192") == 0) {
 		ecode = cmd_setcheck("sha192", &av[1]);
+	} else if (strcmp(av[0], "bulkfree") == 0) {
+		if (ac < 2 || ac > 3) {
+			fprintf(stderr,
+				"bulkfree: requires path and optional "
+				"memory limit\n");
+			usage(1);
+		}
+		ecode = cmd_bulkfree(av[1], (ac == 3) ? av[2] : NULL);
+	} else if (strcmp(av[0], "compbench") == 0) {
+		if (ac != 2) {
+			fprintf(stderr,
+				"compbench: requires file path\n");
+			usage(1);
+		}
+		ecode = cmd_compbench(av[1]);
+	} else if (strcmp(av[0], "diobench") == 0) {
+		if (ac > 3) {
+			fprintf(stderr,
+				"diobench: requires optional thread and "
+				"dio counts\n");
+			usage(1);
+		}
+		ecode = cmd_diobench((ac >= 2) ? atoi(av[1]) : 4,
+				     (ac == 3) ? atoi(av[2]) : 16384);
 	} else if (strcmp(av[0], "printinode") == 0) {
 		if (ac != 2) {
 			fprintf(stderr,
@@ -466,7 +490,7 @@ usage(int code)
 		"    freemap devpath              "
 			"Raw hammer2 media dump\n"
 		"    setcomp comp[:level] path... "
-			"Set comp algo {none, autozero, lz4, zlib} & level\n"
+			"Set comp algo {none, autozero, lz4, zlib, zstd} & level\n"
 		"    setcheck check path...       "
 			"Set check algo {none, crc32, crc64, sha192}\n"
 		"    setcrc32 path...             "
@@ -475,6 +499,12 @@ usage(int code)
 			"Set check algo to crc64\n"
 		"    setsha192 path...            "
 			"Set check algo to sha192\n"
+		"    bulkfree path [memlimit]     "
+			"Run a bulk free scan\n"
+		"    compbench file               "
+			"Benchmark zlib and zstd on 64KB blocks\n"
+		"    diobench [threads [dios]]    "
+			"Benchmark the dio index (rbtree vs hash)\n"
 	);
 	exit(code);
 }
@@ -818,7 +818,8 @@ format_hammer2(int fd, hammer2_off_t total_space, hammer2_off_t free_space)
 	vol->aux_end = aux_base + AuxAreaSize;
 	vol->volu_size = total_space;
 	vol->version = Hammer2Version;
-	vol->flags = 0;
+	vol->flags = HAMMER2_VOLF_PACKED | HAMMER2_VOLF_FSYNCLOG |
+		     HAMMER2_VOLF_FREEHINT;
 
 	vol->fsid = Hammer2_VolFSID;
 	vol->fstype = Hammer2_FSType;
@@ -93,6 +93,7 @@
 #include <machine/intr.h>
 //#include <sys/namecache.h>
 #include <sys/objcache.h>
+#include <sys/pool.h>
 #include <dev/pci/drm/drm_atomic.h>
 
 #include <sys/dmsg.h>
@@ -123,6 +124,13 @@ typedef uint32_t hammer2_xid_t;
 
 #define M_HAMMER2 1001
 #define atomic_set_int(p, bits)         atomic_setbits_int(p,bits)
+#if defined(__amd64__)
+#define atomic_set_64(p, bits)          x86_atomic_setbits_u64(p,bits)
+#define atomic_clear_64(p, bits)        x86_atomic_clearbits_u64(p,bits)
+#else
+#define atomic_set_64(p, bits)          ((void)__sync_or_and_fetch(p,bits))
+#define atomic_clear_64(p, bits)        ((void)__sync_and_and_fetch(p,~(bits)))
+#endif
 
 #define VA_UID_UUID_VALID    0x0004  /* uuid fields also populated */
 #define VA_GID_UUID_VALID    0x0008  /* uuid fields also populated */
@@ -736,6 +744,7 @@ struct bioh2 {
  */
 RB_HEAD(hammer2_chain_tree, hammer2_chain);
 TAILQ_HEAD(h2_flush_list, hammer2_chain);
+TAILQ_HEAD(h2_flush_workq, hammer2_flush_work);
 
 #define CHAIN_CORE_DELETE_BMAP_ENTRIES	\
 	(HAMMER2_PBUFSIZE / sizeof(hammer2_blockref_t) / sizeof(uint32_t))
@@ -761,10 +770,14 @@ typedef struct hammer2_chain_core hammer2_chain_core_t;
  * clustered I/O possible using larger block sizes, the kernel buffer cache
  * is abstracted via the hammer2_io structure.
  */
-RB_HEAD(hammer2_io_tree, hammer2_io);
+LIST_HEAD(hammer2_io_list, hammer2_io);
+TAILQ_HEAD(hammer2_io_freeq, hammer2_io);
+TAILQ_HEAD(hammer2_io_doneq, hammer2_io);
 
 struct hammer2_io {
-	RB_ENTRY(hammer2_io) rbnode;	/* indexed by device offset */
+	LIST_ENTRY(hammer2_io) hnext;	/* hash chain, indexed by pbase */
+	TAILQ_ENTRY(hammer2_io) fnext;	/* hmp->iofreeq (CLOCK) */
+	TAILQ_ENTRY(hammer2_io) dnext;	/* hmp->iodoneq */
 	struct _atomic_lock *spin;
 	struct hammer2_mount *hmp;
 	struct buf	*bp;
@@ -779,12 +792,35 @@ struct hammer2_io {
 	struct hammer2_chain *arg_c;		/* INPROG I/O only */
 	void		*arg_p;			/* INPROG I/O only */
 	off_t		arg_o;			/* INPROG I/O only */
+	int		error;			/* INPROG I/O only */
 	int		refs;
 	int		act;			/* activity */
+	int		onfreeq;		/* on hmp->iofreeq */
+	uint64_t	crc_good_mask;		/* verified 1KB chunks */
 };
 
 typedef struct hammer2_io hammer2_io_t;
 
+/*
+ * The dio index is a hash table keyed by the device offset (pbase) with
+ * a spinlock per bucket, so unrelated buffer accesses do not serialize
+ * on a single per-mount lock.  A dio's refs may only be bumped from 0
+ * with its bucket locked, which interlocks against cleanup.
+ *
+ * Idle (zero-ref) dios are kept on a per-mount CLOCK list, hmp->iofreeq,
+ * and reclaimed incrementally from its head once more than
+ * hammer2_dio_limit are idle.  Removal from the list is lazy, a dio which
+ * is re-referenced stays on the list until the CLOCK hand reaches it.
+ * Lock order is hmp->iofree_spin -> bucket spin.
+ */
+#define HAMMER2_IOHASH_SIZE	1024		/* must be a power of 2 */
+#define HAMMER2_IOHASH_MASK	(HAMMER2_IOHASH_SIZE - 1)
+
+struct hammer2_io_hash {
+	struct mutex	spin;			/* bucket interlock */
+	struct hammer2_io_list list;
+} __aligned(64);
+
 /*
  * Primary chain structure keeps track of the topology in-memory.
  */
@@ -975,6 +1011,19 @@ typedef struct hammer2_cluster hammer2_cluster_t;
 
 RB_HEAD(hammer2_inode_tree, hammer2_inode);
 
+/*
+ * Compression heuristics are tracked per logical range so files mixing
+ * compressible and incompressible regions are handled sensibly.  Ranges
+ * are HAMMER2_COMP_HEUR_RADIX bytes and hash into HAMMER2_COMP_HEUR_SLOTS
+ * slots.  The slots judged incompressible are remembered across inode
+ * eviction in ipdata->comp_hint, one bit per slot.
+ */
+#define HAMMER2_COMP_HEUR_RADIX		20	/* 1MB logical ranges */
+#define HAMMER2_COMP_HEUR_SLOTS		16	/* bits in comp_hint */
+#define HAMMER2_COMP_HEUR_SLOT(lbase)	\
+	((int)((lbase) >> HAMMER2_COMP_HEUR_RADIX) & \
+	 (HAMMER2_COMP_HEUR_SLOTS - 1))
+
 /*
  * A hammer2 inode.
  *
@@ -992,7 +1041,12 @@ struct hammer2_inode {
 	hammer2_tid_t		inum;
 	u_int			flags;
 	u_int			refs;		/* +vpref, +flushref */
-	uint8_t			comp_heuristic;
+	uint8_t			comp_heuristic[HAMMER2_COMP_HEUR_SLOTS];
+	u_int			wthread_seq;	/* write worker tickets issued */
+	u_int			wthread_commit;	/* next ticket to commit */
+	hammer2_key_t		ra_next;	/* expected next strategy read */
+	hammer2_key_t		ra_end;		/* end of issued read-ahead */
+	int			ra_window;	/* read-ahead blocks, 0=random */
 	hammer2_off_t		size;
 	uint64_t		mtime;
 };
@@ -1074,11 +1128,13 @@ typedef struct hammer2_inode_unlink hammer2_inode_unlink_t;
 struct hammer2_trans {
 	TAILQ_ENTRY(hammer2_trans) entry;
 	struct hammer2_pfsmount *pmp;
+	struct hammer2_trans_manage *tman;	/* rendezvous (from pmp) */
 	hammer2_xid_t		sync_xid;
 	hammer2_tid_t		inode_tid;	/* inode number assignment */
 	thread_t		td;		/* pointer */
 	int			flags;
 	int			blocked;
+	int			pack_bytes;	/* packed DATA alloc size */
 	uint8_t			inodes_created;
 	uint8_t			dummy[7];
 };
@@ -1091,30 +1147,57 @@ typedef struct hammer2_trans hammer2_trans_t;
 #define HAMMER2_TRANS_NEWINODE		0x0008	/* caller allocating inode */
 #define HAMMER2_TRANS_FREEBATCH		0x0010	/* batch freeing code */
 #define HAMMER2_TRANS_PREFLUSH		0x0020	/* preflush state */
+#define HAMMER2_TRANS_FASTPATH		0x0040	/* not on transq */
+#define HAMMER2_TRANS_BACKGROUND	0x0080	/* bg flush, never excl */
 
 #define HAMMER2_FREEMAP_HEUR_NRADIX	4	/* pwr 2 PBUFRADIX-MINIORADIX */
 #define HAMMER2_FREEMAP_HEUR_TYPES	8
 #define HAMMER2_FREEMAP_HEUR		(HAMMER2_FREEMAP_HEUR_NRADIX * \
 					 HAMMER2_FREEMAP_HEUR_TYPES)
 
+/*
+ * Per-cpu allocator state.  Each cpu has its own set of freemap
+ * heuristic cursors so concurrent writers tend to allocate from
+ * different 2MB segments, and accumulates its allocator_free
+ * adjustments locally.  The deltas are folded into the volume header by
+ * hammer2_freemap_sync() when the freemap is flushed, so allocations do
+ * not have to lock and modify the volume header.
+ */
+struct hammer2_freemap_pcpu {
+	int64_t		free_delta;	/* pending allocator_free change */
+	hammer2_off_t	heur_freemap[HAMMER2_FREEMAP_HEUR];
+} __aligned(64);
+
 #define HAMMER2_CLUSTER_COPY_NOCHAINS	0x0001	/* do not copy or ref chains */
 #define HAMMER2_CLUSTER_COPY_NOREF	0x0002	/* do not ref chains or cl */
 
 /*
  * Transaction Rendezvous
+ *
+ * Each device mount has its own transaction manager, shared by its
+ * super-root and the PFSs mounted from it.  While no flush is pending
+ * a modifying transaction only bumps fastcnt and never touches translk
+ * or transq.  A flush sets FLUSHING in fastcnt, which forces new
+ * transactions onto the queue, and then waits for fastcnt to drain.
  */
 TAILQ_HEAD(hammer2_trans_queue, hammer2_trans);
 
 struct hammer2_trans_manage {
 	hammer2_xid_t		flush_xid;	/* last flush transaction */
-	hammer2_xid_t		alloc_xid;
-	struct lock		translk;	/* lockmgr lock */
+	u_int			fastcnt;	/* unqueued transactions */
+	struct mutex		translk;	/* queue interlock */
 	struct hammer2_trans_queue transq;	/* modifying transactions */
 	int			flushcnt;	/* track flush trans */
 };
 
+#define HAMMER2_TMANAGE_FLUSHING	0x80000000	/* fastcnt disabled */
+#define HAMMER2_TMANAGE_WAITING		0x40000000	/* flush waiting */
+#define HAMMER2_TMANAGE_MASK		0x3FFFFFFF
+
 typedef struct hammer2_trans_manage hammer2_trans_manage_t;
 
+#define HAMMER2_FLUSH_WORKERS_MAX	16	/* max flush workers per hmp */
+
 /*
  * Global (per device) mount structure for device (aka vp->v_mount->hmp)
  */
@@ -1128,16 +1211,40 @@ struct hammer2_mount {
 	int		nipstacks;
 	int		maxipstacks;
 	kdmsg_iocom_t	iocom;		/* volume-level dmsg interface */
-	struct _atomic_lock *io_spin;	/* iotree access */
-	struct hammer2_io_tree iotree;
-	int		iofree_count;
+	struct hammer2_io_hash iohash[HAMMER2_IOHASH_SIZE];
+	struct mutex	iofree_spin;	/* iofreeq interlock */
+	struct hammer2_io_freeq iofreeq; /* CLOCK list of idle dios */
+	int		iofreeq_count;	/* dios on iofreeq */
+	int		iofree_count;	/* dios with no refs */
+	struct mutex	iodone_mtx;	/* iodoneq interlock */
+	struct hammer2_io_doneq iodoneq; /* completed async reads */
+	struct proc	*iodone_td;	/* async read completion thread */
+	int		iodone_stop;	/* iodone thread termination */
+	off_t		iocluster_next;	/* expected next sequential miss */
 	hammer2_chain_t vchain;		/* anchor chain (topology) */
 	hammer2_chain_t fchain;		/* anchor chain (freemap) */
 	struct _atomic_lock *list_spin;
 	struct h2_flush_list	flushq;	/* flush seeds */
+	struct mutex	flush_mtx;	/* flush_workq interlock */
+	struct h2_flush_workq flush_workq; /* subtrees for flush workers */
+	struct proc	*flush_td[HAMMER2_FLUSH_WORKERS_MAX]; /* workers */
+	int		flush_count;	/* running flush workers */
+	int		flush_destroy;	/* flush worker termination */
 	struct hammer2_pfsmount *spmp;	/* super-root pmp for transactions */
+	hammer2_trans_manage_t tmanage;	/* transaction rendezvous */
+	hammer2_trans_manage_t *tman;	/* tmanage or the shared one */
+	int		tman_share;	/* moving to the shared manager */
 	struct lock	vollk;		/* lockmgr lock */
-	hammer2_off_t	heur_freemap[HAMMER2_FREEMAP_HEUR];
+	struct hammer2_freemap_pcpu freemap_pcpu[MAXCPUS];
+	struct lock	bulklk;		/* serializes bulkfree passes */
+	struct proc	*bulkfree_td;	/* bulkfree thread */
+	int		bulkfree_stop;	/* bulkfree thread termination */
+	hammer2_tid_t	bulkfree_tid;	/* mirror_tid after last staging */
+	hammer2_tid_t	fsynclog_next;	/* next fsync log seq */
+	hammer2_tid_t	fsynclog_hdr;	/* fsynclog_seq of last volhdr */
+	hammer2_tid_t	fsynclog_base;	/* oldest fsync log seq in use */
+	hammer2_tid_t	fsynclog_done;	/* all lower seqs written */
+	struct mutex	fsynclog_mtx;	/* fsynclog_done interlock */
 	int		volhdrno;	/* last volhdrno written */
 	hammer2_volume_data_t voldata;
 	hammer2_volume_data_t volsync;	/* synchronized voldata */
@@ -1160,6 +1267,8 @@ typedef struct hammer2_mount hammer2_mount_t;
  * representitive file) that simply contains a bootstrap volume header
  * listing the configuration.
  */
+#define HAMMER2_WTHREAD_MAX		16	/* max write workers per PFS */
+
 struct hammer2_pfsmount {
 	struct mount		*mp;
 	TAILQ_ENTRY(hammer2_pfsmount) mntentry; /* hammer2_pfslist */
@@ -1180,14 +1289,21 @@ struct hammer2_pfsmount {
 	hammer2_tid_t		alloc_tid;
 	hammer2_tid_t		flush_tid;
 	hammer2_tid_t		inode_tid;
+	hammer2_trans_manage_t	*tman;		/* hmp->tman */
 	long			inmem_inodes;
 	uint32_t		inmem_dirty_chains;
 	int			count_lwinprog;	/* logical write in prog */
+	struct proc		*bgflush_td;	/* background flusher */
+	int			bgflush_stop;	/* flusher termination */
+	int			bgflush_active;	/* flusher is syncing */
 	struct i_atomic_lock *list_spin;
 	struct h2_unlk_list	unlinkq;	/* last-close unlink */
-	thread_t		wthread_td;	/* write thread td */
+	struct proc		*wthread_td[HAMMER2_WTHREAD_MAX]; /* workers */
+	int			wthread_count;	/* running write workers */
+	int			wthread_busy;	/* workers holding a bio */
+	int			wthread_barrier;/* sync bio draining workers */
 	struct bio_queue_head	wthread_bioq;	/* logical buffer bioq */
-	struct mutex		*wthread_mtx;	/* interlock */
+	struct mutex		wthread_mtx;	/* interlock */
 	int			wthread_destroy;/* termination sequencing */
 };
 
@@ -1235,6 +1351,41 @@ hammer2_devblksize(size_t bytes)
 	}
 }
 
+/*
+ * Packed compressed data blocks (blockref psize) only exist on volumes
+ * with the HAMMER2_VOLF_PACKED feature.
+ */
+#define HAMMER2_VOL_PACKABLE(hmp)					\
+	(((hmp)->voldata.flags & HAMMER2_VOLF_PACKED) != 0)
+
+/*
+ * The fsync log (and voldata.fsynclog_seq) is only used on volumes with
+ * the HAMMER2_VOLF_FSYNCLOG feature.
+ */
+#define HAMMER2_VOL_FSYNCLOG(hmp)					\
+	(((hmp)->voldata.flags & HAMMER2_VOLF_FSYNCLOG) != 0)
+
+/*
+ * The bmap freehint is only maintained on volumes with the
+ * HAMMER2_VOLF_FREEHINT feature.
+ */
+#define HAMMER2_VOL_FREEHINT(hmp)					\
+	(((hmp)->voldata.flags & HAMMER2_VOLF_FREEHINT) != 0)
+
+/*
+ * Number of media bytes backing a chain's data.  This is less than
+ * chain->bytes for packed compressed data blocks.  The psize field is
+ * ignored on volumes without HAMMER2_VOLF_PACKED.
+ */
+static __inline
+size_t
+hammer2_chain_psize(hammer2_chain_t *chain)
+{
+	if (chain->bref.psize && HAMMER2_VOL_PACKABLE(chain->hmp))
+		return (HAMMER2_BREF_PSIZE(&chain->bref));
+	return (chain->bytes);
+}
+
 static __inline
 hammer2_pfsmount_t *
 MPTOPMP(struct mount *mp)
@@ -1249,13 +1400,34 @@ MPTOPMP(struct mount *mp)
 #define LOCKEXIT	(--curthread->td_locks)
 #define LOCKSTOP	KKASSERT(curthread->td_locks == __nlocks)
 
+extern hammer2_trans_manage_t hammer2_tmanage_shared;
 extern int hammer2_debug;
 extern int hammer2_cluster_enable;
 extern int hammer2_hardlink_enable;
 extern int hammer2_flush_pipe;
 extern int hammer2_synchronous_flush;
 extern int hammer2_dio_count;
+extern int hammer2_dio_limit;
+extern int hammer2_wthread_count;
+extern int hammer2_flush_workers;
+extern int hammer2_direct_read;
+extern int hammer2_direct_write;
+extern int hammer2_readahead_max;
+extern int hammer2_bulkfree_interval;
+extern long hammer2_bulkfree_limit;
 extern long hammer2_limit_dirty_chains;
+extern int hammer2_dirty_lowat;
+extern int hammer2_dirty_throttle;
+extern long hammer2_throttle_count;
+extern long hammer2_throttle_ticks;
+extern long hammer2_throttle_stalls;
+extern int hammer2_bgflush_batch;
+extern int hammer2_bgflush_interval;
+extern long hammer2_bgflush_count;
+extern long hammer2_bgflush_syncs;
+extern int hammer2_fsynclog_enable;
+extern long hammer2_fsynclog_records;
+extern long hammer2_fsynclog_fallbacks;
 extern long hammer2_iod_file_read;
 extern long hammer2_iod_meta_read;
 extern long hammer2_iod_indr_read;
@@ -1277,8 +1449,9 @@ extern long hammer2_ioa_indr_write;
 extern long hammer2_ioa_fmap_write;
 extern long hammer2_ioa_volu_write;
 
-extern struct vnode *cache_buffer_read;
-extern struct objcache *cache_buffer_write;
+extern struct pool cache_buffer_read;	/* 64KB decompression buffers */
+extern struct pool cache_buffer_write;	/* 32KB compression buffers */
+extern struct pool cache_zstd_dctx;	/* zstd decompression contexts */
 
 extern int destroy;
 extern int write_thread_wakeup;
@@ -1288,6 +1461,7 @@ extern int write_thread_wakeup;
  */
 #define hammer2_icrc32(buf, size)	iscsi_crc32((buf), (size))
 #define hammer2_icrc32c(buf, size, crc)	iscsi_crc32_ext((buf), (size), (crc))
+#define hammer2_crc64(buf, size)	crc64((buf), (size))
 
 hammer2_cluster_t *hammer2_inode_lock_ex(hammer2_inode_t *ip);
 hammer2_cluster_t *hammer2_inode_lock_sh(hammer2_inode_t *ip);
@@ -1310,7 +1484,7 @@ u_int64_t hammer2_timespec_to_time(const struct timespec *ts);
 u_int32_t hammer2_to_unix_xid(const uuid_t *uuid);
 void hammer2_guid_to_uuid(uuid_t *uuid, u_int32_t guid);
 hammer2_xid_t hammer2_trans_newxid(hammer2_pfsmount_t *pmp);
-void hammer2_trans_manage_init(void);
+void hammer2_trans_manage_init(hammer2_trans_manage_t *tman);
 
 hammer2_key_t hammer2_dirhash(const unsigned char *name, size_t len);
 int hammer2_getradix(size_t bytes);
@@ -1339,6 +1513,8 @@ void hammer2_inode_ref(hammer2_inode_t *ip);
 void hammer2_inode_drop(hammer2_inode_t *ip);
 void hammer2_inode_repoint(hammer2_inode_t *ip, hammer2_inode_t *pip,
 			hammer2_cluster_t *cluster);
+void hammer2_inode_comp_seed(hammer2_inode_t *ip,
+			const hammer2_inode_data_t *ipdata);
 void hammer2_run_unlinkq(hammer2_trans_t *trans, hammer2_pfsmount_t *pmp);
 
 hammer2_inode_t *hammer2_inode_create(hammer2_trans_t *trans,
@@ -1380,6 +1556,8 @@ hammer2_chain_t *hammer2_chain_alloc(hammer2_mount_t *hmp,
 				hammer2_pfsmount_t *pmp,
 				hammer2_trans_t *trans,
 				hammer2_blockref_t *bref);
+hammer2_chain_t *hammer2_chain_bulksnap(hammer2_mount_t *hmp);
+void hammer2_chain_bulkdrop(hammer2_chain_t *copy);
 void hammer2_chain_core_alloc(hammer2_trans_t *trans, hammer2_chain_t *chain);
 void hammer2_chain_ref(hammer2_chain_t *chain);
 void hammer2_chain_drop(hammer2_chain_t *chain);
@@ -1431,6 +1609,8 @@ void hammer2_chain_delete(hammer2_trans_t *trans, hammer2_chain_t *parent,
 void hammer2_chain_delete_duplicate(hammer2_trans_t *trans,
 				hammer2_chain_t **chainp, int flags);
 void hammer2_flush(hammer2_trans_t *trans, hammer2_chain_t *chain);
+void hammer2_flush_init(hammer2_mount_t *hmp);
+void hammer2_flush_uninit(hammer2_mount_t *hmp);
 void hammer2_chain_commit(hammer2_trans_t *trans, hammer2_chain_t *chain);
 void hammer2_chain_setflush(hammer2_trans_t *trans, hammer2_chain_t *chain);
 void hammer2_chain_countbrefs(hammer2_chain_t *chain,
@@ -1441,6 +1621,8 @@ int hammer2_chain_testcheck(hammer2_chain_t *chain, void *bdata);
 
 
 void hammer2_pfs_memory_wait(hammer2_pfsmount_t *pmp);
+void hammer2_bgflush_init(hammer2_pfsmount_t *pmp);
+void hammer2_bgflush_uninit(hammer2_pfsmount_t *pmp);
 void hammer2_pfs_memory_inc(hammer2_pfsmount_t *pmp);
 void hammer2_pfs_memory_wakeup(hammer2_pfsmount_t *pmp);
 
@@ -1493,7 +1675,10 @@ void vfs_bio_clrbuf(struct buf *bp);
 hammer2_io_t *hammer2_io_getblk(hammer2_mount_t *hmp, off_t lbase,
 				int lsize, int *ownerp);
 void hammer2_io_putblk(hammer2_io_t **diop);
-void hammer2_io_cleanup(hammer2_mount_t *hmp, struct hammer2_io_tree *tree);
+void hammer2_io_init(hammer2_mount_t *hmp);
+void hammer2_io_uninit(hammer2_mount_t *hmp);
+void hammer2_io_cleanup(hammer2_mount_t *hmp, struct hammer2_io_list *list);
+void hammer2_io_cleanup_all(hammer2_mount_t *hmp);
 char *hammer2_io_data(hammer2_io_t *dio, off_t lbase);
 int hammer2_io_new(hammer2_mount_t *hmp, off_t lbase, int lsize,
 				hammer2_io_t **diop);
@@ -1517,8 +1702,13 @@ int hammer2_io_bwrite(hammer2_io_t **diop);
 int hammer2_io_isdirty(hammer2_io_t *dio);
 void hammer2_io_setdirty(hammer2_io_t *dio);
 void hammer2_io_setinval(hammer2_io_t *dio, u_int bytes);
+void hammer2_io_inval(hammer2_mount_t *hmp, hammer2_off_t pbase, int bytes);
 void hammer2_io_brelse(hammer2_io_t **diop);
 void hammer2_io_bqrelse(hammer2_io_t **diop);
+uint64_t hammer2_io_mask(hammer2_io_t *dio, off_t lbase, u_int bytes);
+int hammer2_io_crc_good(hammer2_chain_t *chain, uint64_t *maskp);
+void hammer2_io_crc_setmask(hammer2_io_t *dio, uint64_t mask);
+void hammer2_io_crc_clrmask(hammer2_io_t *dio, uint64_t mask);
 
 static __inline int
 cluster_read(struct vnode *vp, off_t filesize, off_t loffset,
@@ -1551,6 +1741,11 @@ void hammer2_lwinprog_ref(hammer2_pfsmount_t *pmp);
 void hammer2_lwinprog_drop(hammer2_pfsmount_t *pmp);
 void hammer2_lwinprog_wait(hammer2_pfsmount_t *pmp);
 
+/*
+ * hammer2_vnops.c
+ */
+void hammer2_decompress_uninit(void);
+
 struct mtx;
 int mtxsleep(void *, struct mutex *, int, const char *, int);
 
@@ -1561,6 +1756,21 @@ int hammer2_freemap_alloc(hammer2_trans_t *trans, hammer2_chain_t *chain,
 				size_t bytes);
 void hammer2_freemap_adjust(hammer2_trans_t *trans, hammer2_mount_t *hmp,
 				hammer2_blockref_t *bref, int how);
+void hammer2_freemap_sync(hammer2_mount_t *hmp);
+hammer2_off_t hammer2_freemap_free(hammer2_mount_t *hmp);
+
+/*
+ * hammer2_bulkfree.c
+ */
+void hammer2_bulkfree_init(hammer2_mount_t *hmp);
+void hammer2_bulkfree_uninit(hammer2_mount_t *hmp);
+int hammer2_bulkfree_pass(hammer2_mount_t *hmp, hammer2_ioc_bulkfree_t *bfi);
+
+/*
+ * hammer2_fsynclog.c
+ */
+int hammer2_fsynclog_fsync(hammer2_inode_t *ip);
+int hammer2_fsynclog_replay(hammer2_mount_t *hmp);
 
 /*
  * hammer2_cluster.c
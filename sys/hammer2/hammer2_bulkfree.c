@@ -0,0 +1,738 @@
+/*
+ * Copyright (c) 2011-2014 The DragonFly Project.  All rights reserved.
+ *
+ * This code is derived from software contributed to The DragonFly Project
+ * by Matthew Dillon <dillon@dragonflybsd.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of The DragonFly Project nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific, prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * Bulk free scan
+ *
+ * Blocks are never freed in real time (see hammer2_freemap_adjust()).
+ * Instead a bulk scan of the whole topology builds a map of referenced
+ * 16KB freemap blocks using the same 2-bit format as the freemap leafs,
+ * then each freemap leaf is compared against the map:
+ *
+ *	scan	media
+ *	11	00	Referenced but marked free, fixup to 11
+ *	11	10	Still referenced, restore to 11
+ *	00	11	Not referenced, stage as possibly free (10)
+ *	00	10	Not referenced on two passes, free (00)
+ *
+ * The 10 state is not allocatable, and a block is only moved from 10 to
+ * 00 if at least one flush committed between the start of the pass which
+ * staged it and the start of the pass which frees it.  This guarantees
+ * that none of the volume headers still reference the block and covers
+ * blocks which were allocated while a scan was in progress.
+ *
+ * The scan map costs 32KB per 2GB zone.  Only hammer2_bulkfree_limit
+ * bytes worth of zone maps are kept in memory, the rest are spooled to
+ * the 4MB reserved area of the zone they describe (FREEMAP_06, which is
+ * set aside for the batch freeing code) and read back as needed.
+ */
+#include <sys/param.h>
+#include <sys/systm.h>
+#include <sys/kernel.h>
+#include <sys/kthread.h>
+#include <sys/fcntl.h>
+#include <sys/buf.h>
+#include <sys/proc.h>
+#include <sys/mount.h>
+#include <sys/vnode.h>
+#include <sys/stdint.h>
+
+#include "hammer2.h"
+
+#define H2FMBASE(key, radix)	((key) & ~(((hammer2_off_t)1 << (radix)) - 1))
+#define H2FMSHIFT(radix)	((hammer2_off_t)1 << (radix))
+
+#define HAMMER2_BULKFREE_ZWORDS	(HAMMER2_FREEMAP_COUNT * 8)
+#define HAMMER2_BULKFREE_ZBYTES	(HAMMER2_BULKFREE_ZWORDS * \
+				 (int)sizeof(uint32_t))
+#define HAMMER2_BULKFREE_MAXDEPTH 10
+
+/*
+ * Spooled zone maps are read and written as a single dio.
+ */
+CTASSERT((HAMMER2_BULKFREE_ZBYTES & (HAMMER2_BULKFREE_ZBYTES - 1)) == 0);
+CTASSERT(HAMMER2_BULKFREE_ZBYTES <= HAMMER2_PBUFSIZE);
+
+#define HAMMER2_BULKFREE_ZNONE		0	/* zone not referenced */
+#define HAMMER2_BULKFREE_ZRESIDENT	1	/* zone map in memory */
+#define HAMMER2_BULKFREE_ZSPILLED	2	/* zone map spooled to media */
+
+struct hammer2_bulkfree_elm {
+	TAILQ_ENTRY(hammer2_bulkfree_elm) entry;
+	hammer2_chain_t *chain;
+};
+
+TAILQ_HEAD(hammer2_bulkfree_list, hammer2_bulkfree_elm);
+
+struct hammer2_bulkfree_info {
+	hammer2_mount_t	*hmp;
+	hammer2_ioc_bulkfree_t *bfi;
+	struct hammer2_bulkfree_list list;
+	int		depth;
+	int		realfree;	/* 10 -> 00 transitions allowed */
+	int		nzones;		/* 2GB zones in volume */
+	uint8_t		*zstate;	/* per-zone state */
+	uint32_t	**zmap;		/* per-zone resident map */
+	int		*rzone;		/* resident zones (clock) */
+	int		rmax;
+	int		rcount;
+	int		rhand;
+	uint32_t	*smap;		/* sync buffer for spooled zones */
+};
+
+typedef struct hammer2_bulkfree_info hammer2_bulkfree_info_t;
+
+static void hammer2_bulkfree_thread(void *arg);
+static int hammer2_bulkfree_scan(hammer2_bulkfree_info_t *info,
+			hammer2_chain_t *parent);
+static int hammer2_bulkfree_mark(hammer2_bulkfree_info_t *info,
+			hammer2_blockref_t *bref);
+static void hammer2_bulkfree_sync(hammer2_bulkfree_info_t *info);
+static int hammer2_bulkfree_sync_leaf(hammer2_bulkfree_info_t *info,
+			hammer2_chain_t *chain, uint32_t *map, int dryrun);
+
+/*
+ * Start the bulkfree thread for a RW device mount.
+ */
+void
+hammer2_bulkfree_init(hammer2_mount_t *hmp)
+{
+	hmp->bulkfree_stop = 0;
+	if (kthread_create(hammer2_bulkfree_thread, hmp, &hmp->bulkfree_td,
+			   "h2bulkfree")) {
+		printf("hammer2: unable to start bulkfree thread\n");
+		hmp->bulkfree_td = NULL;
+	}
+}
+
+/*
+ * Stop the bulkfree thread, an in-progress pass is aborted.
+ */
+void
+hammer2_bulkfree_uninit(hammer2_mount_t *hmp)
+{
+	hmp->bulkfree_stop = 1;
+	while (hmp->bulkfree_td) {
+		wakeup(&hmp->bulkfree_td);
+		tsleep(&hmp->bulkfree_stop, 0, "h2bfst", hz);
+	}
+}
+
+static
+void
+hammer2_bulkfree_thread(void *arg)
+{
+	hammer2_mount_t *hmp = arg;
+	hammer2_ioc_bulkfree_t bfi;
+	int error;
+
+	while (hmp->bulkfree_stop == 0) {
+		tsleep(&hmp->bulkfree_td, 0, "h2bulk",
+		       (hammer2_bulkfree_interval > 0) ?
+		       hammer2_bulkfree_interval * hz : 60 * hz);
+		if (hmp->bulkfree_stop)
+			break;
+		if (hammer2_bulkfree_interval <= 0)
+			continue;
+		bzero(&bfi, sizeof(bfi));
+		error = hammer2_bulkfree_pass(hmp, &bfi);
+		if (hammer2_debug & 0x0040) {
+			printf("hammer2_bulkfree: error %d staged %llu "
+			       "freed %llu\n", error,
+			       (unsigned long long)bfi.count_staged,
+			       (unsigned long long)bfi.count_freed);
+		}
+	}
+	hmp->bulkfree_td = NULL;
+	wakeup(&hmp->bulkfree_stop);
+	kthread_exit(0);
+}
+
+/*
+ * Run one bulkfree pass.  Passes are serialized, the thread and the
+ * ioctl may both call this.
+ */
+int
+hammer2_bulkfree_pass(hammer2_mount_t *hmp, hammer2_ioc_bulkfree_t *bfi)
+{
+	hammer2_bulkfree_info_t info;
+	struct hammer2_bulkfree_elm *elm;
+	hammer2_trans_t trans;
+	hammer2_chain_t *vchain;
+	hammer2_chain_t *parent;
+	uint64_t limit;
+	int error;
+	int i;
+
+	lockmgr(&hmp->bulklk, LK_EXCLUSIVE, NULL);
+
+	bzero(&info, sizeof(info));
+	info.hmp = hmp;
+	info.bfi = bfi;
+	TAILQ_INIT(&info.list);
+
+	/*
+	 * Scan a snapshot of the topology as of the last flush, the live
+	 * topology is modified by the frontend while we scan.  Taking the
+	 * snapshot under a flush transaction waits out any flush which is
+	 * in progress so volsync is consistent.
+	 */
+	hammer2_trans_init(&trans, hmp->spmp, HAMMER2_TRANS_ISFLUSH);
+	vchain = hammer2_chain_bulksnap(hmp);
+	hammer2_trans_done(&trans);
+
+	/*
+	 * Only allow 10 -> 00 transitions if a flush has committed since
+	 * the previous pass staged its blocks.
+	 */
+	info.realfree = (hmp->bulkfree_tid != 0 &&
+			 vchain->data->voldata.mirror_tid > hmp->bulkfree_tid);
+
+	info.nzones = (int)((hmp->voldata.volu_size + HAMMER2_ZONE_MASK64) /
+			    HAMMER2_ZONE_BYTES64);
+	limit = bfi->size ? bfi->size : (uint64_t)hammer2_bulkfree_limit;
+	limit /= HAMMER2_BULKFREE_ZBYTES;
+	if (limit < 2)
+		limit = 2;	/* see hammer2_bulkfree_zone() */
+	if (limit > info.nzones)
+		limit = info.nzones;
+	info.rmax = (int)limit;
+
+	info.zstate = malloc(info.nzones, M_HAMMER2, M_WAITOK | M_ZERO);
+	info.zmap = malloc(info.nzones * sizeof(*info.zmap), M_HAMMER2,
+			   M_WAITOK | M_ZERO);
+	info.rzone = malloc(info.rmax * sizeof(*info.rzone), M_HAMMER2,
+			    M_WAITOK | M_ZERO);
+	info.smap = malloc(HAMMER2_BULKFREE_ZBYTES, M_HAMMER2, M_WAITOK);
+
+	/*
+	 * Scan the topology.  Chains deeper than MAXDEPTH are deferred to
+	 * the list to bound kernel stack use.
+	 */
+	parent = hammer2_chain_lookup_init(vchain, 0);
+	error = hammer2_bulkfree_scan(&info, parent);
+	hammer2_chain_lookup_done(parent);
+
+	while ((elm = TAILQ_FIRST(&info.list)) != NULL) {
+		TAILQ_REMOVE(&info.list, elm, entry);
+		parent = elm->chain;
+		free(elm, M_HAMMER2, 0);
+
+		if (error == 0) {
+			hammer2_chain_lock(parent, HAMMER2_RESOLVE_ALWAYS |
+						   HAMMER2_RESOLVE_NOREF);
+			error = hammer2_bulkfree_scan(&info, parent);
+			hammer2_chain_unlock(parent);
+		} else {
+			hammer2_chain_drop(parent);
+		}
+	}
+	hammer2_chain_bulkdrop(vchain);
+
+	/*
+	 * Never adjust the freemap from an incomplete scan.  The tid is
+	 * recorded after staging so the next pass only frees blocks once
+	 * a flush which completed after the staging has hit the media.
+	 */
+	if (error == 0) {
+		hammer2_bulkfree_sync(&info);
+		hmp->bulkfree_tid = hmp->voldata.mirror_tid;
+	}
+
+	for (i = 0; i < info.rcount; ++i)
+		free(info.zmap[info.rzone[i]], M_HAMMER2, 0);
+	free(info.smap, M_HAMMER2, 0);
+	free(info.rzone, M_HAMMER2, 0);
+	free(info.zmap, M_HAMMER2, 0);
+	free(info.zstate, M_HAMMER2, 0);
+
+	lockmgr(&hmp->bulklk, LK_RELEASE, NULL);
+
+	return (error);
+}
+
+/*
+ * Recursive topology scan, modeled on the mount-time recovery scan but
+ * covering every chain instead of only the last flushed transaction.
+ */
+static
+int
+hammer2_bulkfree_scan(hammer2_bulkfree_info_t *info, hammer2_chain_t *parent)
+{
+	hammer2_chain_t *chain;
+	int cache_index;
+	int error;
+
+	if (info->hmp->bulkfree_stop)
+		return (EINTR);
+
+	if (parent->bref.type != HAMMER2_BREF_TYPE_VOLUME) {
+		error = hammer2_bulkfree_mark(info, &parent->bref);
+		if (error)
+			return (error);
+	}
+
+	switch(parent->bref.type) {
+	case HAMMER2_BREF_TYPE_VOLUME:
+		/* data already instantiated */
+		break;
+	case HAMMER2_BREF_TYPE_INODE:
+		/*
+		 * Must instantiate data for DIRECTDATA test and also
+		 * for recursion.
+		 */
+		hammer2_chain_lock(parent, HAMMER2_RESOLVE_ALWAYS);
+		if (parent->data->ipdata.op_flags & HAMMER2_OPFLAG_DIRECTDATA) {
+			hammer2_chain_unlock(parent);
+			return (0);
+		}
+		hammer2_chain_unlock(parent);
+		break;
+	case HAMMER2_BREF_TYPE_INDIRECT:
+		/*
+		 * Must instantiate data for recursion
+		 */
+		hammer2_chain_lock(parent, HAMMER2_RESOLVE_ALWAYS);
+		hammer2_chain_unlock(parent);
+		break;
+	case HAMMER2_BREF_TYPE_DATA:
+		return (0);
+	case HAMMER2_BREF_TYPE_FREEMAP:
+	case HAMMER2_BREF_TYPE_FREEMAP_NODE:
+	case HAMMER2_BREF_TYPE_FREEMAP_LEAF:
+		/* freemap blocks live in the reserved area */
+		return (0);
+	default:
+		return (EDOM);
+	}
+
+	if (info->depth >= HAMMER2_BULKFREE_MAXDEPTH) {
+		struct hammer2_bulkfree_elm *elm;
+
+		elm = malloc(sizeof(*elm), M_HAMMER2, M_ZERO | M_WAITOK);
+		elm->chain = parent;
+		hammer2_chain_ref(parent);
+		TAILQ_INSERT_TAIL(&info->list, elm, entry);
+		/* unlocked by caller */
+
+		return (0);
+	}
+
+	/*
+	 * We are doing this without pmp assignments so don't leave the
+	 * chains hanging around after we are done with them.
+	 */
+	error = 0;
+	cache_index = 0;
+	chain = hammer2_chain_scan(parent, NULL, &cache_index,
+				   HAMMER2_LOOKUP_NODATA);
+	while (chain) {
+		atomic_set_int(&chain->flags, HAMMER2_CHAIN_RELEASE);
+		if (error == 0) {
+			++info->depth;
+			error = hammer2_bulkfree_scan(info, chain);
+			--info->depth;
+		}
+		chain = hammer2_chain_scan(parent, chain, &cache_index,
+					   HAMMER2_LOOKUP_NODATA);
+	}
+	return (error);
+}
+
+/*
+ * Zone maps are spooled to the reserved area of the zone they describe,
+ * which can lie past the end of the volume if the last zone is truncated.
+ */
+static
+int
+hammer2_bulkfree_spillable(hammer2_bulkfree_info_t *info, int zone)
+{
+	hammer2_off_t off;
+
+	off = ((hammer2_off_t)zone << HAMMER2_FREEMAP_LEVEL1_RADIX) +
+	      (HAMMER2_ZONE_FREEMAP_06 + HAMMER2_ZONEFM_LEVEL1) *
+	      HAMMER2_PBUFSIZE;
+	return (off + HAMMER2_BULKFREE_ZBYTES <=
+		info->hmp->voldata.volu_size);
+}
+
+/*
+ * Spool a zone map out to the reserved area of its zone.
+ */
+static
+int
+hammer2_bulkfree_spill(hammer2_bulkfree_info_t *info, int zone,
+		       uint32_t *map)
+{
+	hammer2_io_t *dio;
+	hammer2_off_t off;
+	int error;
+
+	off = ((hammer2_off_t)zone << HAMMER2_FREEMAP_LEVEL1_RADIX) +
+	      (HAMMER2_ZONE_FREEMAP_06 + HAMMER2_ZONEFM_LEVEL1) *
+	      HAMMER2_PBUFSIZE;
+	off |= hammer2_getradix(HAMMER2_BULKFREE_ZBYTES);
+	error = hammer2_io_new(info->hmp, off, HAMMER2_BULKFREE_ZBYTES, &dio);
+	if (error) {
+		hammer2_io_brelse(&dio);
+		return (error);
+	}
+	bcopy(map, hammer2_io_data(dio, off), HAMMER2_BULKFREE_ZBYTES);
+	hammer2_io_bawrite(&dio);
+	++info->bfi->count_spilled;
+
+	return (0);
+}
+
+/*
+ * Read a spooled zone map back in.
+ */
+static
+int
+hammer2_bulkfree_reload(hammer2_bulkfree_info_t *info, int zone,
+			uint32_t *map)
+{
+	hammer2_io_t *dio;
+	hammer2_off_t off;
+	int error;
+
+	off = ((hammer2_off_t)zone << HAMMER2_FREEMAP_LEVEL1_RADIX) +
+	      (HAMMER2_ZONE_FREEMAP_06 + HAMMER2_ZONEFM_LEVEL1) *
+	      HAMMER2_PBUFSIZE;
+	off |= hammer2_getradix(HAMMER2_BULKFREE_ZBYTES);
+	error = hammer2_io_bread(info->hmp, off, HAMMER2_BULKFREE_ZBYTES, &dio);
+	if (error == 0)
+		bcopy(hammer2_io_data(dio, off), map, HAMMER2_BULKFREE_ZBYTES);
+	hammer2_io_brelse(&dio);
+
+	return (error);
+}
+
+/*
+ * Return the resident map for a zone, spooling out another zone if we
+ * are at the ram limit.
+ */
+static
+uint32_t *
+hammer2_bulkfree_zone(hammer2_bulkfree_info_t *info, int zone, int *errorp)
+{
+	uint32_t *map;
+	int victim;
+
+	*errorp = 0;
+	if (info->zstate[zone] == HAMMER2_BULKFREE_ZRESIDENT)
+		return (info->zmap[zone]);
+
+	if (info->rcount < info->rmax) {
+		map = malloc(HAMMER2_BULKFREE_ZBYTES, M_HAMMER2, M_WAITOK);
+		info->rzone[info->rcount++] = zone;
+	} else {
+		/*
+		 * A truncated last zone stays resident.  Only one zone can
+		 * be truncated and rmax is at least 2 when there is more
+		 * than one zone, so the next slot can always be spooled.
+		 */
+		victim = info->rzone[info->rhand];
+		if (!hammer2_bulkfree_spillable(info, victim)) {
+			if (++info->rhand == info->rmax)
+				info->rhand = 0;
+			victim = info->rzone[info->rhand];
+		}
+		map = info->zmap[victim];
+		*errorp = hammer2_bulkfree_spill(info, victim, map);
+		if (*errorp)
+			return (NULL);
+		info->zmap[victim] = NULL;
+		info->zstate[victim] = HAMMER2_BULKFREE_ZSPILLED;
+		info->rzone[info->rhand] = zone;
+		if (++info->rhand == info->rmax)
+			info->rhand = 0;
+	}
+
+	if (info->zstate[zone] == HAMMER2_BULKFREE_ZSPILLED) {
+		*errorp = hammer2_bulkfree_reload(info, zone, map);
+		if (*errorp) {
+			/* leave map resident so it is freed */
+			bzero(map, HAMMER2_BULKFREE_ZBYTES);
+		}
+	} else {
+		bzero(map, HAMMER2_BULKFREE_ZBYTES);
+	}
+	info->zmap[zone] = map;
+	info->zstate[zone] = HAMMER2_BULKFREE_ZRESIDENT;
+
+	return (*errorp ? NULL : map);
+}
+
+/*
+ * Mark the 16KB freemap blocks covered by a blockref as referenced.
+ */
+static
+int
+hammer2_bulkfree_mark(hammer2_bulkfree_info_t *info, hammer2_blockref_t *bref)
+{
+	hammer2_mount_t *hmp = info->hmp;
+	hammer2_off_t data_off;
+	hammer2_off_t data_end;
+	uint32_t *map;
+	int radix;
+	int zone;
+	int error;
+	int n;
+
+	radix = (int)(bref->data_off & HAMMER2_OFF_MASK_RADIX);
+	if (radix == 0)
+		return (0);
+	data_off = bref->data_off & ~HAMMER2_OFF_MASK_RADIX;
+	data_end = data_off + ((hammer2_off_t)1 << radix);
+
+	/*
+	 * Static allocations made by newfs_hammer2 are never freed.
+	 */
+	if (data_off < hmp->voldata.allocator_beg ||
+	    data_end > hmp->voldata.volu_size) {
+		return (0);
+	}
+
+	zone = (int)(data_off >> HAMMER2_FREEMAP_LEVEL1_RADIX);
+	map = hammer2_bulkfree_zone(info, zone, &error);
+	if (map == NULL)
+		return (error);
+
+	while (data_off < data_end) {
+		n = (int)(data_off >> HAMMER2_FREEMAP_BLOCK_RADIX) &
+		    (HAMMER2_BULKFREE_ZWORDS * 16 - 1);
+		if ((map[n >> 4] & (3U << ((n & 15) * 2))) == 0) {
+			map[n >> 4] |= 3U << ((n & 15) * 2);
+			++info->bfi->count_referenced;
+		}
+		data_off = (data_off + HAMMER2_FREEMAP_BLOCK_SIZE) &
+			   ~HAMMER2_FREEMAP_BLOCK_MASK;
+	}
+	return (0);
+}
+
+static __inline
+int
+hammer2_bulkfree_bitcount(uint32_t bits)
+{
+	int count = 0;
+
+	while (bits) {
+		bits &= bits - 1;
+		++count;
+	}
+	return (count);
+}
+
+/*
+ * Compare the scan map against each freemap leaf and apply the
+ * transitions.  Each leaf is adjusted in its own transaction so a
+ * bulkfree pass never holds up a flush for long.
+ */
+static
+void
+hammer2_bulkfree_sync(hammer2_bulkfree_info_t *info)
+{
+	hammer2_mount_t *hmp = info->hmp;
+	hammer2_trans_t trans;
+	hammer2_chain_t *parent;
+	hammer2_chain_t *chain;
+	hammer2_key_t key;
+	hammer2_key_t key_dummy;
+	uint32_t *map;
+	int cache_index;
+	int ddflag;
+	int zone;
+	int error;
+
+	for (zone = 0; zone < info->nzones; ++zone) {
+		if (hmp->bulkfree_stop)
+			break;
+
+		switch(info->zstate[zone]) {
+		case HAMMER2_BULKFREE_ZRESIDENT:
+			map = info->zmap[zone];
+			break;
+		case HAMMER2_BULKFREE_ZSPILLED:
+			map = info->smap;
+			error = hammer2_bulkfree_reload(info, zone, map);
+			if (error)
+				continue;
+			break;
+		default:
+			map = info->smap;
+			bzero(map, HAMMER2_BULKFREE_ZBYTES);
+			break;
+		}
+
+		key = (hammer2_key_t)zone << HAMMER2_FREEMAP_LEVEL1_RADIX;
+		cache_index = -1;
+
+		hammer2_trans_init(&trans, hmp->spmp, 0);
+		parent = &hmp->fchain;
+		hammer2_chain_lock(parent, HAMMER2_RESOLVE_ALWAYS);
+		chain = hammer2_chain_lookup(&parent, &key_dummy, key,
+				key + H2FMSHIFT(HAMMER2_FREEMAP_LEVEL1_RADIX) - 1,
+				&cache_index,
+				HAMMER2_LOOKUP_ALWAYS |
+				HAMMER2_LOOKUP_MATCHIND, &ddflag);
+		if (chain) {
+			if (chain->bref.type == HAMMER2_BREF_TYPE_FREEMAP_LEAF &&
+			    hammer2_bulkfree_sync_leaf(info, chain, map, 1)) {
+				hammer2_chain_modify(&trans, chain, 0);
+				hammer2_bulkfree_sync_leaf(info, chain, map, 0);
+			}
+			hammer2_chain_unlock(chain);
+		}
+		hammer2_chain_unlock(parent);
+		hammer2_trans_done(&trans);
+	}
+}
+
+/*
+ * Apply the scan map to one 2GB freemap leaf.  With dryrun set nothing is
+ * modified and non-zero is returned if the leaf would change.
+ */
+static
+int
+hammer2_bulkfree_sync_leaf(hammer2_bulkfree_info_t *info,
+			   hammer2_chain_t *chain, uint32_t *map, int dryrun)
+{
+	hammer2_mount_t *hmp = info->hmp;
+	hammer2_ioc_bulkfree_t *bfi = info->bfi;
+	hammer2_bmap_data_t *bmap;
+	hammer2_off_t key;
+	hammer2_off_t lokey;
+	hammer2_off_t hikey;
+	uint32_t m, s, nm;
+	uint32_t mhi, mlo;
+	uint32_t set11, to10, to00;
+	int64_t delta;
+	int64_t avail;
+	int freed;
+	int fixed;
+	int count;
+	int i;
+
+	/*
+	 * Same range calculation as hammer2_freemap_init(), entries
+	 * outside of it are permanently allocated.
+	 */
+	key = H2FMBASE(chain->bref.key, HAMMER2_FREEMAP_LEVEL1_RADIX);
+	lokey = (hmp->voldata.allocator_beg + HAMMER2_SEGMASK64) &
+		~HAMMER2_SEGMASK64;
+	if (lokey < key + HAMMER2_ZONE_SEG64)
+		lokey = key + HAMMER2_ZONE_SEG64;
+	hikey = key + H2FMSHIFT(HAMMER2_FREEMAP_LEVEL1_RADIX);
+	if (hikey > hmp->voldata.volu_size)
+		hikey = hmp->voldata.volu_size & ~HAMMER2_SEGMASK64;
+
+	bmap = &chain->data->bmdata[0];
+	delta = 0;
+
+	for (count = 0; count < HAMMER2_FREEMAP_COUNT; ++count, ++bmap) {
+		if (key < lokey || key >= hikey) {
+			key += H2FMSHIFT(HAMMER2_FREEMAP_LEVEL0_RADIX);
+			map += 8;
+			continue;
+		}
+		freed = 0;
+		fixed = 0;
+		for (i = 0; i < 8; ++i) {
+			m = bmap->bitmap[i];
+			s = map[i] & 0x55555555U;
+			mhi = (m >> 1) & 0x55555555U;
+			mlo = m & 0x55555555U;
+
+			/* (01 is illegal and left alone) */
+			set11 = s & ~mlo;			/* 00,10 -> 11 */
+			to10 = ~s & mhi & mlo;			/* 11 -> 10 */
+			to00 = info->realfree ? (~s & mhi & ~mlo) : 0;
+			if ((set11 | to10 | to00) == 0)
+				continue;
+			if (dryrun)
+				return (1);
+
+			nm = m;
+			nm |= set11 | (set11 << 1);
+			nm &= ~to10;
+			nm &= ~(to00 | (to00 << 1));
+			bmap->bitmap[i] = nm;
+
+			fixed += hammer2_bulkfree_bitcount(set11 & ~mhi);
+			bfi->count_restored +=
+				hammer2_bulkfree_bitcount(set11 & mhi);
+			bfi->count_staged += hammer2_bulkfree_bitcount(to10);
+			freed += hammer2_bulkfree_bitcount(to00);
+		}
+		if (freed || fixed) {
+			avail = (int64_t)bmap->avail +
+				(int64_t)(freed - fixed) *
+				HAMMER2_FREEMAP_BLOCK_SIZE;
+			if (avail < 0)
+				avail = 0;
+			if (avail > HAMMER2_SEGSIZE)
+				avail = HAMMER2_SEGSIZE;
+			bmap->avail = (uint32_t)avail;
+			bmap->linear = 0;
+			bmap->freehint = 0;
+			if (bmap->bitmap[0] == 0 && bmap->bitmap[1] == 0 &&
+			    bmap->bitmap[2] == 0 && bmap->bitmap[3] == 0 &&
+			    bmap->bitmap[4] == 0 && bmap->bitmap[5] == 0 &&
+			    bmap->bitmap[6] == 0 && bmap->bitmap[7] == 0) {
+				bmap->avail = HAMMER2_SEGSIZE;
+				bmap->class = 0;
+			}
+			bfi->count_freed += freed;
+			bfi->count_fixups += fixed;
+			delta += (int64_t)(freed - fixed) *
+				 HAMMER2_FREEMAP_BLOCK_SIZE;
+		}
+		key += H2FMSHIFT(HAMMER2_FREEMAP_LEVEL0_RADIX);
+		map += 8;
+	}
+	if (dryrun)
+		return (0);
+
+	/*
+	 * Freed space is a hint to the allocator that the leaf has
+	 * something allocatable again.
+	 */
+	if (delta) {
+		chain->bref.check.freemap.bigmask = (uint32_t)-1;
+		chain->bref.check.freemap.avail += delta;
+		hmp->freemap_pcpu[cpu_number()].free_delta += delta;
+	}
+	return (0);
+}
@@ -215,6 +215,13 @@ hammer2_chain_alloc(hammer2_mount_t *hmp, hammer2_pfsmount_t *pmp,
 		chain = malloc(sizeof(*chain), M_TEMP /* hmp->mchain */, M_WAITOK | M_ZERO);
 		break;
 	case HAMMER2_BREF_TYPE_VOLUME:
+		/*
+		 * Only hammer2_chain_bulksnap() calls this function with
+		 * this type.
+		 */
+		chain = malloc(sizeof(*chain), M_TEMP /* hmp->mchain */,
+			       M_WAITOK | M_ZERO);
+		break;
 	case HAMMER2_BREF_TYPE_FREEMAP:
 		chain = NULL;
 		panic("hammer2_chain_alloc volume type illegal for op");
@@ -243,6 +250,38 @@ hammer2_chain_alloc(hammer2_mount_t *hmp, hammer2_pfsmount_t *pmp,
 	return (chain);
 }
 
+/*
+ * Take a snapshot of the volume root as of the last flush, for topology
+ * scans which must not see the live (in-progress) topology.  The caller
+ * should hold a flush transaction so volsync is stable, the copy is
+ * scanned like vchain and released with hammer2_chain_bulkdrop().
+ */
+hammer2_chain_t *
+hammer2_chain_bulksnap(hammer2_mount_t *hmp)
+{
+	hammer2_chain_t *copy;
+
+	copy = hammer2_chain_alloc(hmp, hmp->spmp, NULL, &hmp->vchain.bref);
+	hammer2_chain_core_alloc(NULL, copy);
+	copy->data = malloc(sizeof(copy->data->voldata), M_HAMMER2,
+			    M_WAITOK | M_ZERO);
+	hammer2_voldata_lock(hmp);
+	copy->data->voldata = hmp->volsync;
+	hammer2_voldata_unlock(hmp);
+
+	return (copy);
+}
+
+void
+hammer2_chain_bulkdrop(hammer2_chain_t *copy)
+{
+	KKASSERT(copy->bref.type == HAMMER2_BREF_TYPE_VOLUME);
+	KKASSERT(copy->data);
+	free(copy->data, M_HAMMER2, sizeof(copy->data->voldata));
+	copy->data = NULL;
+	hammer2_chain_drop(copy);
+}
+
 /*
  * Associate an existing core with the chain or allocate a new core.
  *
@@ -586,6 +625,7 @@ hammer2_chain_lock(hammer2_chain_t *chain, int how)
 	hammer2_mount_t *hmp;
 	hammer2_blockref_t *bref;
 	ccms_state_t ostate;
+	uint64_t mask;
 	char *bdata;
 	int error;
 
@@ -710,6 +750,12 @@ hammer2_chain_lock(hammer2_chain_t *chain, int how)
 		 * cache, which might not be true (need biodep on flush
 		 * to calculate crc?  or simple crc?).
 		 */
+	} else if (hammer2_io_crc_good(chain, &mask)) {
+		/*
+		 * The check code for this range of the device buffer has
+		 * already been validated and the buffer has not been
+		 * reloaded or modified since.
+		 */
 	} else {
 		if (hammer2_chain_testcheck(chain, bdata) == 0) {
 			printf("chain %016x.%02x meth=%02x CHECK FAIL %08x (flags=%08x)\n",
@@ -718,6 +764,8 @@ hammer2_chain_lock(hammer2_chain_t *chain, int how)
 				chain->bref.methods,
 				hammer2_icrc32(bdata, chain->bytes),
 				(unsigned int)chain->flags);
+		} else {
+			hammer2_io_crc_setmask(chain->dio, mask);
 		}
 	}
 
@@ -1281,7 +1329,8 @@ hammer2_chain_modify(hammer2_trans_t *trans, hammer2_chain_t *chain, int flags)
 		if (chain->data) {
 			KKASSERT(chain->dio != NULL);
 			if (chain->data != (void *)bdata) {
-				bcopy(chain->data, bdata, chain->bytes);
+				bcopy(chain->data, bdata,
+				      hammer2_chain_psize(chain));
 			}
 		} else if (wasinitial == 0) {
 			/*
@@ -1305,6 +1354,14 @@ hammer2_chain_modify(hammer2_trans_t *trans, hammer2_chain_t *chain, int flags)
 		chain->data = (void *)bdata;
 		chain->dio = dio;
 		hammer2_io_setdirty(dio);	/* modified by bcopy above */
+
+		/*
+		 * The media data is about to change, any cached check code
+		 * verification for this range is no longer valid.
+		 */
+		hammer2_io_crc_clrmask(dio, hammer2_io_mask(dio,
+						chain->bref.data_off,
+						chain->bytes));
 		break;
 	default:
 		panic("hammer2_chain_modify: illegal non-embedded type %d",
@@ -3431,6 +3488,10 @@ hammer2_base_find(hammer2_chain_t *parent,
 	hammer2_blockref_t *scan;
 	hammer2_key_t scan_end;
 	int i;
+	int j;
+	int lo;
+	int hi;
+	int mid;
 	int limit;
 
 	/*
@@ -3446,61 +3507,52 @@ hammer2_base_find(hammer2_chain_t *parent,
 		return(count);
 
 	/*
-	 * Sequential optimization using *cache_indexp.  This is the most
-	 * likely scenario.
+	 * Binary search the live portion of the array for the first
+	 * element which encloses key_beg or lies beyond it.  Elements are
+	 * sorted and do not overlap, so (scan_end >= key_beg) is monotonic
+	 * across the non-empty elements.  Deletions leave empty holes
+	 * below live_zero which are skipped by probing forward from the
+	 * midpoint.
 	 *
-	 * We can avoid trailing empty entries on live chains, otherwise
-	 * we might have to check the whole block array.
+	 * Elements at or beyond live_zero are always empty on live chains.
 	 */
-	i = *cache_indexp;
-	cpu_ccfence();
 	limit = parent->core.live_zero;
+	cpu_ccfence();
+	if (limit > count)
+		limit = count;
+	lo = 0;
+	hi = limit;
+	i = limit;
+	while (lo < hi) {
+		j = (lo + hi) >> 1;
+		mid = j;
+		while (j < hi && base[j].type == 0)
+			++j;
+		if (j == hi) {
+			hi = mid;
+			continue;
+		}
+		scan_end = base[j].key +
+			   ((hammer2_key_t)1 << base[j].keybits) - 1;
+		if (scan_end >= key_beg) {
+			i = j;
+			hi = mid;
+		} else {
+			lo = j + 1;
+		}
+	}
 	if (i >= limit)
-		i = limit - 1;
-	if (i < 0)
-		i = 0;
-	KKASSERT(i < count);
+		return (count);
 
 	/*
-	 * Search backwards
+	 * *cache_indexp is retained as a hint for callers but no longer
+	 * drives the search.
 	 */
-	scan = &base[i];
-	while (i > 0 && (scan->type == 0 || scan->key > key_beg)) {
-		--scan;
-		--i;
-	}
 	*cache_indexp = i;
-
-	/*
-	 * Search forwards, stop when we find a scan element which
-	 * encloses the key or until we know that there are no further
-	 * elements.
-	 */
-	while (i < count) {
-		if (scan->type != 0) {
-			scan_end = scan->key +
-				   ((hammer2_key_t)1 << scan->keybits) - 1;
-			if (scan->key > key_beg || scan_end >= key_beg)
-				break;
-		}
-		if (i >= limit)
-			return (count);
-		++scan;
-		++i;
-	}
-	if (i != count) {
-		*cache_indexp = i;
-		if (i >= limit) {
-			i = count;
-		} else {
-			scan_end = scan->key +
-				   ((hammer2_key_t)1 << scan->keybits);
-			if (scan_end && (*key_nextp > scan_end ||
-					 *key_nextp == 0)) {
-				*key_nextp = scan_end;
-			}
-		}
-	}
+	scan = &base[i];
+	scan_end = scan->key + ((hammer2_key_t)1 << scan->keybits);
+	if (scan_end && (*key_nextp > scan_end || *key_nextp == 0))
+		*key_nextp = scan_end;
 	return (i);
 }
 
@@ -3752,9 +3804,13 @@ hammer2_base_insert(hammer2_trans_t *trans __unused, hammer2_chain_t *parent,
 	panic("hammer2_base_insert: no room!");
 
 	/*
-	 * Debugging
+	 * Debugging.  Validating the ordering of the whole array is
+	 * O(count) per insertion, which adds up quickly on 1024-entry
+	 * indirect blocks, so only do it when requested.
 	 */
 validate:
+	if ((hammer2_debug & 0x0080) == 0)
+		return;
 	key_next = 0;
 	for (l = 0; l < count; ++l) {
 		if (base[l].type) {
@@ -3879,6 +3935,8 @@ hammer2_chain_wait(hammer2_chain_t *chain)
 void
 hammer2_chain_setcheck(hammer2_chain_t *chain, void *bdata)
 {
+	size_t bytes = hammer2_chain_psize(chain);
+
 	chain->bref.flags &= ~HAMMER2_BREF_FLAG_ZERO;
 
 	switch(HAMMER2_DEC_CHECK(chain->bref.methods)) {
@@ -3888,11 +3946,11 @@ hammer2_chain_setcheck(hammer2_chain_t *chain, void *bdata)
 		break;
 	case HAMMER2_CHECK_ISCSI32:
 		chain->bref.check.iscsi32.value =
-			hammer2_icrc32(bdata, chain->bytes);
+			hammer2_icrc32(bdata, bytes);
 		break;
 	case HAMMER2_CHECK_CRC64:
-		chain->bref.check.crc64.value = 0;
-		/* XXX */
+		chain->bref.check.crc64.value =
+			hammer2_crc64(bdata, bytes);
 		break;
 	case HAMMER2_CHECK_SHA192:
 		{
@@ -3903,7 +3961,7 @@ hammer2_chain_setcheck(hammer2_chain_t *chain, void *bdata)
 			} u;
 
 			HMAC_SHA256_Init(&hash_ctx, "\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b", 16);
-			HMAC_SHA256_Update(&hash_ctx, bdata, chain->bytes);
+			HMAC_SHA256_Update(&hash_ctx, bdata, bytes);
 			HMAC_SHA256_Final(u.digest, &hash_ctx);
 			u.digest64[2] ^= u.digest64[3];
 			bcopy(u.digest,
@@ -3913,7 +3971,7 @@ hammer2_chain_setcheck(hammer2_chain_t *chain, void *bdata)
 		break;
 	case HAMMER2_CHECK_FREEMAP:
 		chain->bref.check.freemap.icrc32 =
-			hammer2_icrc32(bdata, chain->bytes);
+			hammer2_icrc32(bdata, bytes);
 		break;
 	default:
 		printf("hammer2_chain_setcheck: unknown check type %02x\n",
@@ -3925,6 +3983,7 @@ hammer2_chain_setcheck(hammer2_chain_t *chain, void *bdata)
 int
 hammer2_chain_testcheck(hammer2_chain_t *chain, void *bdata)
 {
+	size_t bytes = hammer2_chain_psize(chain);
 	int r;
 
 	if (chain->bref.flags & HAMMER2_BREF_FLAG_ZERO)
@@ -3939,11 +3998,11 @@ hammer2_chain_testcheck(hammer2_chain_t *chain, void *bdata)
 		break;
 	case HAMMER2_CHECK_ISCSI32:
 		r = (chain->bref.check.iscsi32.value ==
-		     hammer2_icrc32(bdata, chain->bytes));
+		     hammer2_icrc32(bdata, bytes));
 		break;
 	case HAMMER2_CHECK_CRC64:
-		r = (chain->bref.check.crc64.value == 0);
-		/* XXX */
+		r = (chain->bref.check.crc64.value ==
+		     hammer2_crc64(bdata, bytes));
 		break;
 	case HAMMER2_CHECK_SHA192:
 		{
@@ -3954,7 +4013,7 @@ hammer2_chain_testcheck(hammer2_chain_t *chain, void *bdata)
 			} u;
 
 			HMAC_SHA256_Init(&hash_ctx, "\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b", 16);
-			HMAC_SHA256_Update(&hash_ctx, bdata, chain->bytes);
+			HMAC_SHA256_Update(&hash_ctx, bdata, bytes);
 			HMAC_SHA256_Final(u.digest, &hash_ctx);
 			u.digest64[2] ^= u.digest64[3];
 			if (bcmp(u.digest,
@@ -3968,11 +4027,11 @@ hammer2_chain_testcheck(hammer2_chain_t *chain, void *bdata)
 		break;
 	case HAMMER2_CHECK_FREEMAP:
 		r = (chain->bref.check.freemap.icrc32 ==
-		     hammer2_icrc32(bdata, chain->bytes));
+		     hammer2_icrc32(bdata, bytes));
 		if (r == 0) {
 			printf("freemap.icrc %08x icrc32 %08x (%d)\n",
 				chain->bref.check.freemap.icrc32,
-				hammer2_icrc32(bdata, chain->bytes), chain->bytes);
+				hammer2_icrc32(bdata, bytes), chain->bytes);
 			if (chain->dio)
 				printf("dio %p \n", chain->dio);
 				//printf("dio %p buf %016x,  %d bdata %p / %p\n",
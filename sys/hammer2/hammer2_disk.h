@@ -291,6 +291,8 @@ typedef struct dmsg_vol_data dmsg_vol_data_t;
 #define HAMMER2_ZONE_FREEMAP_06		25	/* batch freeing code only */
 #define HAMMER2_ZONE_FREEMAP_07		29	/* batch freeing code only */
 #define HAMMER2_ZONE_FREEMAP_08		33	/* (non-inclusive) */
+#define HAMMER2_ZONE_FSYNCLOG		33	/* fsync log ring (zone 0) */
+#define HAMMER2_ZONE_FSYNCLOG_END	49	/* (non-inclusive) */
 #define HAMMER2_ZONE_UNUSED62		62
 #define HAMMER2_ZONE_UNUSED63		63
 
@@ -511,7 +513,7 @@ struct hammer2_blockref {		/* MUST BE EXACTLY 64 BYTES */
 	uint8_t		keybits;	/* #of keybits masked off 0=leaf */
 	uint8_t		vradix;		/* virtual data/meta-data size */
 	uint8_t		flags;		/* blockref flags */
-	uint8_t		reserved06;
+	uint8_t		psize;		/* packed phys size (1KB units) */
 	uint8_t		reserved07;
 	hammer2_key_t	key;		/* key specification */
 	hammer2_tid_t	mirror_tid;	/* propagate for mirror scan */
@@ -554,6 +556,19 @@ typedef struct hammer2_blockref hammer2_blockref_t;
 
 #define HAMMER2_BLOCKREF_BYTES		64	/* blockref struct in bytes */
 
+/*
+ * Compressed file data can be packed into fewer bytes than the power-of-2
+ * radix encoded in data_off.  The radix still determines the device I/O
+ * size while psize (in HAMMER2_ALLOC_MIN units, 0 if not packed) is the
+ * amount of media actually allocated and covered by the check code.
+ * Only containers up to a freemap block (16KB) are packed, and only on
+ * volumes with HAMMER2_VOLF_PACKED set.  The field is reserved (zero) on
+ * other volumes.
+ */
+#define HAMMER2_BREF_PSIZE(bref)					\
+	((bref)->psize ? (size_t)(bref)->psize * HAMMER2_ALLOC_MIN :	\
+	 (size_t)1 << (int)((bref)->data_off & HAMMER2_OFF_MASK_RADIX))
+
 /*
  * On-media and off-media blockref types.
  */
@@ -605,10 +620,12 @@ typedef struct hammer2_blockref hammer2_blockref_t;
 #define HAMMER2_COMP_AUTOZERO		1
 #define HAMMER2_COMP_LZ4		2
 #define HAMMER2_COMP_ZLIB		3
+#define HAMMER2_COMP_ZSTD		4
 
 #define HAMMER2_COMP_NEWFS_DEFAULT	HAMMER2_COMP_LZ4
-#define HAMMER2_COMP_STRINGS		{ "none", "autozero", "lz4", "zlib" }
-#define HAMMER2_COMP_STRINGS_COUNT	4
+#define HAMMER2_COMP_STRINGS		{ "none", "autozero", "lz4", "zlib", \
+					  "zstd" }
+#define HAMMER2_COMP_STRINGS_COUNT	5
 
 
 /*
@@ -688,6 +705,13 @@ typedef struct hammer2_blockset hammer2_blockset_t;
  *	     to localize inodes and indrect blocks, improving bulk free scans
  *	     and directory scans.
  *
+ * freehint- Allocator hint, the radix of the largest free aligned run in
+ *	     the bitmap (14-16), HAMMER2_BMAP_HINT_NONE if no 16KB block
+ *	     is free, or 0 if unknown.  Lets the allocator skip a full
+ *	     entry without scanning its bitmap.  Reset to 0 whenever
+ *	     blocks are freed.  Only maintained and trusted on volumes
+ *	     with HAMMER2_VOLF_FREEHINT, older kernels do not reset it.
+ *
  * bitmap  - Two bits per 16KB allocation block arranged in arrays of
  *	     32-bit elements, 128x2 bits representing ~2MB worth of media
  *	     storage.  Bit patterns are as follows:
@@ -700,7 +724,7 @@ typedef struct hammer2_blockset hammer2_blockset_t;
 struct hammer2_bmap_data {
 	int32_t linear;		/* 00 linear sub-granular allocation offset */
 	uint16_t class;		/* 04-05 clustering class ((type<<8)|radix) */
-	uint8_t reserved06;	/* 06 */
+	uint8_t freehint;	/* 06 largest free radix hint (0=unknown) */
 	uint8_t reserved07;	/* 07 */
 	uint32_t reserved08;	/* 08 */
 	uint32_t reserved0C;	/* 0C */
@@ -713,6 +737,8 @@ struct hammer2_bmap_data {
 
 typedef struct hammer2_bmap_data hammer2_bmap_data_t;
 
+#define HAMMER2_BMAP_HINT_NONE	1	/* freehint: no free 16KB blocks */
+
 /*
  * In HAMMER2 inodes ARE directory entries, with a special exception for
  * hardlinks.  The inode number is stored in the inode rather than being
@@ -769,7 +795,7 @@ typedef struct hammer2_bmap_data hammer2_bmap_data_t;
 
 struct hammer2_inode_data {
 	uint16_t	version;	/* 0000 inode data version */
-	uint16_t	reserved02;	/* 0002 */
+	uint16_t	comp_hint;	/* 0002 incompressible range bitmap */
 
 	/*
 	 * core inode attributes, inode type, misc flags
@@ -1006,7 +1032,7 @@ struct hammer2_volume_data {
 	 *	 made to or under PFS roots.
 	 */
 	hammer2_tid_t	mirror_tid;		/* 0078 committed tid (vol) */
-	hammer2_tid_t	reserved0080;		/* 0080 */
+	hammer2_tid_t	fsynclog_seq;		/* 0080 fsync log (VOLF_FSYNCLOG) */
 	hammer2_tid_t	reserved0088;		/* 0088 */
 	hammer2_tid_t	freemap_tid;		/* 0090 committed tid (fmap) */
 	hammer2_tid_t	bulkfree_tid;		/* 0098 bulkfree incremental */
@@ -1112,8 +1138,57 @@ typedef struct hammer2_volume_data hammer2_volume_data_t;
 #define HAMMER2_VOL_VERSION_DEFAULT	1
 #define HAMMER2_VOL_VERSION_WIP 	2
 
+/*
+ * Volume feature flags (voldata.flags).  A volume with a flag we do not
+ * know about must not be mounted.
+ */
+#define HAMMER2_VOLF_PACKED		0x00000001	/* blockref psize */
+#define HAMMER2_VOLF_FSYNCLOG		0x00000002	/* fsync log */
+#define HAMMER2_VOLF_FREEHINT		0x00000004	/* bmap freehint */
+#define HAMMER2_VOLF_SUPPORTED		(HAMMER2_VOLF_PACKED |		\
+					 HAMMER2_VOLF_FSYNCLOG |	\
+					 HAMMER2_VOLF_FREEHINT)
+
 #define HAMMER2_NUM_VOLHDRS		4
 
+/*
+ * fsync log record (see hammer2_fsynclog.c), only used on volumes with
+ * HAMMER2_VOLF_FSYNCLOG.
+ *
+ * fsync() writes the inode's subtree out to new blocks without
+ * propagating the change to the root and then records the inode's
+ * updated media data, along with the directory key path leading to it
+ * from the volume root, in a ring in the reserved area of zone 0.
+ *
+ * A volume header covers every record whose seq is below its
+ * fsynclog_seq.  The mount code replays the remaining records in seq
+ * order.  The icrc covers the whole record with icrc itself zeroed.
+ *
+ * Each record gets a 4KB slot so it can be written without touching
+ * its neighbours on 4K-native disks.
+ */
+#define HAMMER2_FSYNCLOG_MAGIC		0x48414d3246534c47LLU	/* HAM2FSLG */
+#define HAMMER2_FSYNCLOG_MAXDEPTH	64
+#define HAMMER2_FSYNCLOG_BYTES		4096
+#define HAMMER2_FSYNCLOG_COUNT		((HAMMER2_ZONE_FSYNCLOG_END -	\
+					  HAMMER2_ZONE_FSYNCLOG) *	\
+					 (HAMMER2_PBUFSIZE /		\
+					  HAMMER2_FSYNCLOG_BYTES))
+
+struct hammer2_fsynclog_data {
+	uint64_t	magic;			/* 0000 HAMMER2_FSYNCLOG_MAGIC */
+	hammer2_tid_t	seq;			/* 0008 record sequence number */
+	uuid_t		fsid;			/* 0010 volume fsid */
+	uint32_t	depth;			/* 0020 keys in path[] */
+	hammer2_crc32_t	icrc;			/* 0024 record icrc */
+						/* 0028-0227 inode key path */
+	hammer2_key_t	path[HAMMER2_FSYNCLOG_MAXDEPTH];
+	char		reserved0228[472];	/* 0228-03FF */
+	hammer2_inode_data_t ipdata;		/* 0400-07FF logged inode */
+};
+
+typedef struct hammer2_fsynclog_data hammer2_fsynclog_data_t;
+
 union hammer2_media_data {
 	hammer2_volume_data_t	voldata;
         hammer2_inode_data_t    ipdata;
@@ -54,6 +54,7 @@
 #include <sys/lock.h>
 #include <sys/uuid.h>
 #include <sys/kernel.h>
+#include <sys/kthread.h>
 
 #include "hammer2.h"
 
@@ -82,28 +83,62 @@ struct hammer2_flush_info {
 
 typedef struct hammer2_flush_info hammer2_flush_info_t;
 
+/*
+ * Dirty child subtrees handed to the per-device flush workers.  Sibling
+ * subtrees are independent until they update their parent's block table,
+ * which they serialize on the parent's chain lock, so the dispatching
+ * flush only has to join its group before flushing the parent itself.
+ *
+ * Each work item carries its own copy of the flush transaction, the
+ * allocator adjusts trans->sync_xid temporarily.
+ */
+struct hammer2_flush_group {
+	struct h2_flush_workq pending;	/* not yet picked up */
+	int		count;		/* dispatched, not yet complete */
+};
+
+struct hammer2_flush_work {
+	TAILQ_ENTRY(hammer2_flush_work) entry;	/* hmp->flush_workq */
+	TAILQ_ENTRY(hammer2_flush_work) gentry;	/* grp->pending */
+	struct hammer2_flush_group *grp;
+	hammer2_chain_t	*chain;			/* referenced */
+	int		depth;			/* recursion depth of chain */
+	hammer2_trans_t	trans;
+};
+
+static void hammer2_flush_subtree(hammer2_trans_t *trans,
+				hammer2_chain_t *chain, int depth);
 static void hammer2_flush_core(hammer2_flush_info_t *info,
 				hammer2_chain_t *chain, int deleting);
 static int hammer2_flush_recurse(hammer2_chain_t *child, void *data);
+static void hammer2_flush_dispatch(hammer2_flush_info_t *info,
+				hammer2_chain_t *parent);
+static void hammer2_flush_work_run(struct hammer2_flush_work *work);
+static void hammer2_flush_thread(void *arg);
 
 /*
- * For now use a global transaction manager.  What we ultimately want to do
- * is give each non-overlapping hmp/pmp group its own transaction manager.
+ * Each device mount (hmp) has its own transaction manager which is shared
+ * by its super-root and every PFS mounted from it, so unrelated devices do
+ * not serialize against each other.  XIDs are still allocated from a single
+ * global counter so they remain ordered across the devices making up a
+ * cluster.
  *
- * Transactions govern XID tracking on the physical media (the hmp), but they
- * also govern TID tracking which is per-PFS and thus might cross multiple
- * hmp's.  So we can't just stuff tmanage into hammer2_mount or
- * hammer2_pfsmount.
+ * The devices backing a PFS cluster which spans several devices, and every
+ * PFS mounted from them, use hammer2_tmanage_shared instead so a flush of
+ * any of those devices still excludes the PFS's frontend transactions
+ * (see hammer2_mount_share_tman()).
  */
-static hammer2_trans_manage_t	tmanage;
+static hammer2_xid_t	hammer2_alloc_xid = 2;
+hammer2_trans_manage_t	hammer2_tmanage_shared;
 
 void
-hammer2_trans_manage_init(void)
+hammer2_trans_manage_init(hammer2_trans_manage_t *tman)
 {
-	lockinit(&tmanage.translk, 0, "h2trans", 0, LK_NOWAIT);
-	TAILQ_INIT(&tmanage.transq);
-	tmanage.flush_xid = 1;
-	tmanage.alloc_xid = tmanage.flush_xid + 1;
+	mtx_init(&tman->translk, IPL_NONE);
+	TAILQ_INIT(&tman->transq);
+	tman->flush_xid = 1;
+	tman->fastcnt = 0;
+	tman->flushcnt = 0;
 }
 
 hammer2_xid_t
@@ -112,7 +147,7 @@ hammer2_trans_newxid(hammer2_pfsmount_t *pmp __unused)
 	hammer2_xid_t xid;
 
 	for (;;) {
-		xid = atomic_fetchadd_int(&tmanage.alloc_xid, 1);
+		xid = atomic_fetchadd_int(&hammer2_alloc_xid, 1);
 		if (xid)
 			break;
 	}
@@ -138,6 +173,10 @@ hammer2_trans_newxid(hammer2_pfsmount_t *pmp __unused)
  * Buffer-cache transactions operate as fs_ops but never block.  A
  * buffer-cache flush will run either before or after the current pending
  * flush depending on its state.
+ *
+ * When no flush is pending, fs_ops are not queued at all.  They are
+ * counted in tman->fastcnt and a flush waits for the count to drain,
+ * which is equivalent to waiting for them to leave the head of the queue.
  */
 void
 hammer2_trans_init(hammer2_trans_t *trans, hammer2_pfsmount_t *pmp, int flags)
@@ -145,15 +184,40 @@ hammer2_trans_init(hammer2_trans_t *trans, hammer2_pfsmount_t *pmp, int flags)
 	hammer2_trans_manage_t *tman;
 	hammer2_trans_t *head;
 	struct thread *curthread;
+	hammer2_xid_t xid;
+	u_int cnt;
 
-	tman = &tmanage;
+again:
+	tman = pmp->tman;
 
 	bzero(trans, sizeof(*trans));
 	trans->pmp = pmp;
+	trans->tman = tman;
 	trans->flags = flags;
 	trans->td = curthread;
 
-	lockmgr(&tman->translk, LK_EXCLUSIVE, NULL);
+	/*
+	 * Fast path, no flush is pending.  The xid is sampled before the
+	 * count is bumped, a flush sets FLUSHING before it advances
+	 * flush_xid so a successful cmpset means the sample is current.
+	 */
+	if ((flags & HAMMER2_TRANS_ISFLUSH) == 0) {
+		for (;;) {
+			cnt = tman->fastcnt;
+			if (cnt & HAMMER2_TMANAGE_FLUSHING)
+				break;
+			xid = tman->flush_xid;
+			if (atomic_cmpset_int(&tman->fastcnt, cnt, cnt + 1)) {
+				trans->flags |= HAMMER2_TRANS_FASTPATH;
+				trans->sync_xid = xid + 1;
+				break;
+			}
+		}
+		if (trans->flags & HAMMER2_TRANS_FASTPATH)
+			goto done;
+	}
+
+	mtx_enter(&tman->translk);
 
 	if (flags & HAMMER2_TRANS_ISFLUSH) {
 		/*
@@ -166,8 +230,14 @@ hammer2_trans_init(hammer2_trans_t *trans, hammer2_pfsmount_t *pmp, int flags)
 		 * Multiple normal transactions can share the current
 		 * transaction id but a flush transaction needs its own
 		 * unique TID for proper block table update accounting.
+		 *
+		 * The first pending flush closes the fast path before
+		 * flush_xid is advanced.
 		 */
-		++tman->flushcnt;
+		if (tman->flushcnt++ == 0) {
+			atomic_set_int(&tman->fastcnt,
+				       HAMMER2_TMANAGE_FLUSHING);
+		}
 		++pmp->alloc_tid;
 		pmp->flush_tid = pmp->alloc_tid;
 		tman->flush_xid = hammer2_trans_newxid(pmp);
@@ -177,13 +247,29 @@ hammer2_trans_init(hammer2_trans_t *trans, hammer2_pfsmount_t *pmp, int flags)
 		if (TAILQ_FIRST(&tman->transq) != trans) {
 			trans->blocked = 1;
 			while (trans->blocked) {
-				lksleep(&trans->sync_xid, &tman->translk,
+				msleep(&trans->sync_xid, &tman->translk,
 					0, "h2multf", hz);
 			}
 		}
+
+		/*
+		 * Wait for fast path transactions which predate the
+		 * flush.  The WAITING bit requests a wakeup from the
+		 * last one out.
+		 */
+		while (tman->fastcnt & HAMMER2_TMANAGE_MASK) {
+			atomic_set_int(&tman->fastcnt,
+				       HAMMER2_TMANAGE_WAITING);
+			if ((tman->fastcnt & HAMMER2_TMANAGE_MASK) == 0)
+				break;
+			msleep(&tman->fastcnt, &tman->translk,
+				0, "h2fastw", hz);
+		}
+		atomic_clear_int(&tman->fastcnt, HAMMER2_TMANAGE_WAITING);
 	} else if (tman->flushcnt == 0) {
 		/*
 		 * No flushes are pending, we can go.  Use prior flush_xid + 1.
+		 * (The flush which closed the fast path has since finished).
 		 *
 		 * WARNING!  Also see hammer2_chain_setflush()
 		 */
@@ -235,18 +321,31 @@ hammer2_trans_init(hammer2_trans_t *trans, hammer2_pfsmount_t *pmp, int flags)
 		 * If synchronous flush mode is enabled concurrent
 		 * frontend transactions during the flush are not
 		 * allowed (except we don't have a choice for buffer
-		 * cache ops).
+		 * cache ops).  Background flushes only flush inodes
+		 * they hold locked and never exclude the frontend.
 		 */
-		if (hammer2_synchronous_flush > 0 ||
+		if ((hammer2_synchronous_flush > 0 &&
+		     (head->flags & HAMMER2_TRANS_BACKGROUND) == 0) ||
 		    TAILQ_FIRST(&tman->transq) != head) {
 			trans->blocked = 1;
 			while (trans->blocked) {
-				lksleep(&trans->sync_xid,
+				msleep(&trans->sync_xid,
 					&tman->translk, 0,
 					"h2multf", hz);
 			}
 		}
 	}
+	mtx_leave(&tman->translk);
+done:
+	/*
+	 * The PFS was moved to the shared manager while we waited on its
+	 * old one, retry there.
+	 */
+	if (tman != pmp->tman) {
+		hammer2_trans_done(trans);
+		goto again;
+	}
+
 	if (flags & HAMMER2_TRANS_NEWINODE) {
 		if (pmp->spmp_hmp) {
 			/*
@@ -259,19 +358,22 @@ hammer2_trans_init(hammer2_trans_t *trans, hammer2_pfsmount_t *pmp, int flags)
 			/*
 			 * Normal transaction
 			 */
+			mtx_enter(&tman->translk);
 			if (pmp->inode_tid < HAMMER2_INODE_START)
 				pmp->inode_tid = HAMMER2_INODE_START;
 			trans->inode_tid = pmp->inode_tid++;
+			mtx_leave(&tman->translk);
 		}
 	}
-
-	lockmgr(&tman->translk, LK_RELEASE, NULL);
 }
 
 /*
  * This may only be called while in a flush transaction.  It's a bit of a
  * hack but after flushing a PFS we need to flush each volume root as part
  * of the same transaction.
+ *
+ * trans->tman is left alone, the transaction is still retired on the
+ * manager it was queued on.
  */
 void
 hammer2_trans_spmp(hammer2_trans_t *trans, hammer2_pfsmount_t *spmp)
@@ -289,13 +391,38 @@ hammer2_trans_done(hammer2_trans_t *trans)
 	hammer2_trans_manage_t *tman;
 	hammer2_trans_t *head;
 	hammer2_trans_t *scan;
+	u_int cnt;
+	u_int ncnt;
 
-	tman = &tmanage;
+	tman = trans->tman;
+
+	/*
+	 * Fast path transactions were never queued, just drop the count.
+	 * The last one out wakes up a flush waiting for the drain.
+	 */
+	if (trans->flags & HAMMER2_TRANS_FASTPATH) {
+		for (;;) {
+			cnt = tman->fastcnt;
+			KKASSERT(cnt & HAMMER2_TMANAGE_MASK);
+			ncnt = cnt - 1;
+			if ((ncnt & HAMMER2_TMANAGE_MASK) == 0)
+				ncnt &= ~HAMMER2_TMANAGE_WAITING;
+			if (atomic_cmpset_int(&tman->fastcnt, cnt, ncnt))
+				break;
+		}
+		if ((cnt & HAMMER2_TMANAGE_WAITING) &&
+		    (ncnt & HAMMER2_TMANAGE_MASK) == 0) {
+			mtx_enter(&tman->translk);
+			wakeup(&tman->fastcnt);
+			mtx_leave(&tman->translk);
+		}
+		return;
+	}
 
 	/*
 	 * Remove.
 	 */
-	lockmgr(&tman->translk, LK_EXCLUSIVE, NULL);
+	mtx_enter(&tman->translk);
 	TAILQ_REMOVE(&tman->transq, trans, entry);
 	head = TAILQ_FIRST(&tman->transq);
 
@@ -303,9 +430,14 @@ hammer2_trans_done(hammer2_trans_t *trans)
 	 * Adjust flushcnt if this was a flush, clear TRANS_CONCURRENT
 	 * up through the next flush.  (If the head is a flush then we
 	 * stop there, unlike the unblock code following this section).
+	 *
+	 * The fast path reopens once the last pending flush is done.
 	 */
 	if (trans->flags & HAMMER2_TRANS_ISFLUSH) {
-		--tman->flushcnt;
+		if (--tman->flushcnt == 0) {
+			atomic_clear_int(&tman->fastcnt,
+					 HAMMER2_TMANAGE_FLUSHING);
+		}
 		scan = head;
 		while (scan && (scan->flags & HAMMER2_TRANS_ISFLUSH) == 0) {
 			atomic_clear_int(&scan->flags,
@@ -321,13 +453,14 @@ hammer2_trans_done(hammer2_trans_t *trans)
 	 * (which are allowed to run concurrently with it).
 	 *
 	 * In synchronous flush mode we stop if the head transaction is
-	 * a flush.
+	 * a flush, unless it is a background flush.
 	 */
 	if (head && head->blocked) {
 		head->blocked = 0;
 		wakeup(&head->sync_xid);
 
-		if (hammer2_synchronous_flush > 0)
+		if (hammer2_synchronous_flush > 0 &&
+		    (head->flags & HAMMER2_TRANS_BACKGROUND) == 0)
 			scan = head;
 		else
 			scan = TAILQ_NEXT(head, entry);
@@ -339,7 +472,7 @@ hammer2_trans_done(hammer2_trans_t *trans)
 			scan = TAILQ_NEXT(scan, entry);
 		}
 	}
-	lockmgr(&tman->translk, LK_RELEASE, NULL);
+	mtx_leave(&tman->translk);
 }
 
 /*
@@ -365,6 +498,19 @@ hammer2_trans_done(hammer2_trans_t *trans)
  */
 void
 hammer2_flush(hammer2_trans_t *trans, hammer2_chain_t *chain)
+{
+	hammer2_flush_subtree(trans, chain, 0);
+}
+
+/*
+ * Flush chain starting at the specified recursion depth.  Subtrees run
+ * by the flush workers (or inline by a joining flush) continue at the
+ * depth of the dispatching flush so the depth limit still bounds the
+ * stack.
+ */
+static void
+hammer2_flush_subtree(hammer2_trans_t *trans, hammer2_chain_t *chain,
+		      int depth)
 {
 	hammer2_chain_t *scan;
 	hammer2_flush_info_t info;
@@ -381,6 +527,7 @@ hammer2_flush(hammer2_trans_t *trans, hammer2_chain_t *chain)
 	bzero(&info, sizeof(info));
 	TAILQ_INIT(&info.flushq);
 	info.trans = trans;
+	info.depth = depth;
 	info.sync_xid = trans->sync_xid;
 	info.cache_index = -1;
 
@@ -420,7 +567,7 @@ hammer2_flush(hammer2_trans_t *trans, hammer2_chain_t *chain)
 				printf("deferred flush %p\n", scan);
 			hammer2_chain_lock(scan, HAMMER2_RESOLVE_MAYBE);
 			hammer2_chain_drop(scan);	/* ref from deferral */
-			hammer2_flush(trans, scan);
+			hammer2_flush_subtree(trans, scan, depth);
 			hammer2_chain_unlock(scan);
 		}
 
@@ -541,6 +688,7 @@ hammer2_flush_core(hammer2_flush_info_t *info, hammer2_chain_t *chain,
 
 		atomic_clear_int(&chain->flags, HAMMER2_CHAIN_ONFLUSH);
 		info->parent = chain;
+		hammer2_flush_dispatch(info, chain);
 		__mp_lock((struct __mp_lock *)&chain->core.cst.spin);
 		RB_SCAN(hammer2_chain_tree, &chain->core.rbtree,
 			NULL, hammer2_flush_recurse, info);
@@ -674,6 +822,13 @@ again:
 			 */
 			hmp->voldata.mirror_tid = chain->bref.mirror_tid;
 			hmp->voldata.freemap_tid = hmp->fchain.bref.mirror_tid;
+
+			/*
+			 * fsync log records are only allocated inside flush
+			 * transactions, all records so far are covered.
+			 */
+			if (HAMMER2_VOL_FSYNCLOG(hmp))
+				hmp->voldata.fsynclog_seq = hmp->fsynclog_next;
 			printf("mirror_tid %08x\n",
 				(unsigned int)chain->bref.mirror_tid);
 
@@ -1010,3 +1165,201 @@ hammer2_flush_recurse(hammer2_chain_t *child, void *data)
 
 	return (0);
 }
+
+/*
+ * Dispatch the dirty child subtrees of parent to the flush workers and
+ * join them.  Called from the downward recursion in flush_core with parent
+ * locked, returns with parent locked.  Children which are not dispatched
+ * (or which were re-dirtied) are picked up by the serial scan that
+ * follows.
+ *
+ * Only inodes and indirect blocks are split up.  Data chains are cheap to
+ * flush, their check codes were set by the write path, and the volume
+ * and freemap roots have a single interesting child each.
+ */
+static void
+hammer2_flush_dispatch(hammer2_flush_info_t *info, hammer2_chain_t *parent)
+{
+	hammer2_mount_t *hmp = parent->hmp;
+	struct hammer2_flush_group grp;
+	struct hammer2_flush_work *work;
+	hammer2_chain_t *child;
+
+	if (hmp->flush_count == 0 || (hammer2_debug & 0x200))
+		return;
+
+	/*
+	 * The children would start at the depth limit, let the serial
+	 * scan defer them instead.
+	 */
+	if (info->depth + 1 >= HAMMER2_FLUSH_DEPTH_LIMIT)
+		return;
+	if (parent->bref.type != HAMMER2_BREF_TYPE_INODE &&
+	    parent->bref.type != HAMMER2_BREF_TYPE_INDIRECT) {
+		return;
+	}
+
+	TAILQ_INIT(&grp.pending);
+	grp.count = 0;
+
+	/*
+	 * Collect the dirty children.  Never cross a mounted PFS
+	 * boundary (see hammer2_flush_recurse()).
+	 */
+	__mp_lock((struct __mp_lock *)&parent->core.cst.spin);
+	RB_FOREACH(child, hammer2_chain_tree, &parent->core.rbtree) {
+		if ((child->flags & HAMMER2_CHAIN_FLUSH_MASK) == 0 ||
+		    child->bref.type == HAMMER2_BREF_TYPE_DATA) {
+			continue;
+		}
+		if ((child->flags & HAMMER2_CHAIN_PFSBOUNDARY) &&
+		    child->pmp != NULL) {
+			continue;
+		}
+		work = malloc(sizeof(*work), M_HAMMER2, M_NOWAIT | M_ZERO);
+		if (work == NULL)
+			break;
+		hammer2_chain_ref(child);
+		work->chain = child;
+		work->depth = info->depth + 1;
+		work->grp = &grp;
+		work->trans = *info->trans;
+		TAILQ_INSERT_TAIL(&grp.pending, work, gentry);
+		++grp.count;
+	}
+	__mp_unlock((struct __mp_lock *)&parent->core.cst.spin);
+
+	if (grp.count == 0)
+		return;
+
+	mtx_enter(&hmp->flush_mtx);
+	TAILQ_FOREACH(work, &grp.pending, gentry)
+		TAILQ_INSERT_TAIL(&hmp->flush_workq, work, entry);
+	wakeup(&hmp->flush_workq);
+
+	/*
+	 * Join.  The children lock the parent to update its block table
+	 * so it must be unlocked, the caller's ref keeps it around.  We
+	 * run our own subtrees which no worker has picked up yet instead
+	 * of sleeping, so a join never waits on busy workers.
+	 */
+	mtx_leave(&hmp->flush_mtx);
+	hammer2_chain_unlock(parent);
+	mtx_enter(&hmp->flush_mtx);
+	while (grp.count) {
+		if ((work = TAILQ_FIRST(&grp.pending)) != NULL) {
+			TAILQ_REMOVE(&grp.pending, work, gentry);
+			TAILQ_REMOVE(&hmp->flush_workq, work, entry);
+			mtx_leave(&hmp->flush_mtx);
+			hammer2_flush_work_run(work);
+			mtx_enter(&hmp->flush_mtx);
+			--grp.count;
+			continue;
+		}
+		msleep(&grp, &hmp->flush_mtx, PRIBIO, "h2fjoin", 0);
+	}
+	mtx_leave(&hmp->flush_mtx);
+	hammer2_chain_lock(parent, HAMMER2_RESOLVE_MAYBE);
+}
+
+/*
+ * Flush one dispatched subtree, including the update of its parent's
+ * block table, and dispose of the work item.
+ */
+static void
+hammer2_flush_work_run(struct hammer2_flush_work *work)
+{
+	hammer2_chain_t *chain = work->chain;
+
+	hammer2_chain_lock(chain, HAMMER2_RESOLVE_MAYBE);
+	if (chain->flags & HAMMER2_CHAIN_FLUSH_MASK)
+		hammer2_flush_subtree(&work->trans, chain, work->depth);
+	hammer2_chain_unlock(chain);
+	hammer2_chain_drop(chain);
+	free(work, M_HAMMER2, sizeof(*work));
+}
+
+/*
+ * Start the flush workers for a RW device mount.
+ */
+void
+hammer2_flush_init(hammer2_mount_t *hmp)
+{
+	int n;
+	int i;
+
+	n = hammer2_flush_workers;
+	if (n <= 0)
+		n = ncpus;
+	if (n > HAMMER2_FLUSH_WORKERS_MAX)
+		n = HAMMER2_FLUSH_WORKERS_MAX;
+
+	hmp->flush_destroy = 0;
+	for (i = 0; i < n; ++i) {
+		mtx_enter(&hmp->flush_mtx);
+		++hmp->flush_count;
+		mtx_leave(&hmp->flush_mtx);
+		if (kthread_create(hammer2_flush_thread, hmp,
+				   &hmp->flush_td[i], "h2flush")) {
+			mtx_enter(&hmp->flush_mtx);
+			--hmp->flush_count;
+			mtx_leave(&hmp->flush_mtx);
+			break;
+		}
+	}
+	if (i == 0)
+		printf("hammer2: unable to start flush workers\n");
+}
+
+/*
+ * Stop the flush workers.  Flushes run serially from here on.
+ */
+void
+hammer2_flush_uninit(hammer2_mount_t *hmp)
+{
+	mtx_enter(&hmp->flush_mtx);
+	hmp->flush_destroy = 1;
+	wakeup(&hmp->flush_workq);
+	while (hmp->flush_count) {
+		msleep(&hmp->flush_count, &hmp->flush_mtx, PRIBIO,
+		       "h2flst", 0);
+	}
+	mtx_leave(&hmp->flush_mtx);
+	bzero(hmp->flush_td, sizeof(hmp->flush_td));
+}
+
+/*
+ * Flush worker, runs dispatched subtrees from any flush on the device.
+ */
+static void
+hammer2_flush_thread(void *arg)
+{
+	hammer2_mount_t *hmp = arg;
+	struct hammer2_flush_work *work;
+	struct hammer2_flush_group *grp;
+
+	mtx_enter(&hmp->flush_mtx);
+	for (;;) {
+		if ((work = TAILQ_FIRST(&hmp->flush_workq)) == NULL) {
+			if (hmp->flush_destroy)
+				break;
+			msleep(&hmp->flush_workq, &hmp->flush_mtx, PRIBIO,
+			       "h2flwk", 0);
+			continue;
+		}
+		TAILQ_REMOVE(&hmp->flush_workq, work, entry);
+		grp = work->grp;
+		TAILQ_REMOVE(&grp->pending, work, gentry);
+		mtx_leave(&hmp->flush_mtx);
+
+		hammer2_flush_work_run(work);
+
+		mtx_enter(&hmp->flush_mtx);
+		if (--grp->count == 0)
+			wakeup(grp);
+	}
+	--hmp->flush_count;
+	wakeup(&hmp->flush_count);
+	mtx_leave(&hmp->flush_mtx);
+	kthread_exit(0);
+}
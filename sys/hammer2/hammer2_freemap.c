@@ -56,15 +56,17 @@ typedef struct hammer2_fiterate hammer2_fiterate_t;
 
 static int hammer2_freemap_try_alloc(hammer2_trans_t *trans,
 			hammer2_chain_t **parentp, hammer2_blockref_t *bref,
-			int radix, hammer2_fiterate_t *iter);
+			int radix, size_t asize, hammer2_fiterate_t *iter);
 static void hammer2_freemap_init(hammer2_trans_t *trans, hammer2_mount_t *hmp,
 			hammer2_key_t key, hammer2_chain_t *chain);
 static int hammer2_bmap_alloc(hammer2_trans_t *trans, hammer2_mount_t *hmp,
 			hammer2_bmap_data_t *bmap, uint16_t class,
-			int n, int radix, hammer2_key_t *basep);
+			int n, int radix, size_t asize, hammer2_key_t *basep);
 static int hammer2_freemap_iterate(hammer2_trans_t *trans,
 			hammer2_chain_t **parentp, hammer2_chain_t **chainp,
 			hammer2_fiterate_t *iter);
+static int hammer2_freemap_leaf_usable(hammer2_mount_t *hmp,
+			hammer2_chain_t *chain, uint16_t class, int radix);
 
 static __inline
 int
@@ -73,6 +75,84 @@ hammer2_freemapradix(int radix)
 	return(radix);
 }
 
+/*
+ * Return a mask with the low bit of each bmradix-sized field of the
+ * bitmap word set if that field is entirely zero (free).  The bits of
+ * each field are OR'd down into its low bit so all fields are tested at
+ * once.
+ */
+static __inline
+uint32_t
+hammer2_bmap_freefields(uint32_t bits, int bmradix)
+{
+	switch(bmradix) {
+	case 2:
+		bits |= bits >> 1;
+		return(~bits & 0x55555555U);
+	case 4:
+		bits |= bits >> 1;
+		bits |= bits >> 2;
+		return(~bits & 0x11111111U);
+	case 8:
+		bits |= bits >> 1;
+		bits |= bits >> 2;
+		bits |= bits >> 4;
+		return(~bits & 0x01010101U);
+	case 16:
+		bits |= bits >> 1;
+		bits |= bits >> 2;
+		bits |= bits >> 4;
+		bits |= bits >> 8;
+		return(~bits & 0x00010001U);
+	default:
+		return(bits == 0);
+	}
+}
+
+/*
+ * Radix of the bitmap run needed for an allocation, sub-16KB allocations
+ * need a whole 16KB block when the linear iterator cannot be used.
+ */
+static __inline
+int
+hammer2_bmap_wantradix(int radix)
+{
+	if (radix < HAMMER2_FREEMAP_BLOCK_RADIX)
+		radix = HAMMER2_FREEMAP_BLOCK_RADIX;
+	return(radix);
+}
+
+/*
+ * Recalculate bmap->freehint, the radix of the largest free aligned run
+ * (up to HAMMER2_RADIX_MAX).
+ */
+static
+void
+hammer2_bmap_sethint(hammer2_bmap_data_t *bmap)
+{
+	uint32_t free2;
+	uint32_t free4;
+	uint32_t free8;
+	int i;
+
+	free2 = 0;
+	free4 = 0;
+	free8 = 0;
+	for (i = 0; i < 8; ++i) {
+		free2 |= hammer2_bmap_freefields(bmap->bitmap[i], 2);
+		free4 |= hammer2_bmap_freefields(bmap->bitmap[i], 4);
+		free8 |= hammer2_bmap_freefields(bmap->bitmap[i], 8);
+	}
+	if (free8)
+		bmap->freehint = HAMMER2_FREEMAP_BLOCK_RADIX + 2;
+	else if (free4)
+		bmap->freehint = HAMMER2_FREEMAP_BLOCK_RADIX + 1;
+	else if (free2)
+		bmap->freehint = HAMMER2_FREEMAP_BLOCK_RADIX;
+	else
+		bmap->freehint = HAMMER2_BMAP_HINT_NONE;
+}
+
 /*
  * Calculate the device offset for the specified FREEMAP_NODE or FREEMAP_LEAF
  * bref.  Return a combined media offset and physical size radix.  Freemap
@@ -208,6 +288,11 @@ hammer2_freemap_reserve(hammer2_trans_t *trans, hammer2_chain_t *chain,
  *
  * ip and bpref are only used as a heuristic to determine locality of
  * reference.  bref->key may also be used heuristically.
+ *
+ * (bytes) is the power-of-2 container size.  File data may be packed into
+ * fewer bytes, either as requested by the write path via trans->pack_bytes
+ * or when an already packed block is reallocated for copy-on-write.  The
+ * packed size is recorded in bref->psize, see HAMMER2_BREF_PSIZE().
  */
 int
 hammer2_freemap_alloc(hammer2_trans_t *trans, hammer2_chain_t *chain,
@@ -216,8 +301,11 @@ hammer2_freemap_alloc(hammer2_trans_t *trans, hammer2_chain_t *chain,
 	hammer2_mount_t *hmp = chain->hmp;
 	hammer2_blockref_t *bref = &chain->bref;
 	hammer2_chain_t *parent;
+	struct hammer2_freemap_pcpu *pcpu;
+	size_t asize;
 	int radix;
 	int error;
+	int cpu;
 	unsigned int hindex;
 	hammer2_fiterate_t iter;
 
@@ -242,6 +330,29 @@ hammer2_freemap_alloc(hammer2_trans_t *trans, hammer2_chain_t *chain,
 
 	KKASSERT(bytes >= HAMMER2_ALLOC_MIN && bytes <= HAMMER2_ALLOC_MAX);
 
+	/*
+	 * Determine the packed size.  Packing is done by the linear
+	 * iterator in 1KB units and is thus limited to containers which
+	 * fit in a freemap block (16KB).  Larger allocations use whole
+	 * bitmap fields whose leftovers could not be reused by their class.
+	 * Only volumes with HAMMER2_VOLF_PACKED are packed.
+	 */
+	asize = bytes;
+	if (bref->type == HAMMER2_BREF_TYPE_DATA &&
+	    bytes <= HAMMER2_FREEMAP_BLOCK_SIZE &&
+	    HAMMER2_VOL_PACKABLE(hmp)) {
+		if (trans->pack_bytes &&
+		    hammer2_getradix(trans->pack_bytes) == radix) {
+			asize = trans->pack_bytes;
+		} else if (bref->psize &&
+			   (int)(bref->data_off & HAMMER2_OFF_MASK_RADIX) ==
+			   radix) {
+			asize = HAMMER2_BREF_PSIZE(bref);
+		}
+	}
+	KKASSERT(asize <= bytes && (asize & (HAMMER2_ALLOC_MIN - 1)) == 0);
+	bref->psize = (asize == bytes) ? 0 : asize / HAMMER2_ALLOC_MIN;
+
 	if (trans->flags & (HAMMER2_TRANS_ISFLUSH | HAMMER2_TRANS_PREFLUSH))
 		++trans->sync_xid;
 
@@ -273,6 +384,10 @@ hammer2_freemap_alloc(hammer2_trans_t *trans, hammer2_chain_t *chain,
 	 * bref type if possible.  heur_freemap[] has room for two classes
 	 * for each type.  At a minimum we have to break-up our heuristic
 	 * by device block sizes.
+	 *
+	 * Each cpu has its own set of cursors.  A cursor which has not yet
+	 * been used starts at a per-cpu offset into the volume so writers
+	 * on different cpus do not all pile into the same segment.
 	 */
 	hindex = hammer2_devblkradix(radix) - HAMMER2_MINIORADIX;
 	KKASSERT(hindex < HAMMER2_FREEMAP_HEUR_NRADIX);
@@ -280,7 +395,13 @@ hammer2_freemap_alloc(hammer2_trans_t *trans, hammer2_chain_t *chain,
 	hindex &= HAMMER2_FREEMAP_HEUR_TYPES * HAMMER2_FREEMAP_HEUR_NRADIX - 1;
 	KKASSERT(hindex < HAMMER2_FREEMAP_HEUR);
 
-	iter.bpref = hmp->heur_freemap[hindex];
+	cpu = cpu_number();
+	pcpu = &hmp->freemap_pcpu[cpu];
+	iter.bpref = pcpu->heur_freemap[hindex];
+	if (iter.bpref == 0 && cpu) {
+		iter.bpref = hmp->voldata.volu_size / ncpus * cpu;
+		iter.bpref &= ~HAMMER2_SEGMASK64;
+	}
 
 	/*
 	 * Make sure bpref is in-bounds.  It's ok if bpref covers a zone's
@@ -300,9 +421,9 @@ hammer2_freemap_alloc(hammer2_trans_t *trans, hammer2_chain_t *chain,
 
 	while (error == EAGAIN) {
 		error = hammer2_freemap_try_alloc(trans, &parent, bref,
-						  radix, &iter);
+						  radix, asize, &iter);
 	}
-	hmp->heur_freemap[hindex] = iter.bnext;
+	pcpu->heur_freemap[hindex] = iter.bnext;
 	hammer2_chain_unlock(parent);
 
 	if (trans->flags & (HAMMER2_TRANS_ISFLUSH | HAMMER2_TRANS_PREFLUSH))
@@ -313,7 +434,7 @@ hammer2_freemap_alloc(hammer2_trans_t *trans, hammer2_chain_t *chain,
 
 static int
 hammer2_freemap_try_alloc(hammer2_trans_t *trans, hammer2_chain_t **parentp,
-			  hammer2_blockref_t *bref, int radix,
+			  hammer2_blockref_t *bref, int radix, size_t asize,
 			  hammer2_fiterate_t *iter)
 {
 	hammer2_mount_t *hmp = (*parentp)->hmp;
@@ -387,6 +508,12 @@ hammer2_freemap_try_alloc(hammer2_trans_t *trans, hammer2_chain_t **parentp,
 		 * Already flagged as not having enough space
 		 */
 		error = ENOSPC;
+	} else if (!hammer2_freemap_leaf_usable(hmp, chain, class, radix)) {
+		/*
+		 * No entry can satisfy the request, do not copy-on-write
+		 * the leaf just to find that out.
+		 */
+		error = ENOSPC;
 	} else {
 		/*
 		 * Modify existing chain to setup for adjustment.
@@ -423,7 +550,7 @@ hammer2_freemap_try_alloc(hammer2_trans_t *trans, hammer2_chain_t **parentp,
 				base_key = key + n * l0size;
 				error = hammer2_bmap_alloc(trans, hmp, bmap,
 							   class, n, radix,
-							   &base_key);
+							   asize, &base_key);
 				if (error != ENOSPC) {
 					key = base_key;
 					break;
@@ -436,7 +563,7 @@ hammer2_freemap_try_alloc(hammer2_trans_t *trans, hammer2_chain_t **parentp,
 				base_key = key + n * l0size;
 				error = hammer2_bmap_alloc(trans, hmp, bmap,
 							   class, n, radix,
-							   &base_key);
+							   asize, &base_key);
 				if (error != ENOSPC) {
 					key = base_key;
 					break;
@@ -481,8 +608,47 @@ hammer2_freemap_try_alloc(hammer2_trans_t *trans, hammer2_chain_t **parentp,
 	return (error);
 }
 
+/*
+ * Check the unmodified leaf for an entry which might satisfy the request,
+ * using the same tests hammer2_bmap_alloc() makes before it scans or
+ * touches the bitmap.  A full leaf then costs no copy-on-write.
+ */
+static
+int
+hammer2_freemap_leaf_usable(hammer2_mount_t *hmp, hammer2_chain_t *chain,
+			    uint16_t class, int radix)
+{
+	hammer2_bmap_data_t *bmap;
+	size_t size;
+	int n;
+
+	size = (size_t)1 << radix;
+	for (n = 0; n < HAMMER2_FREEMAP_COUNT; ++n) {
+		bmap = &chain->data->bmdata[n];
+		if (bmap->avail == 0 ||
+		    (bmap->class != 0 && bmap->class != class)) {
+			continue;
+		}
+		if (((uint32_t)bmap->linear & HAMMER2_FREEMAP_BLOCK_MASK) +
+		    size <= HAMMER2_FREEMAP_BLOCK_SIZE &&
+		    (bmap->linear & HAMMER2_FREEMAP_BLOCK_MASK) &&
+		    bmap->linear < HAMMER2_SEGSIZE) {
+			return (1);
+		}
+		if (HAMMER2_VOL_FREEHINT(hmp) && bmap->freehint &&
+		    (bmap->freehint == HAMMER2_BMAP_HINT_NONE ||
+		     bmap->freehint < hammer2_bmap_wantradix(radix))) {
+			continue;
+		}
+		return (1);
+	}
+	return (0);
+}
+
 /*
  * Allocate (1<<radix) bytes from the bmap whos base data offset is (*basep).
+ * Only (asize) bytes are actually consumed, the remainder of the container
+ * stays available to the linear iterator.
  *
  * If the linear iterator is mid-block we use it directly (the bitmap should
  * already be marked allocated), otherwise we search for a block in the bitmap
@@ -496,7 +662,8 @@ static
 int
 hammer2_bmap_alloc(hammer2_trans_t *trans, hammer2_mount_t *hmp,
 		   hammer2_bmap_data_t *bmap,
-		   uint16_t class, int n, int radix, hammer2_key_t *basep)
+		   uint16_t class, int n, int radix, size_t asize,
+		   hammer2_key_t *basep)
 {
 	hammer2_io_t *dio;
 	size_t size;
@@ -556,25 +723,44 @@ hammer2_bmap_alloc(hammer2_trans_t *trans, hammer2_mount_t *hmp,
 		bmmask = (bmradix == 32) ?
 			 0xFFFFFFFFU : (1 << bmradix) - 1;
 		bmmask <<= j;
-		bmap->linear = offset + size;
+		bmap->linear = offset + asize;
 	} else {
+		uint32_t freebits;
+
+		/*
+		 * Skip the scan entirely if the hint says there is no
+		 * sufficiently large free run.
+		 */
+		if (HAMMER2_VOL_FREEHINT(hmp) && bmap->freehint &&
+		    (bmap->freehint == HAMMER2_BMAP_HINT_NONE ||
+		     bmap->freehint < hammer2_bmap_wantradix(radix))) {
+			return (ENOSPC);
+		}
+
+		/*
+		 * Test all bmradix-sized fields of each bitmap word in
+		 * parallel and pick the lowest free one.
+		 */
+		bmmask = (bmradix == 32) ? 0xFFFFFFFFU : (1 << bmradix) - 1;
 		for (i = 0; i < 8; ++i) {
-			bmmask = (bmradix == 32) ?
-				 0xFFFFFFFFU : (1 << bmradix) - 1;
-			for (j = 0; j < 32; j += bmradix) {
-				if ((bmap->bitmap[i] & bmmask) == 0)
-					goto success;
-				bmmask <<= bmradix;
+			freebits = hammer2_bmap_freefields(bmap->bitmap[i],
+							   bmradix);
+			if (freebits) {
+				j = ffs(freebits) - 1;
+				bmmask <<= j;
+				goto success;
 			}
 		}
 		/*fragments might remain*/
 		/*KKASSERT(bmap->avail == 0);*/
+		if (HAMMER2_VOL_FREEHINT(hmp))
+			hammer2_bmap_sethint(bmap);
 		return (ENOSPC);
 success:
 		offset = i * (HAMMER2_SEGSIZE / 8) +
 			 (j * (HAMMER2_FREEMAP_BLOCK_SIZE / 2));
-		if (size & HAMMER2_FREEMAP_BLOCK_MASK)
-			bmap->linear = offset + size;
+		if (asize & HAMMER2_FREEMAP_BLOCK_MASK)
+			bmap->linear = offset + asize;
 	}
 
 	KKASSERT(i >= 0 && i < 8);	/* 8 x 16 -> 128 x 16K -> 2MB */
@@ -642,17 +828,62 @@ success:
 	 */
 	bmap->bitmap[i] |= bmmask;
 	bmap->class = class;
-	bmap->avail -= size;
+	bmap->avail -= asize;
+	if (HAMMER2_VOL_FREEHINT(hmp))
+		hammer2_bmap_sethint(bmap);
 	*basep += offset;
 
-	hammer2_voldata_lock(hmp);
-	hammer2_voldata_modify(hmp);
-	hmp->voldata.allocator_free -= size;  /* XXX */
-	hammer2_voldata_unlock(hmp);
+	/*
+	 * Account for the allocation in our per-cpu delta, it will be
+	 * folded into the volume header when the freemap is flushed.
+	 * The caller holds fchain locked.
+	 */
+	hmp->freemap_pcpu[cpu_number()].free_delta -= asize;
 
 	return(0);
 }
 
+/*
+ * Fold the per-cpu allocator_free deltas into the volume header.
+ *
+ * The caller must hold fchain locked (which interlocks against
+ * allocations) and is expected to flush the volume header.
+ */
+void
+hammer2_freemap_sync(hammer2_mount_t *hmp)
+{
+	int64_t delta;
+	int i;
+
+	delta = 0;
+	for (i = 0; i < ncpus; ++i) {
+		delta += hmp->freemap_pcpu[i].free_delta;
+		hmp->freemap_pcpu[i].free_delta = 0;
+	}
+	if (delta) {
+		hammer2_voldata_lock(hmp);
+		hammer2_voldata_modify(hmp);
+		hmp->voldata.allocator_free += delta;
+		hammer2_voldata_unlock(hmp);
+	}
+}
+
+/*
+ * Return the current free space including deltas not yet folded into
+ * the volume header (used by statfs, the result is approximate).
+ */
+hammer2_off_t
+hammer2_freemap_free(hammer2_mount_t *hmp)
+{
+	int64_t delta;
+	int i;
+
+	delta = 0;
+	for (i = 0; i < ncpus; ++i)
+		delta += hmp->freemap_pcpu[i].free_delta;
+	return(hmp->voldata.allocator_free + delta);
+}
+
 static
 void
 hammer2_freemap_init(hammer2_trans_t *trans, hammer2_mount_t *hmp,
@@ -890,8 +1121,10 @@ again:
 				    (HAMMER2_FREEMAP_COUNT - 1)];
 	bitmap = &bmap->bitmap[(int)(data_off >> (HAMMER2_SEGRADIX - 3)) & 7];
 
-	if (modified)
+	if (modified) {
 		bmap->linear = 0;
+		bmap->freehint = 0;
+	}
 
 	while (count) {
 		KKASSERT(bmmask11);
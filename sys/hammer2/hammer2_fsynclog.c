@@ -0,0 +1,490 @@
+/*
+ * Copyright (c) 2011-2014 The DragonFly Project.  All rights reserved.
+ *
+ * This code is derived from software contributed to The DragonFly Project
+ * by Matthew Dillon <dillon@dragonflybsd.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of The DragonFly Project nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific, prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * fsync log
+ *
+ * A full flush has to COW every block from the modified inode up to the
+ * super-root and then write the volume header.  fsync() instead flushes
+ * only the inode's own subtree, which leaves UPDATE set on the inode
+ * chain so the parent's block table is fixed up by the next full flush,
+ * and then appends a record to a ring in the reserved area of zone 0.
+ * The record holds the inode's media data and the key of every inode on
+ * the path from the volume root down to it.
+ *
+ * Each volume header stores the sequence number of the next record
+ * (voldata.fsynclog_seq) as of its flush, every older record is covered
+ * by the header.  Since a volume header write is not known to have
+ * completed until the following one, records are only reused once two
+ * newer headers have been written (hmp->fsynclog_base).  When the ring
+ * is full, or the inode's key path may not be reachable from the media
+ * (it was created or moved since the last full flush, or a directory on
+ * the path was flushed on its own since), fsync falls back to a full
+ * filesystem sync.
+ *
+ * Records are written in seq order, an fsync does not return before
+ * every lower record is on the media.
+ *
+ * The log is only used on volumes with HAMMER2_VOLF_FSYNCLOG, older
+ * kernels do not maintain voldata.fsynclog_seq.
+ *
+ * After the recovery scan the mount code replays the records newer than
+ * the volume header in sequence order.  The logged inode's new blocks
+ * are marked allocated in the freemap, then the inode is looked up by
+ * its key path and its media data is replaced with the logged copy.
+ */
+#include <sys/param.h>
+#include <sys/systm.h>
+#include <sys/kernel.h>
+#include <sys/fcntl.h>
+#include <sys/buf.h>
+#include <sys/proc.h>
+#include <sys/mount.h>
+#include <sys/vnode.h>
+#include <sys/stdint.h>
+
+#include "hammer2.h"
+
+#define HAMMER2_FSYNCLOG_MARKDEPTH	16
+
+/*
+ * Media offset of the ring slot used by seq.
+ */
+#define H2FSLOG_OFF(seq)						\
+	((hammer2_off_t)HAMMER2_ZONE_FSYNCLOG * HAMMER2_PBUFSIZE64 +	\
+	 (hammer2_off_t)((seq) % HAMMER2_FSYNCLOG_COUNT) *		\
+	 HAMMER2_FSYNCLOG_BYTES)
+
+static int hammer2_fsynclog_path(hammer2_chain_t *chain,
+			hammer2_fsynclog_data_t *rec);
+static int hammer2_fsynclog_write(hammer2_mount_t *hmp,
+			hammer2_fsynclog_data_t *rec, int error);
+static void hammer2_fsynclog_apply(hammer2_trans_t *trans,
+			hammer2_mount_t *hmp, hammer2_fsynclog_data_t *rec);
+static void hammer2_fsynclog_mark(hammer2_trans_t *trans,
+			hammer2_mount_t *hmp, hammer2_blockref_t *base,
+			int count, hammer2_tid_t sync_tid, int depth);
+
+/*
+ * Make the inode durable through the fsync log.  Returns non-zero if the
+ * log could not be used and the caller must do a full sync instead.
+ */
+int
+hammer2_fsynclog_fsync(hammer2_inode_t *ip)
+{
+	hammer2_fsynclog_data_t *recs;
+	hammer2_mount_t *hmps[HAMMER2_MAXCLUSTER];
+	hammer2_trans_t trans;
+	hammer2_cluster_t *cluster;
+	hammer2_chain_t *chain;
+	int nchains;
+	int error;
+	int i;
+
+	recs = malloc(sizeof(*recs) * HAMMER2_MAXCLUSTER, M_HAMMER2,
+		      M_WAITOK | M_ZERO);
+
+	/*
+	 * The caller has pushed the vnode's dirty buffers through
+	 * strategy.  Get them into the chains first, the write workers
+	 * would block behind our flush transaction.
+	 */
+	hammer2_bioq_sync(ip->pmp);
+
+	/*
+	 * The flush transaction serializes us against other flushes,
+	 * which also serializes access to the hmp->fsynclog_* fields, and
+	 * holds off renames while we look at the key path.
+	 */
+	hammer2_trans_init(&trans, ip->pmp, HAMMER2_TRANS_ISFLUSH);
+	cluster = hammer2_inode_lock_ex(ip);
+	nchains = cluster->nchains;
+	error = 0;
+
+	/*
+	 * The log is only used if it can cover every element.
+	 */
+	for (i = 0; i < nchains; ++i) {
+		hmps[i] = NULL;
+		chain = cluster->array[i];
+		if (chain == NULL)
+			continue;
+		hmps[i] = chain->hmp;
+		if (hmps[i]->ronly || !HAMMER2_VOL_FSYNCLOG(hmps[i]) ||
+		    hmps[i]->fsynclog_next - hmps[i]->fsynclog_base >=
+		    HAMMER2_FSYNCLOG_COUNT ||
+		    hammer2_fsynclog_path(chain, &recs[i])) {
+			error = EAGAIN;
+			break;
+		}
+	}
+
+	/*
+	 * Flush the inode's subtree.  An inode which ends up without
+	 * UPDATE set is already in its parent's block table.
+	 */
+	for (i = 0; error == 0 && i < nchains; ++i) {
+		chain = cluster->array[i];
+		if (chain == NULL)
+			continue;
+		hammer2_flush(&trans, chain);
+		if ((chain->flags & HAMMER2_CHAIN_UPDATE) == 0)
+			continue;
+		recs[i].magic = HAMMER2_FSYNCLOG_MAGIC;
+		recs[i].seq = hmps[i]->fsynclog_next++;
+		recs[i].fsid = hmps[i]->voldata.fsid;
+		recs[i].ipdata = chain->data->ipdata;
+	}
+	hammer2_inode_unlock_ex(ip, cluster);
+	hammer2_trans_done(&trans);
+
+	/*
+	 * Every allocated seq must be retired, even after an error.
+	 */
+	for (i = 0; i < nchains; ++i) {
+		if (recs[i].magic == HAMMER2_FSYNCLOG_MAGIC)
+			error = hammer2_fsynclog_write(hmps[i], &recs[i], error);
+	}
+	free(recs, M_HAMMER2, sizeof(*recs) * HAMMER2_MAXCLUSTER);
+
+	if (error)
+		++hammer2_fsynclog_fallbacks;
+	return (error);
+}
+
+/*
+ * Record the keys of the inodes between the volume root and chain.  Fails
+ * if the path could not be resolved from the media after a crash: a
+ * chain on the path is not in its parent's block table yet, or an
+ * ancestor has UPDATE set.  BMAPPED only says the chain is in the
+ * parent's in-memory block table, which a subtree flush (fsync of a
+ * directory, the background flusher) also sets up.  The parent's new
+ * blocks are not referenced from the media until its own parent is
+ * updated.
+ */
+static
+int
+hammer2_fsynclog_path(hammer2_chain_t *chain, hammer2_fsynclog_data_t *rec)
+{
+	hammer2_chain_t *scan;
+	hammer2_key_t keys[HAMMER2_FSYNCLOG_MAXDEPTH];
+	int depth;
+	int i;
+
+	depth = 0;
+	for (scan = chain; scan != &chain->hmp->vchain; scan = scan->parent) {
+		if (scan == NULL)
+			return (EAGAIN);
+		if ((scan->flags & HAMMER2_CHAIN_BMAPPED) == 0 ||
+		    (scan->flags & HAMMER2_CHAIN_DELETED)) {
+			return (EAGAIN);
+		}
+		if (scan != chain && (scan->flags & HAMMER2_CHAIN_UPDATE))
+			return (EAGAIN);
+		if (scan->bref.type != HAMMER2_BREF_TYPE_INODE)
+			continue;
+		if (depth == HAMMER2_FSYNCLOG_MAXDEPTH)
+			return (EAGAIN);
+		keys[depth++] = scan->bref.key;
+	}
+	rec->depth = depth;
+	for (i = 0; i < depth; ++i)
+		rec->path[i] = keys[depth - i - 1];
+	return (0);
+}
+
+/*
+ * Write a record to its ring slot.  The record must not reach the media
+ * ahead of the blocks it references, so the device is synced first.
+ *
+ * Records are written strictly in seq order, we wait for every lower seq
+ * to be written (or given up) first.  If error is already set the
+ * record is not written, its seq is just retired.
+ *
+ * Only the slot itself is written so a torn write cannot damage older
+ * records sharing the physical block.  Log buffers are never cached,
+ * the replay code reads the ring with larger buffers.
+ */
+static
+int
+hammer2_fsynclog_write(hammer2_mount_t *hmp, hammer2_fsynclog_data_t *rec,
+		       int error)
+{
+	struct buf *bp;
+	hammer2_off_t off;
+
+	mtx_enter(&hmp->fsynclog_mtx);
+	while (hmp->fsynclog_done != rec->seq) {
+		msleep(&hmp->fsynclog_done, &hmp->fsynclog_mtx, PRIBIO,
+		       "h2fslw", 0);
+	}
+	mtx_leave(&hmp->fsynclog_mtx);
+
+	if (error == 0) {
+		vn_lock(hmp->devvp, LK_EXCLUSIVE | LK_RETRY, NULL);
+		error = VOP_FSYNC(hmp->devvp, FSCRED, MNT_WAIT, curproc);
+		VOP_UNLOCK(hmp->devvp, 0, NULL);
+	}
+	if (error == 0) {
+		rec->icrc = 0;
+		rec->icrc = hammer2_icrc32(rec, sizeof(*rec));
+
+		off = H2FSLOG_OFF(rec->seq);
+		bp = getblk(hmp->devvp, off, HAMMER2_FSYNCLOG_BYTES, 0, 0);
+		bzero(bp->b_data, HAMMER2_FSYNCLOG_BYTES);
+		bcopy(rec, bp->b_data, sizeof(*rec));
+		bp->b_flags |= B_NOCACHE;
+		error = bwrite(bp);
+		if (error == 0)
+			++hammer2_fsynclog_records;
+	}
+
+	mtx_enter(&hmp->fsynclog_mtx);
+	hmp->fsynclog_done = rec->seq + 1;
+	wakeup(&hmp->fsynclog_done);
+	mtx_leave(&hmp->fsynclog_mtx);
+
+	return (error);
+}
+
+/*
+ * Replay the records not covered by the volume header.  Called on RW
+ * mounts after the recovery scan.  The replayed chains are flushed, the
+ * volume header itself is written by the next sync and until then the
+ * records remain valid.
+ */
+int
+hammer2_fsynclog_replay(hammer2_mount_t *hmp)
+{
+	hammer2_fsynclog_data_t *rec;
+	hammer2_trans_t trans;
+	struct buf *bp;
+	hammer2_off_t off;
+	hammer2_off_t pbase;
+	hammer2_off_t bpbase;
+	hammer2_crc32_t icrc;
+	hammer2_tid_t seq;
+	int count;
+	int error;
+
+	if (!HAMMER2_VOL_FSYNCLOG(hmp))
+		return (0);
+
+	rec = malloc(sizeof(*rec), M_HAMMER2, M_WAITOK);
+	hammer2_trans_init(&trans, hmp->spmp, HAMMER2_TRANS_ISFLUSH);
+
+	bp = NULL;
+	bpbase = (hammer2_off_t)-1;
+	count = 0;
+	error = 0;
+
+	for (seq = hmp->fsynclog_hdr;
+	     seq < hmp->fsynclog_hdr + HAMMER2_FSYNCLOG_COUNT;
+	     ++seq) {
+		off = H2FSLOG_OFF(seq);
+		pbase = off & ~HAMMER2_PBUFMASK64;
+		if (pbase != bpbase) {
+			if (bp) {
+				bp->b_flags |= B_NOCACHE;
+				brelse(bp);
+			}
+			bpbase = pbase;
+			error = bread(hmp->devvp, pbase, HAMMER2_PBUFSIZE, &bp);
+			if (error) {
+				bp->b_flags |= B_NOCACHE;
+				brelse(bp);
+				bp = NULL;
+				break;
+			}
+		}
+		bcopy(bp->b_data + (off - pbase), rec, sizeof(*rec));
+
+		/*
+		 * Slots which were not rewritten since the last lap hold
+		 * older sequence numbers.  Gaps are possible when an fsync
+		 * did not get to write its record.
+		 */
+		if (rec->magic != HAMMER2_FSYNCLOG_MAGIC ||
+		    rec->seq != seq ||
+		    bcmp(&rec->fsid, &hmp->voldata.fsid, sizeof(rec->fsid)) ||
+		    rec->depth == 0 ||
+		    rec->depth > HAMMER2_FSYNCLOG_MAXDEPTH) {
+			continue;
+		}
+		icrc = rec->icrc;
+		rec->icrc = 0;
+		if (hammer2_icrc32(rec, sizeof(*rec)) != icrc) {
+			printf("hammer2: fsync log seq %08x: bad icrc\n",
+				(unsigned int)seq);
+			continue;
+		}
+		hammer2_fsynclog_apply(&trans, hmp, rec);
+		hmp->fsynclog_next = seq + 1;
+		++count;
+	}
+	if (bp) {
+		bp->b_flags |= B_NOCACHE;
+		brelse(bp);
+	}
+
+	/*
+	 * Flush now, the replayed chains have no PFS assignments.
+	 */
+	if (count) {
+		printf("hammer2: replayed %d fsync log records\n", count);
+		hammer2_chain_lock(&hmp->vchain, HAMMER2_RESOLVE_ALWAYS);
+		hammer2_flush(&trans, &hmp->vchain);
+		hammer2_chain_unlock(&hmp->vchain);
+	}
+	hammer2_trans_done(&trans);
+	free(rec, M_HAMMER2, sizeof(*rec));
+	hmp->fsynclog_done = hmp->fsynclog_next;
+
+	return (error);
+}
+
+static
+void
+hammer2_fsynclog_apply(hammer2_trans_t *trans, hammer2_mount_t *hmp,
+		       hammer2_fsynclog_data_t *rec)
+{
+	hammer2_chain_t *parent;
+	hammer2_chain_t *chain;
+	hammer2_key_t key_next;
+	hammer2_tid_t sync_tid;
+	int cache_index;
+	int ddflag;
+	int i;
+
+	chain = NULL;
+	sync_tid = 0;
+	cache_index = 0;
+	parent = hammer2_chain_lookup_init(&hmp->vchain, 0);
+
+	for (i = 0; i < rec->depth; ++i) {
+		chain = hammer2_chain_lookup(&parent, &key_next,
+					     rec->path[i], rec->path[i],
+					     &cache_index, 0, &ddflag);
+		hammer2_chain_lookup_done(parent);
+		parent = chain;
+		if (chain == NULL)
+			break;
+		atomic_set_int(&chain->flags, HAMMER2_CHAIN_RELEASE);
+		if (chain->bref.type != HAMMER2_BREF_TYPE_INODE) {
+			chain = NULL;
+			break;
+		}
+
+		/*
+		 * Blocks below the PFS root's last flush are already
+		 * accounted for, see hammer2_recovery_scan().
+		 */
+		if (chain->data->ipdata.op_flags & HAMMER2_OPFLAG_PFSROOT)
+			sync_tid = chain->bref.mirror_tid - 1;
+	}
+
+	if (chain == NULL || chain->data->ipdata.inum != rec->ipdata.inum) {
+		printf("hammer2: fsync log seq %08x: inode %016x not found\n",
+			(unsigned int)rec->seq,
+			(unsigned int)rec->ipdata.inum);
+	} else {
+		/*
+		 * The logged blocks were allocated after the freemap was
+		 * last flushed, mark them before modify allocates.
+		 */
+		if ((rec->ipdata.op_flags & HAMMER2_OPFLAG_DIRECTDATA) == 0) {
+			hammer2_fsynclog_mark(trans, hmp,
+				      &rec->ipdata.u.blockset.blockref[0],
+				      HAMMER2_SET_COUNT, sync_tid, 0);
+		}
+		hammer2_chain_modify(trans, chain, 0);
+		chain->data->ipdata = rec->ipdata;
+	}
+	if (parent)
+		hammer2_chain_lookup_done(parent);
+}
+
+/*
+ * Mark the blocks under a logged inode allocated.
+ */
+static
+void
+hammer2_fsynclog_mark(hammer2_trans_t *trans, hammer2_mount_t *hmp,
+		      hammer2_blockref_t *base, int count,
+		      hammer2_tid_t sync_tid, int depth)
+{
+	hammer2_media_data_t *data;
+	hammer2_blockref_t *bref;
+	hammer2_io_t *dio;
+	int bytes;
+	int i;
+
+	for (i = 0; i < count; ++i) {
+		bref = &base[i];
+		if (bref->type == HAMMER2_BREF_TYPE_EMPTY)
+			continue;
+		if (bref->mirror_tid < sync_tid)
+			continue;
+		if ((bref->data_off & HAMMER2_OFF_MASK_RADIX) == 0)
+			continue;
+		hammer2_freemap_adjust(trans, hmp, bref,
+				       HAMMER2_FREEMAP_DORECOVER);
+
+		if (bref->type != HAMMER2_BREF_TYPE_INODE &&
+		    bref->type != HAMMER2_BREF_TYPE_INDIRECT) {
+			continue;
+		}
+		if (depth == HAMMER2_FSYNCLOG_MARKDEPTH) {
+			printf("hammer2: fsync log replay: %016x too deep\n",
+				(unsigned int)bref->data_off);
+			continue;
+		}
+		bytes = 1 << (int)(bref->data_off & HAMMER2_OFF_MASK_RADIX);
+		if (hammer2_io_bread(hmp, bref->data_off, bytes, &dio)) {
+			hammer2_io_bqrelse(&dio);
+			continue;
+		}
+		data = (void *)hammer2_io_data(dio, bref->data_off);
+		if (bref->type == HAMMER2_BREF_TYPE_INDIRECT) {
+			hammer2_fsynclog_mark(trans, hmp, &data->npdata[0],
+				      bytes / (int)sizeof(hammer2_blockref_t),
+				      sync_tid, depth + 1);
+		} else if ((data->ipdata.op_flags &
+			    HAMMER2_OPFLAG_DIRECTDATA) == 0) {
+			hammer2_fsynclog_mark(trans, hmp,
+				      &data->ipdata.u.blockset.blockref[0],
+				      HAMMER2_SET_COUNT, sync_tid, depth + 1);
+		}
+		hammer2_io_bqrelse(&dio);
+	}
+}
@@ -572,6 +572,7 @@ again:
 	nip->inum = nipdata->inum;
 	nip->size = nipdata->size;
 	nip->mtime = nipdata->mtime;
+	hammer2_inode_comp_seed(nip, nipdata);
 	hammer2_inode_repoint(nip, NULL, cluster);
 	nip->pip = dip;				/* can be NULL */
 	if (dip)
@@ -609,6 +610,25 @@ again:
 	return (nip);
 }
 
+/*
+ * Seed the per-range compression heuristics of an inode being brought
+ * into memory from the incompressible range bitmap saved in its meta-data.
+ * A remembered range starts out skipping compression as if it had just
+ * failed, and is retried periodically like any other failing range.
+ */
+void
+hammer2_inode_comp_seed(hammer2_inode_t *ip, const hammer2_inode_data_t *ipdata)
+{
+	int i;
+
+	for (i = 0; i < HAMMER2_COMP_HEUR_SLOTS; ++i) {
+		if (ipdata->comp_hint & (1 << i))
+			ip->comp_heuristic[i] = 9;
+		else
+			ip->comp_heuristic[i] = 0;
+	}
+}
+
 /*
  * Create a new inode in the specified directory using the vattr to
  * figure out the type of inode.
@@ -753,7 +773,8 @@ retry:
 	}
 	
 	/* Inherit parent's inode compression mode. */
-	nip->comp_heuristic = 0;
+	bzero(nip->comp_heuristic, sizeof(nip->comp_heuristic));
+	nipdata->comp_hint = 0;
 	nipdata->comp_algo = dip_comp_algo;
 	nipdata->check_algo = dip_check_algo;
 	nipdata->version = HAMMER2_INODE_VERSION_ONE;
@@ -41,27 +41,19 @@
  * using smaller allocations, without causing deadlocks.
  *
  */
-static void hammer2_io_callback(struct bio2 *bio);
-static int hammer2_io_cleanup_callback(hammer2_io_t *dio, void *arg);
+static void hammer2_io_callback(struct buf *bp);
+static void hammer2_io_iodone(hammer2_io_t *dio);
+static void hammer2_io_iodone_thread(void *arg);
+static void hammer2_io_reclaim(hammer2_mount_t *hmp, int count);
+static int hammer2_io_cluster_read(hammer2_mount_t *hmp, off_t pbase,
+			int psize, struct buf **bpp);
 
-static int
-hammer2_io_cmp(hammer2_io_t *io1, hammer2_io_t *io2)
-{
-	if (io2->pbase < io1->pbase)
-		return(-1);
-	if (io2->pbase > io1->pbase)
-		return(1);
-	return(0);
-}
-
-RB_PROTOTYPE2(hammer2_io_tree, hammer2_io, rbnode, hammer2_io_cmp, off_t);
-RB_GENERATE2(hammer2_io_tree, hammer2_io, rbnode, hammer2_io_cmp, off_t, pbase);
-
-struct hammer2_cleanupcb_info {
-	struct hammer2_io_tree tmptree;
-	int	count;
-};
+void bread_cluster_callback(struct buf *bp);
 
+/*
+ * Maximum number of idle dios reclaimed by any one putblk.
+ */
+#define HAMMER2_DIO_RECLAIM	32
 
 #define HAMMER2_DIO_INPROG	0x80000000
 #define HAMMER2_DIO_GOOD	0x40000000
@@ -76,6 +68,111 @@ vfs_bio_clrbuf(struct buf *bp)
         brelse(bp);
 }
 
+static __inline
+struct hammer2_io_hash *
+hammer2_io_hashbucket(hammer2_mount_t *hmp, off_t pbase)
+{
+	int hv;
+
+	hv = (int)(pbase >> HAMMER2_LBUFRADIX) ^
+	     (int)(pbase >> (HAMMER2_LBUFRADIX + 10));
+	return(&hmp->iohash[hv & HAMMER2_IOHASH_MASK]);
+}
+
+/*
+ * Locate a dio in a hash bucket.  The bucket must be locked.
+ */
+static
+hammer2_io_t *
+hammer2_io_hashlookup(struct hammer2_io_hash *hash, off_t pbase)
+{
+	hammer2_io_t *dio;
+
+	LIST_FOREACH(dio, &hash->list, hnext) {
+		if (dio->pbase == pbase)
+			break;
+	}
+	return(dio);
+}
+
+/*
+ * Verified check codes stay valid for as long as the device buffer stays
+ * in the buffer cache.  Called by the INPROG owner before the buffer is
+ * acquired, forgets them if the buffer has to be reloaded from media.
+ */
+static
+void
+hammer2_io_crc_reload(hammer2_io_t *dio)
+{
+	struct buf *bp;
+
+	bp = incore(dio->hmp->devvp, dio->pbase);
+	if (bp == NULL || !ISSET(bp->b_flags, B_DONE | B_DELWRI))
+		dio->crc_good_mask = 0;
+}
+
+/*
+ * Same, for a device buffer loaded by read-ahead behind the dio's back.
+ */
+static
+void
+hammer2_io_crc_forget(hammer2_mount_t *hmp, off_t pbase)
+{
+	struct hammer2_io_hash *hash;
+	hammer2_io_t *dio;
+
+	hash = hammer2_io_hashbucket(hmp, pbase);
+	mtx_enter(&hash->spin);
+	if ((dio = hammer2_io_hashlookup(hash, pbase)) != NULL)
+		atomic_clear_64(&dio->crc_good_mask, (uint64_t)-1);
+	mtx_leave(&hash->spin);
+}
+
+void
+hammer2_io_init(hammer2_mount_t *hmp)
+{
+	struct hammer2_io_hash *hash;
+	int i;
+
+	for (i = 0; i < HAMMER2_IOHASH_SIZE; ++i) {
+		hash = &hmp->iohash[i];
+		mtx_init(&hash->spin, IPL_BIO);
+		LIST_INIT(&hash->list);
+	}
+	mtx_init(&hmp->iofree_spin, IPL_BIO);
+	TAILQ_INIT(&hmp->iofreeq);
+
+	/*
+	 * Asynchronous reads are completed in interrupt context, their
+	 * callbacks are run from a thread.
+	 */
+	mtx_init(&hmp->iodone_mtx, IPL_BIO);
+	TAILQ_INIT(&hmp->iodoneq);
+	hmp->iodone_stop = 0;
+	if (kthread_create(hammer2_io_iodone_thread, hmp, &hmp->iodone_td,
+			   "h2iodone")) {
+		printf("hammer2: unable to start iodone thread\n");
+		hmp->iodone_td = NULL;
+	}
+}
+
+/*
+ * Stop the iodone thread.  The caller has already waited for all device
+ * I/O to finish, which includes running the queued callbacks.
+ */
+void
+hammer2_io_uninit(hammer2_mount_t *hmp)
+{
+	mtx_enter(&hmp->iodone_mtx);
+	hmp->iodone_stop = 1;
+	wakeup(&hmp->iodoneq);
+	while (hmp->iodone_td) {
+		msleep(&hmp->iodone_stop, &hmp->iodone_mtx, PRIBIO,
+		       "h2iost", 0);
+	}
+	mtx_leave(&hmp->iodone_mtx);
+}
+
 /*
  * Acquire the requested dio, set *ownerp based on state.  If state is good
  * *ownerp is set to 0, otherwise *ownerp is set to DIO_INPROG and the
@@ -84,6 +181,7 @@ vfs_bio_clrbuf(struct buf *bp)
 hammer2_io_t *
 hammer2_io_getblk(hammer2_mount_t *hmp, off_t lbase, int lsize, int *ownerp)
 {
+	struct hammer2_io_hash *hash;
 	hammer2_io_t *dio;
 	hammer2_io_t *xio;
 	off_t pbase;
@@ -99,29 +197,36 @@ hammer2_io_getblk(hammer2_mount_t *hmp, off_t lbase, int lsize, int *ownerp)
 	KKASSERT(pbase != 0 && ((lbase + lsize - 1) & pmask) == pbase);
 
 	/*
-	 * Access/Allocate the DIO
+	 * Access/Allocate the DIO.  The 0->1 ref transition must occur
+	 * with the bucket locked.
 	 */
-	__mp_lock((struct __mp_lock *)&hmp->io_spin);
-	dio = RB_LOOKUP(hammer2_io_tree, &hmp->iotree, pbase);
+	hash = hammer2_io_hashbucket(hmp, pbase);
+	mtx_enter(&hash->spin);
+	dio = hammer2_io_hashlookup(hash, pbase);
 	if (dio) {
 		if ((atomic_fetchadd_int(&dio->refs, 1) &
 		     HAMMER2_DIO_MASK) == 0) {
 			atomic_add_int(&dio->hmp->iofree_count, -1);
 		}
+		mtx_leave(&hash->spin);
 	} else {
+		mtx_leave(&hash->spin);
 		dio = malloc(sizeof(*dio), M_HAMMER2, M_INTWAIT | M_ZERO);
 		dio->hmp = hmp;
 		dio->pbase = pbase;
 		dio->psize = psize;
 		dio->refs = 1;
-		__mp_lock((struct __mp_lock *)&hmp->io_spin);
-		xio = RB_INSERT(hammer2_io_tree, &hmp->iotree, dio);
+		mtx_enter(&hash->spin);
+		xio = hammer2_io_hashlookup(hash, pbase);
 		if (xio == NULL) {
+			LIST_INSERT_HEAD(&hash->list, dio, hnext);
+			mtx_leave(&hash->spin);
 		} else {
 			if ((atomic_fetchadd_int(&xio->refs, 1) &
 			     HAMMER2_DIO_MASK) == 0) {
 				atomic_add_int(&xio->hmp->iofree_count, -1);
 			}
+			mtx_leave(&hash->spin);
 			free(dio, M_HAMMER2, 0);
 			dio = xio;
 		}
@@ -212,16 +317,11 @@ hammer2_io_putblk(hammer2_io_t **diop)
 	hammer2_mount_t *hmp;
 	hammer2_io_t *dio;
 	struct buf *bp;
-	off_t peof;
-	off_t pbase;
-	int psize;
 	int refs;
 
 	dio = *diop;
 	*diop = NULL;
 
-	hammer2_io_cleanup_callback(dio, NULL);
-
 	for (;;) {
 		refs = dio->refs;
 
@@ -251,27 +351,33 @@ hammer2_io_putblk(hammer2_io_t **diop)
 	 * The instant we call io_complete dio is a free agent again and
 	 * can be ripped out from under us.  Acquisition of the dio after
 	 * this point will require a shared or exclusive spinlock.
+	 *
+	 * Place the dio on the CLOCK list while we still hold INPROG so
+	 * the reclaim code cannot free it out from under us.
 	 */
 	hmp = dio->hmp;
 	bp = dio->bp;
 	dio->bp = NULL;
-	pbase = dio->pbase;
-	psize = dio->psize;
 	atomic_add_int(&hmp->iofree_count, 1);
+	mtx_enter(&hmp->iofree_spin);
+	if (dio->onfreeq == 0) {
+		dio->onfreeq = 1;
+		TAILQ_INSERT_TAIL(&hmp->iofreeq, dio, fnext);
+		++hmp->iofreeq_count;
+	}
+	mtx_leave(&hmp->iofree_spin);
 	hammer2_io_complete(dio, HAMMER2_DIO_INPROG);	/* clears INPROG */
 	dio = NULL;	/* dio stale */
 
 	if (refs & HAMMER2_DIO_GOOD) {
 		KKASSERT(bp != NULL);
 		if (refs & HAMMER2_DIO_DIRTY) {
-			if (hammer2_cluster_enable) {
-				peof = (pbase + HAMMER2_SEGMASK64) &
-				       ~HAMMER2_SEGMASK64;
-				cluster_write(bp, (struct cluster_info *)peof, psize);
-			} else {
-				bp->b_flags |= B_CLUSTEROK;
-				bdwrite(bp);
-			}
+			/*
+			 * cluster_write() needs a file system vnode with
+			 * VOP_BMAP() support and cannot be used on devvp.
+			 */
+			bp->b_flags |= B_CLUSTEROK;
+			bdwrite(bp);
 		} else if (bp->b_flags & (B_ERROR | B_INVAL | B_RELBUF)) {
 			brelse(bp);
 		} else {
@@ -280,57 +386,94 @@ hammer2_io_putblk(hammer2_io_t **diop)
 	}
 
 	/*
-	 * We cache free buffers so re-use cases can use a shared lock, but
-	 * if too many build up we have to clean them out.
+	 * We cache free dios so re-use cases can avoid reallocation, but
+	 * if too many build up we reclaim a few at a time from the CLOCK
+	 * list.
 	 */
-	if (hmp->iofree_count > 1000) {
-		struct hammer2_cleanupcb_info info;
-
-		RB_INIT(&info.tmptree);
-		__mp_lock((struct __mp_lock *)&hmp->io_spin);
-		if (hmp->iofree_count > 1000) {
-			info.count = hmp->iofree_count / 2;
-			RB_SCAN(hammer2_io_tree, &hmp->iotree, NULL,
-				hammer2_io_cleanup_callback, &info);
-		}
-		hammer2_io_cleanup(hmp, &info.tmptree);
+	if (hmp->iofree_count > hammer2_dio_limit) {
+		int count;
+
+		count = hmp->iofree_count - hammer2_dio_limit;
+		if (count > HAMMER2_DIO_RECLAIM)
+			count = HAMMER2_DIO_RECLAIM;
+		hammer2_io_reclaim(hmp, count);
 	}
 }
 
 /*
- * Cleanup any dio's with no references which are not in-progress.
+ * Advance the CLOCK hand over hmp->iofreeq, freeing up to count idle
+ * dios.
+ *
+ * Dios which have been re-referenced are simply dropped from the list,
+ * the next 1->0 transition will put them back at the tail.  Dios with
+ * recent activity, or which are still INPROG from the 1->0 transition
+ * that queued them, are given another pass.  The scan is bounded so a
+ * list full of active dios cannot stall the caller.
  */
-
 static
-int
-hammer2_io_cleanup_callback(hammer2_io_t *dio, void *arg)
+void
+hammer2_io_reclaim(hammer2_mount_t *hmp, int count)
 {
-	struct hammer2_cleanupcb_info *info = arg;
-	hammer2_io_t *xio;
+	struct hammer2_io_list tmplist;
+	struct hammer2_io_hash *hash;
+	hammer2_io_t *dio;
+	int scan;
+
+	LIST_INIT(&tmplist);
+	scan = count * 4;
+
+	mtx_enter(&hmp->iofree_spin);
+	while (count > 0 && scan-- > 0 &&
+	       (dio = TAILQ_FIRST(&hmp->iofreeq)) != NULL) {
+		TAILQ_REMOVE(&hmp->iofreeq, dio, fnext);
+		if (dio->refs & HAMMER2_DIO_MASK) {
+			dio->onfreeq = 0;
+			--hmp->iofreeq_count;
+			continue;
+		}
+		if (dio->act > 0 || (dio->refs & HAMMER2_DIO_INPROG)) {
+			if (dio->act > 0)
+				--dio->act;
+			TAILQ_INSERT_TAIL(&hmp->iofreeq, dio, fnext);
+			continue;
+		}
 
-	if ((dio->refs & (HAMMER2_DIO_MASK | HAMMER2_DIO_INPROG)) == 0) {
-		if (dio->act > 0) {
-			--dio->act;
-			return 0;
+		/*
+		 * Interlock against getblk's 0->1 transition.
+		 */
+		hash = hammer2_io_hashbucket(hmp, dio->pbase);
+		mtx_enter(&hash->spin);
+		if ((dio->refs & (HAMMER2_DIO_MASK |
+				  HAMMER2_DIO_INPROG)) == 0) {
+			KKASSERT(dio->bp == NULL);
+			dio->onfreeq = 0;
+			--hmp->iofreeq_count;
+			LIST_REMOVE(dio, hnext);
+			LIST_INSERT_HEAD(&tmplist, dio, hnext);
+			--count;
+		} else if (dio->refs & HAMMER2_DIO_MASK) {
+			dio->onfreeq = 0;
+			--hmp->iofreeq_count;
+		} else {
+			TAILQ_INSERT_TAIL(&hmp->iofreeq, dio, fnext);
 		}
-		KKASSERT(dio->bp == NULL);
-		RB_REMOVE(hammer2_io_tree, &dio->hmp->iotree, dio);
-		xio = (hammer2_io_t *)RB_INSERT(hammer2_io_tree, &info->tmptree, dio);
-		KKASSERT(xio == NULL);
-		if (--info->count <= 0)	// limit scan 
-			return(-1);
+		mtx_leave(&hash->spin);
 	}
-	return 0;
-}
+	mtx_leave(&hmp->iofree_spin);
 
+	hammer2_io_cleanup(hmp, &tmplist);
+}
 
+/*
+ * Free the dio's on a list previously removed from the hash.
+ */
 void
-hammer2_io_cleanup(hammer2_mount_t *hmp, struct hammer2_io_tree *tree)
+hammer2_io_cleanup(hammer2_mount_t *hmp, struct hammer2_io_list *list)
 {
 	hammer2_io_t *dio;
 
-	while ((dio = RB_ROOT(tree)) != NULL) {
-		RB_REMOVE(hammer2_io_tree, tree, dio);
+	while ((dio = LIST_FIRST(list)) != NULL) {
+		LIST_REMOVE(dio, hnext);
 		KKASSERT(dio->bp == NULL &&
 		    (dio->refs & (HAMMER2_DIO_MASK | HAMMER2_DIO_INPROG)) == 0);
 		free(dio, M_HAMMER2, 0);
@@ -338,6 +481,43 @@ hammer2_io_cleanup(hammer2_mount_t *hmp, struct hammer2_io_tree *tree)
 	}
 }
 
+/*
+ * Free all cached dio's, used on unmount.  Any dio's still referenced
+ * are left in place and reported by the caller via iofree_count.
+ */
+void
+hammer2_io_cleanup_all(hammer2_mount_t *hmp)
+{
+	struct hammer2_io_list tmplist;
+	int i;
+
+	LIST_INIT(&tmplist);
+	mtx_enter(&hmp->iofree_spin);
+	for (i = 0; i < HAMMER2_IOHASH_SIZE; ++i) {
+		struct hammer2_io_hash *hash = &hmp->iohash[i];
+		hammer2_io_t *dio;
+		hammer2_io_t *xio;
+
+		mtx_enter(&hash->spin);
+		LIST_FOREACH_SAFE(dio, &hash->list, hnext, xio) {
+			if (dio->refs & (HAMMER2_DIO_MASK |
+					 HAMMER2_DIO_INPROG)) {
+				continue;
+			}
+			if (dio->onfreeq) {
+				TAILQ_REMOVE(&hmp->iofreeq, dio, fnext);
+				dio->onfreeq = 0;
+				--hmp->iofreeq_count;
+			}
+			LIST_REMOVE(dio, hnext);
+			LIST_INSERT_HEAD(&tmplist, dio, hnext);
+		}
+		mtx_leave(&hash->spin);
+	}
+	mtx_leave(&hmp->iofree_spin);
+	hammer2_io_cleanup(hmp, &tmplist);
+}
+
 char *
 hammer2_io_data(hammer2_io_t *dio, off_t lbase)
 {
@@ -380,6 +560,7 @@ _hammer2_io_new(hammer2_mount_t *hmp, off_t lbase, int lsize,
 			/* do nothing */
 			error = 0;
 		} else {
+			hammer2_io_crc_reload(dio);
 			error = bread(hmp->devvp, dio->pbase,
 				      dio->psize, &dio->bp);
 		}
@@ -392,6 +573,7 @@ _hammer2_io_new(hammer2_mount_t *hmp, off_t lbase, int lsize,
 		error = 0;
 	}
 	if (dio->bp) {
+		hammer2_io_crc_clrmask(dio, hammer2_io_mask(dio, lbase, lsize));
 		if (dozero)
 			bzero(hammer2_io_data(dio, lbase), lsize);
 		atomic_set_int(&dio->refs, HAMMER2_DIO_DIRTY);
@@ -425,19 +607,15 @@ hammer2_io_bread(hammer2_mount_t *hmp, off_t lbase, int lsize,
 		hammer2_io_t **diop)
 {
 	hammer2_io_t *dio;
-	off_t peof;
 	int owner;
 	int error;
 
 	dio = *diop = hammer2_io_getblk(hmp, lbase, lsize, &owner);
 	if (owner) {
+		hammer2_io_crc_reload(dio);
 		if (hammer2_cluster_enable) {
-			peof = (dio->pbase + HAMMER2_SEGMASK64) &
-			       ~HAMMER2_SEGMASK64;
-			error = cluster_read(hmp->devvp, peof, dio->pbase,
-					     dio->psize,
-					     dio->psize, HAMMER2_PBUFSIZE*4,
-					     &dio->bp);
+			error = hammer2_io_cluster_read(hmp, dio->pbase,
+							dio->psize, &dio->bp);
 		} else {
 			error = bread(hmp->devvp, dio->pbase,
 				      dio->psize, &dio->bp);
@@ -453,6 +631,109 @@ hammer2_io_bread(hammer2_mount_t *hmp, off_t lbase, int lsize,
 	return error;
 }
 
+/*
+ * Read the device buffer at pbase.  If it has to come from the media and
+ * the miss is sequential (it starts where the previous miss, including
+ * its prefetch, ended), also start one asynchronous read covering the
+ * following uncached device buffers of the same size within the same 2MB
+ * segment, up to MAXPHYS.  Inodes and small indirect blocks of a radix
+ * class are packed into the same segments by the freemap, so a directory
+ * scan turns into a few large reads instead of one read per device
+ * buffer, while random lookups do not pay for reads they never use.
+ * The sequential state is updated without interlock, races only affect
+ * the heuristic.
+ *
+ * The clustered read is built the same way as bread_cluster(): the first
+ * buffer carries the pages for the whole transfer and
+ * bread_cluster_callback() splits the completion back to the individual
+ * buffers.  bread_cluster() itself cannot be used because it relies on
+ * VOP_BMAP() and on consecutive block numbers.
+ */
+static
+int
+hammer2_io_cluster_read(hammer2_mount_t *hmp, off_t pbase, int psize,
+			struct buf **bpp)
+{
+	struct vnode *devvp = hmp->devvp;
+	struct buf **xbpp;
+	struct buf *bp;
+	off_t peof;
+	off_t off;
+	int sequential;
+	int howmany;
+	int i;
+
+	bp = *bpp = getblk(devvp, pbase, psize, 0, 0);
+	if (ISSET(bp->b_flags, B_DONE | B_DELWRI))
+		return (0);
+	SET(bp->b_flags, B_READ);
+	bcstats.pendingreads++;
+	bcstats.numreads++;
+	VOP_STRATEGY(bp);
+
+	sequential = (pbase == hmp->iocluster_next);
+	hmp->iocluster_next = pbase + psize;
+	if (!sequential)
+		goto done;
+
+	/*
+	 * Count the adjacent buffers we can pick up.  Stop at the end of
+	 * the segment and at the first buffer which is already cached.
+	 */
+	peof = (pbase | HAMMER2_SEGMASK64) + 1;
+	howmany = 0;
+	for (;;) {
+		off = pbase + (off_t)(howmany + 1) * psize;
+		if ((howmany + 1) * psize > MAXPHYS || off + psize > peof)
+			break;
+		if (incore(devvp, off))
+			break;
+		++howmany;
+	}
+	if (howmany == 0)
+		goto done;
+
+	xbpp = mallocarray(howmany + 1, sizeof(*xbpp), M_TEMP, M_NOWAIT);
+	if (xbpp == NULL)
+		goto done;
+	for (i = howmany - 1; i >= 0; --i) {
+		xbpp[i] = buf_get(devvp, pbase + (off_t)(i + 1) * psize,
+				  (i == 0) ? howmany * psize : 0);
+		if (xbpp[i] == NULL) {
+			for (++i; i < howmany; ++i) {
+				SET(xbpp[i]->b_flags, B_INVAL);
+				brelse(xbpp[i]);
+			}
+			free(xbpp, M_TEMP, 0);
+			goto done;
+		}
+	}
+	xbpp[howmany] = NULL;
+
+	for (i = 0; i < howmany; ++i)
+		hammer2_io_crc_forget(hmp, pbase + (off_t)(i + 1) * psize);
+	for (i = 1; i < howmany; ++i) {
+		bcstats.pendingreads++;
+		bcstats.numreads++;
+		SET(xbpp[i]->b_flags, B_READ | B_ASYNC);
+		xbpp[i]->b_blkno = pbase + (off_t)(i + 1) * psize;
+		xbpp[i]->b_bufsize = xbpp[i]->b_bcount = psize;
+		xbpp[i]->b_data = NULL;
+		xbpp[i]->b_pobj = xbpp[0]->b_pobj;
+		xbpp[i]->b_poffs = xbpp[0]->b_poffs + i * psize;
+	}
+	xbpp[0]->b_blkno = pbase + psize;
+	SET(xbpp[0]->b_flags, B_READ | B_ASYNC | B_CALL);
+	xbpp[0]->b_saveaddr = (void *)xbpp;
+	xbpp[0]->b_iodone = bread_cluster_callback;
+	bcstats.pendingreads++;
+	bcstats.numreads++;
+	VOP_STRATEGY(xbpp[0]);
+	hmp->iocluster_next = pbase + (off_t)(howmany + 1) * psize;
+done:
+	return (biowait(bp));
+}
+
 void
 hammer2_io_breadcb(hammer2_mount_t *hmp, off_t lbase, int lsize,
 		  void (*callback)(hammer2_io_t *dio,
@@ -463,8 +744,8 @@ hammer2_io_breadcb(hammer2_mount_t *hmp, off_t lbase, int lsize,
 		  void *arg_p, off_t arg_o)
 {
 	hammer2_io_t *dio;
+	struct buf *bp;
 	int owner;
-	int error;
 
 	dio = hammer2_io_getblk(hmp, lbase, lsize, &owner);
 	if (owner) {
@@ -473,38 +754,136 @@ hammer2_io_breadcb(hammer2_mount_t *hmp, off_t lbase, int lsize,
 		dio->arg_c = arg_c;
 		dio->arg_p = arg_p;
 		dio->arg_o = arg_o;
-		bread(hmp->devvp, dio->pbase, dio->psize,
-			(struct buf **)hammer2_io_callback); // , dio);
+
+		/*
+		 * Issue the read asynchronously unless the buffer cache
+		 * already has the data.  B_CALL leaves the (busy) buffer
+		 * to us in hammer2_io_callback().  Without an iodone
+		 * thread the read is issued synchronously.
+		 */
+		bp = getblk(hmp->devvp, dio->pbase, dio->psize, 0, 0);
+		if (ISSET(bp->b_flags, B_DONE | B_DELWRI)) {
+			dio->bp = bp;
+			hammer2_io_complete(dio, owner);
+			callback(dio, arg_l, arg_c, arg_p, arg_o);
+			hammer2_io_bqrelse(&dio);
+			return;
+		}
+		dio->crc_good_mask = 0;
+		SET(bp->b_flags, B_READ);
+		bcstats.pendingreads++;
+		bcstats.numreads++;
+		if (hmp->iodone_td == NULL) {
+			VOP_STRATEGY(bp);
+			dio->error = biowait(bp);
+			dio->bp = bp;
+			hammer2_io_iodone(dio);
+		} else {
+			bp->b_bio_array[0].bio_buf = bp;
+			bp->b_bio_array[0].bio_caller_info1.ptr = dio;
+			bp->b_iodone = hammer2_io_callback;
+			SET(bp->b_flags, B_ASYNC | B_CALL);
+			VOP_STRATEGY(bp);
+		}
 	} else {
-		error = 0;
 		callback(dio, arg_l, arg_c, arg_p, arg_o);
 		hammer2_io_bqrelse(&dio);
 	}
 }
 
+/*
+ * biodone() completion of an asynchronous read, called in interrupt
+ * context.  Just hand the dio to the iodone thread.
+ */
 static void
-hammer2_io_callback(struct bio2 *bio)
+hammer2_io_callback(struct buf *bp)
 {
-	struct buf *dbp = bio->bio_buf;
-	hammer2_io_t *dio = bio->bio_caller_info1.ptr;
+	hammer2_io_t *dio = bp->b_bio_array[0].bio_caller_info1.ptr;
+	hammer2_mount_t *hmp = dio->hmp;
 
-	if ((bio->bio_flags & BIO_DONE) == 0)
-		biodone(dbp);
-	bio->bio_flags &= ~(BIO_DONE | BIO_SYNC);
-	dio->bp = bio->bio_buf;
-	
-	//KKASSERT((dio->bp->b_flags & B_ERROR) == 0); /* XXX */
-	hammer2_io_complete(dio, HAMMER2_DIO_INPROG);
+	CLR(bp->b_flags, B_ASYNC);
+	dio->bp = bp;
+	if (ISSET(bp->b_flags, B_ERROR))
+		dio->error = bp->b_error ? bp->b_error : EIO;
+	else
+		dio->error = 0;
 
-	/*
-	 * We still have the ref and DIO_GOOD is now set so nothing else
-	 * should mess with the callback fields until we release the dio.
-	 */
-	dio->callback(dio, dio->arg_l, dio->arg_c, dio->arg_p, dio->arg_o);
+	mtx_enter(&hmp->iodone_mtx);
+	TAILQ_INSERT_TAIL(&hmp->iodoneq, dio, dnext);
+	wakeup_one(&hmp->iodoneq);
+	mtx_leave(&hmp->iodone_mtx);
+}
+
+/*
+ * Finish an asynchronous read issued by hammer2_io_breadcb() and run its
+ * callback.  We hold INPROG and a ref.
+ *
+ * On success the dio is set GOOD before the callback is run.  On failure
+ * the buffer is thrown away and the callback is run with dio->error set
+ * and dio->bp NULL, while we still hold INPROG so nobody else can reuse
+ * the dio.  The dio is then left not GOOD and the next access retries
+ * the read.
+ */
+static void
+hammer2_io_iodone(hammer2_io_t *dio)
+{
+	struct buf *bp;
+
+	if (dio->error) {
+		bp = dio->bp;
+		dio->bp = NULL;
+		SET(bp->b_flags, B_INVAL);
+		brelse(bp);
+		dio->callback(dio, dio->arg_l, dio->arg_c,
+			      dio->arg_p, dio->arg_o);
+		dio->error = 0;
+		hammer2_io_complete(dio, HAMMER2_DIO_INPROG);
+	} else {
+		/*
+		 * We still have the ref and DIO_GOOD is now set so nothing
+		 * else should mess with the callback fields until we
+		 * release the dio.
+		 */
+		hammer2_io_complete(dio, HAMMER2_DIO_INPROG);
+		dio->callback(dio, dio->arg_l, dio->arg_c,
+			      dio->arg_p, dio->arg_o);
+	}
 	hammer2_io_bqrelse(&dio);
 	/* TODO: async load meta-data and assign chain->dio */
 }
 
+/*
+ * Runs the callbacks of completed asynchronous reads in thread context,
+ * they decompress data, allocate memory and take locks.
+ */
+static void
+hammer2_io_iodone_thread(void *arg)
+{
+	hammer2_mount_t *hmp = arg;
+	hammer2_io_t *dio;
+
+	mtx_enter(&hmp->iodone_mtx);
+	for (;;) {
+		if ((dio = TAILQ_FIRST(&hmp->iodoneq)) == NULL) {
+			if (hmp->iodone_stop)
+				break;
+			msleep(&hmp->iodoneq, &hmp->iodone_mtx, PRIBIO,
+			       "h2iodn", 0);
+			continue;
+		}
+		TAILQ_REMOVE(&hmp->iodoneq, dio, dnext);
+		mtx_leave(&hmp->iodone_mtx);
+
+		hammer2_io_iodone(dio);
+
+		mtx_enter(&hmp->iodone_mtx);
+	}
+	hmp->iodone_td = NULL;
+	wakeup(&hmp->iodone_stop);
+	mtx_leave(&hmp->iodone_mtx);
+	kthread_exit(0);
+}
+
 void
 hammer2_io_bawrite(hammer2_io_t **diop)
 {
@@ -540,6 +919,27 @@ hammer2_io_setinval(hammer2_io_t *dio, u_int bytes)
 		dio->bp->b_flags |= B_INVAL | B_RELBUF;
 }
 
+/*
+ * Throw away any cached device buffers within the physical range, which
+ * must be aligned to the largest device buffer size.  Used before data
+ * is written to the media without going through a dio.  Buffers can
+ * still be cached (and even dirty) from before the storage was freed.
+ */
+void
+hammer2_io_inval(hammer2_mount_t *hmp, hammer2_off_t pbase, int bytes)
+{
+	hammer2_off_t off;
+	struct buf *bp;
+
+	for (off = pbase; off < pbase + bytes; off += HAMMER2_LBUFSIZE) {
+		if ((bp = incore(hmp->devvp, off)) == NULL)
+			continue;
+		bp = getblk(hmp->devvp, off, bp->b_bcount, 0, 0);
+		bp->b_flags |= B_INVAL | B_NOCACHE;
+		brelse(bp);
+	}
+}
+
 void
 hammer2_io_brelse(hammer2_io_t **diop)
 {
@@ -557,3 +957,76 @@ hammer2_io_isdirty(hammer2_io_t *dio)
 {
 	return((dio->refs & HAMMER2_DIO_DIRTY) != 0);
 }
+
+/*
+ * Calculate the verified-check mask for the logical range (lbase, bytes)
+ * within the dio.  Each bit represents one HAMMER2_ALLOC_MIN (1KB) chunk
+ * of the (at most 64KB) device buffer.  Returns 0 if the range cannot be
+ * represented, in which case the check code is simply never cached.
+ */
+uint64_t
+hammer2_io_mask(hammer2_io_t *dio, off_t lbase, u_int bytes)
+{
+	uint64_t mask;
+	int i;
+
+	if (bytes < HAMMER2_ALLOC_MIN)		/* smaller chunks not supported */
+		return 0;
+	lbase &= ~HAMMER2_OFF_MASK_RADIX;
+	if (lbase < dio->pbase || lbase + bytes > dio->pbase + dio->psize)
+		return 0;
+
+	i = (int)(lbase - dio->pbase) >> HAMMER2_RADIX_MIN;
+	if (bytes >= HAMMER2_PBUFSIZE)
+		mask = (uint64_t)-1;
+	else
+		mask = ((uint64_t)1 << (bytes >> HAMMER2_RADIX_MIN)) - 1;
+	return (mask << i);
+}
+
+/*
+ * Returns non-zero if the check code for the chain's media data has
+ * already been validated against the currently instantiated device
+ * buffer.  *maskp is set to the chain's mask regardless so the caller
+ * can set it after a successful check.
+ *
+ * The caller must hold the chain locked and chain->dio must be valid.
+ */
+int
+hammer2_io_crc_good(hammer2_chain_t *chain, uint64_t *maskp)
+{
+	hammer2_io_t *dio;
+	uint64_t mask;
+
+	if ((dio = chain->dio) != NULL) {
+		mask = hammer2_io_mask(dio, chain->bref.data_off,
+				       hammer2_chain_psize(chain));
+		*maskp = mask;
+		if (mask && (dio->crc_good_mask & mask) == mask)
+			return 1;
+		return 0;
+	}
+	*maskp = 0;
+
+	return 0;
+}
+
+/*
+ * Mark or unmark ranges of the device buffer as having a verified check
+ * code.  The mask is cleared whenever the underlying buffer is reloaded
+ * from media and whenever the covered range is (re)initialized or
+ * modified.
+ */
+void
+hammer2_io_crc_setmask(hammer2_io_t *dio, uint64_t mask)
+{
+	if (dio && mask)
+		atomic_set_64(&dio->crc_good_mask, mask);
+}
+
+void
+hammer2_io_crc_clrmask(hammer2_io_t *dio, uint64_t mask)
+{
+	if (dio && mask)
+		atomic_clear_64(&dio->crc_good_mask, mask);
+}
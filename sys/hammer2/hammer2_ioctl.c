@@ -61,6 +61,7 @@ static int hammer2_ioctl_pfs_delete(hammer2_inode_t *ip, void *data);
 static int hammer2_ioctl_inode_get(hammer2_inode_t *ip, void *data);
 static int hammer2_ioctl_inode_set(hammer2_inode_t *ip, void *data);
 static int hammer2_ioctl_debug_dump(hammer2_inode_t *ip);
+static int hammer2_ioctl_bulkfree_scan(hammer2_inode_t *ip, void *data);
 //static int hammer2_ioctl_inode_comp_set(hammer2_inode_t *ip, void *data);
 //static int hammer2_ioctl_inode_comp_rec_set(hammer2_inode_t *ip, void *data);
 //static int hammer2_ioctl_inode_comp_rec_set2(hammer2_inode_t *ip, void *data);
@@ -182,6 +183,10 @@ hammer2_ioctl(hammer2_inode_t *ip, u_long com, void *data, int fflag,
 	case HAMMER2IOC_DEBUG_DUMP:
 		error = hammer2_ioctl_debug_dump(ip);
 		break;
+	case HAMMER2IOC_BULKFREE_SCAN:
+		if (error == 0)
+			error = hammer2_ioctl_bulkfree_scan(ip, data);
+		break;
 	default:
 		error = EOPNOTSUPP;
 		break;
@@ -763,3 +768,17 @@ hammer2_ioctl_debug_dump(hammer2_inode_t *ip)
 	}
 	return 0;
 }
+
+/*
+ * Run a bulkfree pass on the device backing the PFS.
+ */
+static int
+hammer2_ioctl_bulkfree_scan(hammer2_inode_t *ip, void *data)
+{
+	hammer2_mount_t *hmp = ip->pmp->iroot->cluster.focus->hmp;
+	hammer2_ioc_bulkfree_t *bfi = data;
+
+	if (hmp->ronly)
+		return (EROFS);
+	return (hammer2_bulkfree_pass(hmp, bfi));
+}
@@ -117,6 +117,24 @@ typedef struct hammer2_ioc_inode hammer2_ioc_inode_t;
 #define HAMMER2IOC_INODE_FLAG_DQUOTA	0x00000002
 #define HAMMER2IOC_INODE_FLAG_COPIES	0x00000004
 
+/*
+ * Ioctl to run a bulkfree pass.  size limits the ram used by the scan
+ * (0 uses the default), the remaining fields are returned.  Counts are
+ * in 16KB freemap blocks.
+ */
+struct hammer2_ioc_bulkfree {
+	uint64_t		size;		/* scan ram limit in bytes */
+	uint64_t		count_referenced; /* blocks found in use */
+	uint64_t		count_staged;	/* 11 -> 10 (possibly free) */
+	uint64_t		count_freed;	/* 10 -> 00 (free) */
+	uint64_t		count_restored;	/* 10 -> 11 (still in use) */
+	uint64_t		count_fixups;	/* 00 -> 11 (was missing) */
+	uint64_t		count_spilled;	/* zone maps spooled to media */
+	uint64_t		reserved[9];
+};
+
+typedef struct hammer2_ioc_bulkfree hammer2_ioc_bulkfree_t;
+
 /*
  * Ioctl list
  */
@@ -146,5 +164,6 @@ typedef struct hammer2_ioc_inode hammer2_ioc_inode_t;
 #define HAMMER2IOC_INODE_COMP_REC_SET2	_IOWR('h', 90, struct hammer2_ioc_inode)*/
 
 #define HAMMER2IOC_DEBUG_DUMP	_IOWR('h', 91, int)
+#define HAMMER2IOC_BULKFREE_SCAN _IOWR('h', 92, struct hammer2_ioc_bulkfree)
 
 #endif /* !_VFS_HAMMER2_IOCTL_H_ */
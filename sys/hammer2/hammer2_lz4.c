@@ -346,16 +346,24 @@ LZ4_free(void* ctx)
 	return 0;
 }
 
+int
+LZ4_compress_limitedOutput_ctx(void* ctx, char* source, char* dest,
+			       int inputSize, int maxOutputSize)
+{
+    if (inputSize < LZ4_64KLIMIT)
+        return LZ4_compress64k_heap_limitedOutput(ctx, source, dest,
+			inputSize, maxOutputSize);
+    return LZ4_compress_heap_limitedOutput(ctx, source, dest,
+			inputSize, maxOutputSize);
+}
+
 int
 LZ4_compress_limitedOutput(char* source, char* dest, int inputSize, int maxOutputSize)
 {
     void* ctx = LZ4_create();
     int result;
     if (ctx == NULL) return 0;    // Failed allocation => compression not done
-    if (inputSize < LZ4_64KLIMIT)
-        result = LZ4_compress64k_heap_limitedOutput(ctx, source, dest,
-			inputSize, maxOutputSize);
-    else result = LZ4_compress_heap_limitedOutput(ctx, source, dest,
+    result = LZ4_compress_limitedOutput_ctx(ctx, source, dest,
 			inputSize, maxOutputSize);
     LZ4_free(ctx);
     return result;
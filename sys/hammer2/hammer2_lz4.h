@@ -88,6 +88,21 @@ LZ4_compress_limitedOutput() :
      the number of bytes written in buffer 'dest' or 0 if the compression fails
 */
 
+void* LZ4_create(void);
+int LZ4_free(void* ctx);
+int LZ4_compress_limitedOutput_ctx(void* ctx, char* source, char* dest,
+				   int inputSize, int maxOutputSize);
+
+/*
+LZ4_create() / LZ4_free() :
+    Allocate and free a hash table for LZ4_compress_limitedOutput_ctx().
+LZ4_compress_limitedOutput_ctx() :
+    Same as LZ4_compress_limitedOutput() but uses the caller supplied hash
+    table 'ctx' instead of allocating one on every call.  The table is
+    reinitialized on each call and may be reused indefinitely, but not
+    concurrently.
+*/
+
 #if defined (__cplusplus)
 }
 #endif
@@ -35,6 +35,7 @@
 #include <sys/param.h>
 #include <sys/systm.h>
 #include <sys/kernel.h>
+#include <sys/kthread.h>
 //#include <sys/nlookup.h>
 #include <sys/vnode.h>
 #include <sys/mount.h>
@@ -56,6 +57,8 @@
 
 #include <machine/mplock.h>
 #include <lib/libz/zlib.h>
+#define ZSTD_STATIC_LINKING_ONLY
+#include <lib/libzstd/zstd.h>
 
 #include "hammer2.h"
 #include "hammer2_lz4.h"
@@ -87,7 +90,27 @@ int hammer2_hardlink_enable = 1;
 int hammer2_flush_pipe = 100;
 int hammer2_synchronous_flush = 1;
 int hammer2_dio_count;
+int hammer2_dio_limit;			/* idle dios cached per mount */
+int hammer2_wthread_count;		/* write workers per PFS (0=ncpus) */
+int hammer2_flush_workers;		/* flush workers per hmp (0=ncpus) */
+int hammer2_direct_read = 0;		/* very large reads bypass bufcache */
+int hammer2_direct_write = 1;		/* full async blocks bypass dios */
+int hammer2_readahead_max = 32;		/* max read-ahead window (blocks) */
+int hammer2_bulkfree_interval = 3600;	/* seconds between bulkfree passes */
+long hammer2_bulkfree_limit;		/* bulkfree scan ram limit (bytes) */
 long hammer2_limit_dirty_chains;
+int hammer2_dirty_lowat = 30;		/* % of limit, start bg flushing */
+int hammer2_dirty_throttle = 50;	/* % of limit, start delaying */
+long hammer2_throttle_count;		/* throttle delays imposed */
+long hammer2_throttle_ticks;		/* ticks spent in throttle delays */
+long hammer2_throttle_stalls;		/* hard stalls at the limit */
+int hammer2_bgflush_batch = 32;		/* inodes per background batch */
+int hammer2_bgflush_interval = 5;	/* min seconds between bg volsyncs */
+long hammer2_bgflush_count;		/* background batches flushed */
+long hammer2_bgflush_syncs;		/* background full syncs run */
+int hammer2_fsynclog_enable = 1;	/* fsync via the fsync log */
+long hammer2_fsynclog_records;		/* fsync log records written */
+long hammer2_fsynclog_fallbacks;	/* fsync log unusable, full sync */
 long hammer2_iod_file_read;
 long hammer2_iod_meta_read;
 long hammer2_iod_indr_read;
@@ -109,9 +132,6 @@ long hammer2_ioa_meta_write;
 long hammer2_ioa_indr_write;
 long hammer2_ioa_volu_write;
 
-#define C_BUFFER "compbuffer Buffer used for compression"
-#define D_BUFFER "decompbuffer Buffer used for decompression."
-
 int hammer2_vfs_init(struct vfsconf *);
 int hammer2_vfs_uninit(struct vfsconf *);
 int hammer2_vfs_mount(struct mount *mp, char *path, caddr_t data,
@@ -119,6 +139,7 @@ int hammer2_vfs_mount(struct mount *mp, char *path, caddr_t data,
 static int hammer2_remount(hammer2_mount_t *, struct mount *, char *,
 				struct vnode *, struct ucred *);
 static int hammer2_recovery(hammer2_mount_t *hmp);
+static void hammer2_mount_share_tman(void);
 static int hammer2_vfs_unmount(struct mount *mp, int mntflags);
 static int hammer2_vfs_root(struct mount *mp, struct vnode **vpp);
 static int hammer2_vfs_statfs(struct mount *mp, struct statfs *sbp,
@@ -136,32 +157,58 @@ static int hammer2_install_volume_header(hammer2_mount_t *hmp);
 static int hammer2_sync_scan2(struct mount *, struct vnode *, void *);
 
 static void hammer2_write_thread(void *arg);
+static void hammer2_bgflush_thread(void *arg);
+static int hammer2_bgflush_scan(struct vnode *vp, void *data);
+static int hammer2_bgflush_inodes(hammer2_pfsmount_t *pmp,
+				struct vnode **vps, int batch);
+static void hammer2_wthread_start(hammer2_pfsmount_t *pmp);
+static void hammer2_wthread_stop(hammer2_pfsmount_t *pmp);
 
 static void hammer2_vfs_unmount_hmp1(struct mount *mp, hammer2_mount_t *hmp);
 static void hammer2_vfs_unmount_hmp2(struct mount *mp, hammer2_mount_t *hmp);
 
+/*
+ * Per-buffer state carried from the (parallel) compression stage of a
+ * write worker to its (per-inode serialized) commit stage.
+ */
+struct hammer2_wprep {
+	int		pblksize;	/* physical size compressed against */
+	int		comp_algo;	/* inode compression setting used */
+	int		comp_size;	/* compressed size, 0 if not */
+	int		zero;		/* logical buffer is all zeros */
+	char		*comp_buffer;	/* worker-owned, HAMMER2_PBUFSIZE/2 */
+	void		*lz4_ctx;	/* persistent LZ4 hash table */
+	z_stream	zstrm;		/* persistent deflate state */
+	int		zlevel;		/* zstrm level, 0 if not initialized */
+	ZSTD_CCtx	*zcctx;		/* static zstd context in zwork */
+	void		*zwork;		/* zstd workspace, allocated on use */
+	size_t		zworksize;
+	int		direct;		/* bp was issued to the device */
+	daddr_t		dsave_blkno;	/* bp fields while issued directly */
+	dev_t		dsave_dev;
+};
+
 /* 
  * Functions for compression in threads,
  * from hammer2_vnops.c
  */
+static void hammer2_write_prep(struct buf *bp, hammer2_inode_t *ip,
+				hammer2_key_t lbase, int comp_algo, int pblksize,
+				struct hammer2_wprep *wp);
+static int hammer2_comp_incompressible(const char *buf, int bytes);
+static ZSTD_CCtx *hammer2_zstd_cctx(struct hammer2_wprep *wp, int level);
 static void hammer2_write_file_core(struct buf *bp, hammer2_trans_t *trans,
 				hammer2_inode_t *ip,
 				hammer2_inode_data_t *ipdata,
 				hammer2_cluster_t *cparent,
 				hammer2_key_t lbase, int ioflag, int pblksize,
-				int *errorp);
+				int *errorp, struct hammer2_wprep *wp);
 
 static void hammer2_compress_and_write(struct buf *bp, hammer2_trans_t *,
 				hammer2_inode_t *, hammer2_inode_data_t *,
 				hammer2_cluster_t *,
 				hammer2_key_t lbase, int, int,
-				int *, int, int);
-static void hammer2_zero_check_and_write(struct buf *bp,
-				hammer2_trans_t *trans, hammer2_inode_t *ip,
-				hammer2_inode_data_t *ipdata,
-				hammer2_cluster_t *cparent,
-				hammer2_key_t lbase,
-				int ioflag, int pblksize, int *errorp, int check_algo);
+				int *, struct hammer2_wprep *, int);
 static int test_block_zeros(const char *buf, size_t bytes);
 static void zero_write(struct buf *bp, hammer2_trans_t *trans,
 				hammer2_inode_t *ip,
@@ -169,6 +216,11 @@ static void zero_write(struct buf *bp, hammer2_trans_t *trans,
 				hammer2_cluster_t *cparent,
 				hammer2_key_t lbase,
 				int *errorp);
+static int hammer2_write_direct(hammer2_cluster_t *cluster, struct buf *bp,
+				int pblksize, int check_algo,
+				struct hammer2_wprep *wp);
+static void hammer2_write_direct_wait(struct buf *bp,
+				struct hammer2_wprep *wp);
 static void hammer2_write_bp(hammer2_cluster_t *cluster, struct buf *bp,
 				int ioflag, int pblksize, int *errorp, int);
 
@@ -513,9 +565,6 @@ mtxsleep(void *ident, struct mutex *mtx, int flags,
 int
 hammer2_vfs_init(struct vfsconf *conf)
 {
-	static struct objcache_malloc_args margs_read;
-	static struct objcache_malloc_args margs_write;
-
 	int error;
 
 	error = 0;
@@ -530,27 +579,44 @@ hammer2_vfs_init(struct vfsconf *conf)
 	if (error)
 		printf("HAMMER2 structure size mismatch; cannot continue.\n");
 	
-	margs_read.objsize = 65536;
-	margs_read.mtype = (malloc_type_t)D_BUFFER;
-	
-	margs_write.objsize = 32768;
-	margs_write.mtype = (malloc_type_t)C_BUFFER;
-	
-/* XX fix	cache_buffer_read = cache_enter(margs_read.mtype->ks_shortdesc,
-				objcache_malloc_alloc,
-				&margs_read);
-	cache_buffer_write = cache_enter(margs_write.mtype->ks_shortdesc,
-				0, 1, NULL, NULL, NULL, objcache_malloc_alloc,
-				objcache_malloc_free, &margs_write);
-*/
+	/*
+	 * Output buffers for the decompression callbacks (a full 64KB
+	 * logical block) and for the write workers' compression stage
+	 * (compression must save at least half of a 64KB block), and
+	 * workspaces for static zstd decompression contexts.
+	 *
+	 * The pools are only used from thread context, read completions
+	 * are run by the per-device h2iodone thread (see hammer2_io.c).
+	 */
+	pool_init(&cache_buffer_read, HAMMER2_PBUFSIZE, 0, 0, PR_WAITOK,
+		  "h2dbuf", NULL);
+	pool_init(&cache_buffer_write, HAMMER2_PBUFSIZE / 2, 0, 0, PR_WAITOK,
+		  "h2cbuf", NULL);
+	pool_init(&cache_zstd_dctx, ZSTD_estimateDCtxSize(), 0, 0, PR_WAITOK,
+		  "h2zdctx", NULL);
 
 	lockinit(&hammer2_mntlk, 0, "mntlk", 0, 0);
+	hammer2_trans_manage_init(&hammer2_tmanage_shared);
 	TAILQ_INIT(&hammer2_mntlist);
 	TAILQ_INIT(&hammer2_pfslist);
 
 	hammer2_limit_dirty_chains = desiredvnodes / 10;
 
-	hammer2_trans_manage_init();
+	/*
+	 * Idle dios do not hold buffers, only the dio structure itself,
+	 * so size the cache from physical memory (one per 64 pages).
+	 */
+	if (hammer2_dio_limit == 0)
+		hammer2_dio_limit = physmem / 64;
+	if (hammer2_dio_limit < 1000)
+		hammer2_dio_limit = 1000;
+
+	/*
+	 * Each 2GB zone costs 32KB of bulkfree scan map, zones past the
+	 * limit are spooled to the reserved area of the zone.
+	 */
+	if (hammer2_bulkfree_limit == 0)
+		hammer2_bulkfree_limit = ptoa((psize_t)physmem) / 64;
 
 	return (error);
 }
@@ -558,8 +624,10 @@ hammer2_vfs_init(struct vfsconf *conf)
 int
 hammer2_vfs_uninit(struct vfsconf *vfsp __unused)
 {
-	cache_purge((struct vnode*)cache_buffer_read);
-	cache_purge((struct vnode*)cache_buffer_write);
+	pool_destroy(&cache_buffer_read);
+	pool_destroy(&cache_buffer_write);
+	pool_destroy(&cache_zstd_dctx);
+	hammer2_decompress_uninit();
 	return 0;
 }
 
@@ -587,7 +655,7 @@ hammer2_pfsalloc(const hammer2_inode_data_t *ipdata, hammer2_tid_t alloc_tid)
 		pmp->inode_tid = ipdata->pfs_inum + 1;
 		pmp->pfs_clid = ipdata->pfs_clid;
 	}
-	mtx_enter(pmp->wthread_mtx);
+	mtx_init(&pmp->wthread_mtx, IPL_BIO);
 	bioq_init(&pmp->wthread_bioq);
 
 	return pmp;
@@ -768,12 +836,17 @@ hammer2_vfs_mount(struct mount *mp, char *path, caddr_t data,
 		hmp->devvp = devvp;
 		malloc(sizeof(&hmp->mchain), (long long)"HAMMER2-chains", M_WAITOK | M_ZERO);
 		TAILQ_INSERT_TAIL(&hammer2_mntlist, hmp, mntentry);
-		RB_INIT(&hmp->iotree);
-		spin_init((struct __mp_lock *)&hmp->io_spin, "hm2mount_io");
+		hammer2_io_init(hmp);
 		spin_init((struct __mp_lock *)&hmp->list_spin, "hm2mount_list");
 		TAILQ_INIT(&hmp->flushq);
+		mtx_init(&hmp->flush_mtx, IPL_NONE);
+		TAILQ_INIT(&hmp->flush_workq);
 
 		lockinit(&hmp->vollk, 0,  "h2vol", 0, 0);
+		lockinit(&hmp->bulklk, 0,  "h2bulk", 0, 0);
+		mtx_init(&hmp->fsynclog_mtx, IPL_NONE);
+		hammer2_trans_manage_init(&hmp->tmanage);
+		hmp->tman = &hmp->tmanage;
 
 		/*
 		 * vchain setup. vchain.data is embedded.
@@ -837,6 +910,12 @@ hammer2_vfs_mount(struct mount *mp, char *path, caddr_t data,
 			hmp->spmp, (unsigned int)hmp->voldata.mirror_tid);
 		spmp = hmp->spmp;
 		spmp->inode_tid = 1;
+		spmp->tman = hmp->tman;
+
+		hmp->fsynclog_next = hmp->voldata.fsynclog_seq;
+		hmp->fsynclog_hdr = hmp->voldata.fsynclog_seq;
+		hmp->fsynclog_base = hmp->voldata.fsynclog_seq;
+		hmp->fsynclog_done = hmp->voldata.fsynclog_seq;
 
 		xid = 0;
 		hmp->vchain.bref.mirror_tid = hmp->voldata.mirror_tid;
@@ -887,7 +966,11 @@ hammer2_vfs_mount(struct mount *mp, char *path, caddr_t data,
 
 		if ((mp->mnt_flag & MNT_RDONLY) == 0) {
 			error = hammer2_recovery(hmp);
+			if (error == 0)
+				error = hammer2_fsynclog_replay(hmp);
 			/* XXX do something with error */
+			hammer2_bulkfree_init(hmp);
+			hammer2_flush_init(hmp);
 		}
 		++hmp->pmp_count;
 
@@ -1026,6 +1109,7 @@ hammer2_vfs_mount(struct mount *mp, char *path, caddr_t data,
 		ccms_thread_unlock(&pmp->iroot->topo_cst);
 		hammer2_inode_drop(pmp->iroot);
 		hammer2_cluster_unlock(cluster);
+		hammer2_mount_share_tman();
 		lockmgr(&hammer2_mntlk, LK_RELEASE, NULL);
 
 		printf("ok\n");
@@ -1041,6 +1125,7 @@ hammer2_vfs_mount(struct mount *mp, char *path, caddr_t data,
 	 * From this point on we have to call hammer2_unmount() on failure.
 	 */
 	pmp = hammer2_pfsalloc(ipdata, bref.mirror_tid);
+	pmp->tman = hmp->tman;
 	printf("PMP mirror_tid is %016x\n", (unsigned int)bref.mirror_tid);
 	for (i = 0; i < cluster->nchains; ++i) {
 		rchain = cluster->array[i];
@@ -1087,17 +1172,13 @@ hammer2_vfs_mount(struct mount *mp, char *path, caddr_t data,
 	hammer2_inode_unlock_ex(pmp->iroot, cluster);
 
 	/*
-	 * The logical file buffer bio write thread handles things
+	 * The logical file buffer bio write workers handle things
 	 * like physical block assignment and compression.
 	 *
 	 * (only applicable to pfs mounts, not applicable to spmp)
 	 */
-	pmp->wthread_destroy = 0;
-	// toss
-	free(hammer2_write_thread, 0, 0);
-	/* XXX fix me !!! lwkt_create(hammer2_write_thread, pmp,
-		    &pmp->wthread_td, NULL, 0, -1, "hwrite-%s", label);
-	*/
+	hammer2_wthread_start(pmp);
+	hammer2_bgflush_init(pmp);
 
 	/*
 	 * With the cluster operational install ihidden.
@@ -1129,136 +1210,287 @@ hammer2_vfs_mount(struct mount *mp, char *path, caddr_t data,
 }
 
 /*
- * Handle bioq for strategy write
+ * Logical buffer write pipeline.
+ *
+ * hammer2_strategy_write() queues logical buffers on pmp->wthread_bioq
+ * and a pool of write workers (one per cpu by default, capped at
+ * HAMMER2_WTHREAD_MAX) drains the queue.  Each buffer is processed in
+ * two stages:
+ *
+ * (1) Zero-detection and compression.  This is pure cpu work against
+ *     the logical buffer and runs without holding the inode lock, so
+ *     the workers compress different buffers in parallel.
+ *
+ * (2) Commit.  Under the exclusive inode lock the worker assigns
+ *     physical storage, which inserts the data chain, then copies the
+ *     (possibly compressed) data into the device buffer and sets the
+ *     check code.  This stage is kept short.
+ *
+ * Buffers belonging to the same inode are committed in the order they
+ * were dequeued.  Each buffer takes a ticket from ip->wthread_seq when it
+ * is dequeued and its commit stage waits for ip->wthread_commit to reach
+ * that ticket.  Buffers for different inodes commit independently.
+ *
+ * A dummy bio without a buffer (see hammer2_bioq_sync()) is a barrier.
+ * The worker picking it up stops further dequeues and waits for the
+ * other workers to finish the buffers they hold before completing it.
+ */
+static
+void
+hammer2_wthread_start(hammer2_pfsmount_t *pmp)
+{
+	int n;
+	int i;
+
+	n = hammer2_wthread_count;
+	if (n <= 0)
+		n = ncpus;
+	if (n > HAMMER2_WTHREAD_MAX)
+		n = HAMMER2_WTHREAD_MAX;
+
+	pmp->wthread_destroy = 0;
+	for (i = 0; i < n; ++i) {
+		mtx_enter(&pmp->wthread_mtx);
+		++pmp->wthread_count;
+		mtx_leave(&pmp->wthread_mtx);
+		if (kthread_create(hammer2_write_thread, pmp,
+				   &pmp->wthread_td[i], "h2write")) {
+			mtx_enter(&pmp->wthread_mtx);
+			--pmp->wthread_count;
+			mtx_leave(&pmp->wthread_mtx);
+			break;
+		}
+	}
+	if (i == 0)
+		printf("hammer2: unable to start write workers\n");
+}
+
+static
+void
+hammer2_wthread_stop(hammer2_pfsmount_t *pmp)
+{
+	mtx_enter(&pmp->wthread_mtx);
+	pmp->wthread_destroy = 1;
+	wakeup(&pmp->wthread_bioq);
+	while (pmp->wthread_count) {
+		msleep(&pmp->wthread_count, &pmp->wthread_mtx, PRIBIO,
+		       "umount-sleep", 0);
+	}
+	mtx_leave(&pmp->wthread_mtx);
+	bzero(pmp->wthread_td, sizeof(pmp->wthread_td));
+}
+
+/*
+ * Write worker, handles the bioq for strategy write
  */
 static
 void
 hammer2_write_thread(void *arg)
 {
 	hammer2_pfsmount_t *pmp;
-	struct bio *bio;
+	struct hammer2_wprep wprep;
+	struct bioh2 *bio;
 	struct buf *bp;
 	hammer2_trans_t trans;
-	struct vnode *vp;
 	hammer2_inode_t *ip;
 	hammer2_cluster_t *cparent;
+	const hammer2_inode_data_t *ripdata;
 	hammer2_inode_data_t *wipdata;
 	hammer2_key_t lbase;
-	// XX int lblksize;
+	u_int ticket;
+	int comp_algo;
 	int pblksize;
 	int error;
 	
 	pmp = arg;
+
+	/*
+	 * Compressor state is allocated once per worker and reused for
+	 * every buffer, the zlib state is set up on first use.
+	 */
+	bzero(&wprep, sizeof(wprep));
+	wprep.comp_buffer = pool_get(&cache_buffer_write, PR_WAITOK);
+	wprep.lz4_ctx = LZ4_create();
 	
-	mtx_enter((struct mutex *)&pmp->wthread_mtx);
-	while (pmp->wthread_destroy == 0) {
-		if (bioq_first(&pmp->wthread_bioq) == NULL) {
-			mtxsleep(&pmp->wthread_bioq, (struct mutex *)&pmp->wthread_mtx,
-				 0, "h2bioqw", 0);
+	mtx_enter(&pmp->wthread_mtx);
+	for (;;) {
+		bio = NULL;
+		if (pmp->wthread_barrier == 0) {
+			bio = (struct bioh2 *)
+			      bioq_takefirst(&pmp->wthread_bioq);
+		}
+		if (bio == NULL) {
+			if (pmp->wthread_destroy)
+				break;
+			msleep(&pmp->wthread_bioq, &pmp->wthread_mtx, PRIBIO,
+			       "h2bioqw", 0);
+			continue;
 		}
-		cparent = NULL;
 
-		hammer2_trans_init(&trans, pmp, HAMMER2_TRANS_BUFCACHE);
+		/*
+		 * dummy bio for synchronization.  Wait for the buffers
+		 * already picked up by the other workers to be committed.
+		 */
+		if (bio->bio_buf == NULL) {
+			pmp->wthread_barrier = 1;
+			while (pmp->wthread_busy) {
+				msleep(&pmp->wthread_busy, &pmp->wthread_mtx,
+				       PRIBIO, "h2bioqb", 0);
+			}
+			pmp->wthread_barrier = 0;
+			bio->bio_flags |= BIO_DONE;
+			wakeup(bio);
+			wakeup(&pmp->wthread_bioq);
+			continue;
+		}
 
-		while ((bio = bioq_takefirst(&pmp->wthread_bioq)) != NULL) {
-			/*
-			 * dummy bio for synchronization.  The transaction
-			 * must be reinitialized.
-			 */
-			/* XXX if (bio->bio_buf == NULL) {
-				bio->bio_flags |= BIO_DONE;
-				wakeup(bio);
-				hammer2_trans_done(&trans);
-				hammer2_trans_init(&trans, pmp,
-						   HAMMER2_TRANS_BUFCACHE);
-				continue;
-			} */
+		/*
+		 * else normal bio processing.  Take a commit ticket for
+		 * the inode while still holding the queue interlock so
+		 * tickets follow queue order.
+		 */
+		bp = bio->bio_buf;
+		ip = VTOI(bp->b_vp);
+		ticket = ip->wthread_seq++;
+		++pmp->wthread_busy;
+		mtx_leave(&pmp->wthread_mtx);
 
-			/*
-			 * else normal bio processing
-			 */
-			mtx_leave((struct mutex *)&pmp->wthread_mtx);
+		hammer2_lwinprog_drop(pmp);
+		error = 0;
 
-			hammer2_lwinprog_drop(pmp);
-			
-			error = 0;
-			/* XX bp = bio->bio_buf; */
-			vp = bp->b_vp;
-			ip = VTOI(vp);
+		/*
+		 * Stage 1: zero-check and compress the logical buffer
+		 * against a snapshot of the inode's compression setting
+		 * and physical block size.
+		 */
+		hammer2_calc_logical(ip, bio->bio_offset, &lbase, NULL);
+		cparent = hammer2_inode_lock_sh(ip);
+		ripdata = &hammer2_cluster_data(cparent)->ipdata;
+		pblksize = hammer2_calc_physical(ip, ripdata, lbase);
+		comp_algo = ripdata->comp_algo;
+		hammer2_inode_unlock_sh(ip, cparent);
 
-			/*
-			 * Inode is modified, flush size and mtime changes
-			 * to ensure that the file size remains consistent
-			 * with the buffers being flushed.
-			 *
-			 * NOTE: The inode_fsync() call only flushes the
-			 *	 inode's meta-data state, it doesn't try
-			 *	 to flush underlying buffers or chains.
-			 */
-			cparent = hammer2_inode_lock_ex(ip);
-			if (ip->flags & (HAMMER2_INODE_RESIZED |
-					 HAMMER2_INODE_MTIME)) {
-				hammer2_inode_fsync(&trans, ip, cparent);
-			}
-			wipdata = hammer2_cluster_modify_ip(&trans, ip,
-							 cparent, 0);
-			/* XXX fix me pointer deref lblksize = hammer2_calc_logical(ip, bio->bio_offset,
-							&lbase, NULL);
-			*/
-			pblksize = hammer2_calc_physical(ip, wipdata, lbase);
-			hammer2_write_file_core(bp, &trans, ip, wipdata,
-						cparent,
-						lbase, IO_ASYNC,
-						pblksize, &error);
-			hammer2_cluster_modsync(cparent);
-			hammer2_inode_unlock_ex(ip, cparent);
+		hammer2_write_prep(bp, ip, lbase, comp_algo, pblksize, &wprep);
+
+		/*
+		 * Stage 2: wait for our turn on this inode, then commit.
+		 */
+		mtx_enter(&pmp->wthread_mtx);
+		while (ip->wthread_commit != ticket) {
+			msleep(&ip->wthread_commit, &pmp->wthread_mtx,
+			       PRIBIO, "h2wcomm", 0);
+		}
+		mtx_leave(&pmp->wthread_mtx);
+
+		/*
+		 * Inode is modified, flush size and mtime changes
+		 * to ensure that the file size remains consistent
+		 * with the buffers being flushed.
+		 *
+		 * NOTE: The inode_fsync() call only flushes the
+		 *	 inode's meta-data state, it doesn't try
+		 *	 to flush underlying buffers or chains.
+		 */
+		hammer2_trans_init(&trans, pmp, HAMMER2_TRANS_BUFCACHE);
+		cparent = hammer2_inode_lock_ex(ip);
+		if (ip->flags & (HAMMER2_INODE_RESIZED |
+				 HAMMER2_INODE_MTIME)) {
+			hammer2_inode_fsync(&trans, ip, cparent);
+		}
+		wipdata = hammer2_cluster_modify_ip(&trans, ip,
+						 cparent, 0);
+		pblksize = hammer2_calc_physical(ip, wipdata, lbase);
+		hammer2_write_file_core(bp, &trans, ip, wipdata,
+					cparent,
+					lbase, IO_ASYNC,
+					pblksize, &error, &wprep);
+		hammer2_cluster_modsync(cparent);
+		hammer2_inode_unlock_ex(ip, cparent);
+		hammer2_trans_done(&trans);
+
+		/*
+		 * Pass the inode to the next ticket before completing the
+		 * buffer, the inode may go away once the buffer is done.
+		 */
+		mtx_enter(&pmp->wthread_mtx);
+		++ip->wthread_commit;
+		wakeup(&ip->wthread_commit);
+		mtx_leave(&pmp->wthread_mtx);
+
+		if (wprep.direct) {
+			hammer2_write_direct_wait(bp, &wprep);
+		} else {
 			if (error) {
 				printf("hammer2: error in buffer write\n");
 				bp->b_flags |= B_ERROR;
-				bp->b_error = EIO;
+				bp->b_error = error;
 			}
 			biodone((struct buf *)bio);
-			mtx_enter((struct mutex *)&pmp->wthread_mtx);
 		}
-		hammer2_trans_done(&trans);
+
+		mtx_enter(&pmp->wthread_mtx);
+		if (--pmp->wthread_busy == 0 && pmp->wthread_barrier)
+			wakeup(&pmp->wthread_busy);
 	}
-	pmp->wthread_destroy = -1;
-	wakeup(&pmp->wthread_destroy);
-	
-	mtx_leave((struct mutex *)&pmp->wthread_mtx);
+	--pmp->wthread_count;
+	wakeup(&pmp->wthread_count);
+	mtx_leave(&pmp->wthread_mtx);
+
+	if (wprep.zlevel)
+		deflateEnd(&wprep.zstrm);
+	if (wprep.zwork)
+		free(wprep.zwork, M_HAMMER2, wprep.zworksize);
+	LZ4_free(wprep.lz4_ctx);
+	pool_put(&cache_buffer_write, wprep.comp_buffer);
+	kthread_exit(0);
 }
 
+/*
+ * Wait for all logical buffers queued prior to this call to be committed
+ * by the write workers.
+ */
 void
 hammer2_bioq_sync(hammer2_pfsmount_t *pmp)
 {
-	struct bio *sync_bio;
+	struct bioh2 sync_bio;
 
 	bzero(&sync_bio, sizeof(sync_bio));	/* dummy with no bio_buf */
-	mtx_enter((struct mutex *)&pmp->wthread_mtx);
-	if (pmp->wthread_destroy == 0 &&
-	    TAILQ_FIRST(&pmp->wthread_bioq.queue)) {
-		bioq_insert_tail(&pmp->wthread_bioq, sync_bio);
-		while ((/* XXX Fix sync_bio->bio_flags & */ BIO_DONE) == 0)
-			mtxsleep(&sync_bio, (struct mutex *)&pmp->wthread_mtx, 0, "h2bioq", 0);
+	mtx_enter(&pmp->wthread_mtx);
+	if (pmp->wthread_count && pmp->wthread_destroy == 0 &&
+	    (TAILQ_FIRST(&pmp->wthread_bioq.queue) || pmp->wthread_busy)) {
+		bioq_insert_tail(&pmp->wthread_bioq,
+				 (struct bio *)&sync_bio);
+		wakeup_one(&pmp->wthread_bioq);
+		while ((sync_bio.bio_flags & BIO_DONE) == 0) {
+			msleep(&sync_bio, &pmp->wthread_mtx, PRIBIO,
+			       "h2bioq", 0);
+		}
 	}
-	mtx_leave((struct mutex *)&pmp->wthread_mtx);
+	mtx_leave(&pmp->wthread_mtx);
 }
 
 /* 
  * Return a chain suitable for I/O, creating the chain if necessary
  * and assigning its physical block.
+ *
+ * (pblksize) is the power-of-2 block size, (psize) the number of bytes
+ * which will actually be written.  The two only differ for compressed
+ * data, which is packed in 1KB units.
  */
 static
 hammer2_cluster_t *
 hammer2_assign_physical(hammer2_trans_t *trans,
 			hammer2_inode_t *ip, hammer2_cluster_t *cparent,
-			hammer2_key_t lbase, int pblksize, int *errorp)
+			hammer2_key_t lbase, int pblksize, int psize,
+			int *errorp)
 {
 	hammer2_cluster_t *cluster;
 	hammer2_cluster_t *dparent;
+	hammer2_chain_t *chain;
 	hammer2_key_t key_dummy;
 	int pradix = hammer2_getradix(pblksize);
 	int ddflag;
+	int i;
 
 	/*
 	 * Locate the chain associated with lbase, return a locked chain.
@@ -1267,7 +1499,8 @@ hammer2_assign_physical(hammer2_trans_t *trans,
 	 * logical buffer cache buffer.
 	 */
 	*errorp = 0;
-	KKASSERT(pblksize >= HAMMER2_ALLOC_MIN);
+	KKASSERT(pblksize >= HAMMER2_ALLOC_MIN && psize <= pblksize);
+	trans->pack_bytes = psize;
 retry:
 	dparent = hammer2_cluster_lookup_init(cparent, 0);
 	cluster = hammer2_cluster_lookup(dparent, &key_dummy,
@@ -1319,6 +1552,20 @@ retry:
 			 */
 			hammer2_cluster_modify(trans, cluster,
 					       HAMMER2_MODIFY_OPTDATA);
+
+			/*
+			 * A chain modified earlier in the same flush cycle
+			 * keeps its storage.  Reallocate it if its packed
+			 * size does not match what we are about to write.
+			 */
+			for (i = 0; i < cluster->nchains; ++i) {
+				chain = cluster->array[i];
+				if (chain &&
+				    hammer2_chain_psize(chain) != (size_t)psize) {
+					hammer2_freemap_alloc(trans, chain,
+							      chain->bytes);
+				}
+			}
 			break;
 		default:
 			panic("hammer2_assign_physical: bad type");
@@ -1336,9 +1583,185 @@ retry:
 	/* dparent = NULL; safety */
 	if (cluster && ddflag)
 		hammer2_cluster_replace_locked(cparent, cluster);
+	trans->pack_bytes = 0;
 	return (cluster);
 }
 
+/*
+ * Stage 1 of the write pipeline, run by the write worker without the
+ * inode lock.  Checks the logical buffer for zero-fill and attempts
+ * compression into the worker's buffer according to the inode's
+ * compression setting.  The result is consumed by
+ * hammer2_write_file_core().
+ *
+ * The per-range ip->comp_heuristic[] is only read here, it is updated in
+ * the commit stage under the inode lock.
+ */
+static
+void
+hammer2_write_prep(struct buf *bp, hammer2_inode_t *ip, hammer2_key_t lbase,
+		   int comp_algo, int pblksize, struct hammer2_wprep *wp)
+{
+	char *comp_buffer;
+	int comp_size;
+	int heur;
+
+	wp->pblksize = pblksize;
+	wp->comp_algo = comp_algo;
+	wp->comp_size = 0;
+	wp->zero = 0;
+	wp->direct = 0;
+
+	switch(HAMMER2_DEC_ALGO(comp_algo)) {
+	case HAMMER2_COMP_NONE:
+		return;
+	case HAMMER2_COMP_AUTOZERO:
+		wp->zero = test_block_zeros(bp->b_data, pblksize);
+		return;
+	default:
+		wp->zero = test_block_zeros(bp->b_data, pblksize);
+		if (wp->zero)
+			return;
+		break;
+	}
+
+	comp_size = 0;
+	comp_buffer = wp->comp_buffer;
+
+	KKASSERT(pblksize / 2 <= 32768);
+
+	/*
+	 * Skip blocks in ranges which recently failed to compress, except
+	 * for a periodic retry, and blocks which look like random data.
+	 */
+	heur = ip->comp_heuristic[HAMMER2_COMP_HEUR_SLOT(lbase)];
+	if ((heur < 8 || (heur & 7) == 0) &&
+	    hammer2_comp_incompressible(bp->b_data, pblksize) == 0) {
+		z_stream *strm_compress;
+		ZSTD_CCtx *cctx;
+		size_t zret;
+		int comp_level;
+		int ret;
+
+		switch(HAMMER2_DEC_ALGO(comp_algo)) {
+		case HAMMER2_COMP_LZ4:
+			comp_size = LZ4_compress_limitedOutput_ctx(
+					wp->lz4_ctx,
+					bp->b_data,
+					&comp_buffer[sizeof(int)],
+					pblksize,
+					pblksize / 2 - sizeof(int));
+			/*
+			 * We need to prefix with the size, LZ4
+			 * doesn't do it for us.  Add the related
+			 * overhead.
+			 */
+			*(int *)comp_buffer = comp_size;
+			if (comp_size)
+				comp_size += sizeof(int);
+			break;
+		case HAMMER2_COMP_ZLIB:
+			comp_level = HAMMER2_DEC_LEVEL(comp_algo);
+			if (comp_level == 0)
+				comp_level = 6;	/* default zlib compression */
+			else if (comp_level < 6)
+				comp_level = 6;
+			else if (comp_level > 9)
+				comp_level = 9;
+
+			/*
+			 * Reuse the worker's deflate state, only the
+			 * first use pays for deflateInit().
+			 */
+			strm_compress = &wp->zstrm;
+			if (wp->zlevel == 0) {
+				ret = deflateInit(strm_compress, comp_level);
+				if (ret != Z_OK) {
+					printf("HAMMER2 ZLIB: fatal error "
+						"on deflateInit.\n");
+					break;
+				}
+				wp->zlevel = comp_level;
+			} else {
+				deflateReset(strm_compress);
+				if (wp->zlevel != comp_level) {
+					deflateParams(strm_compress, comp_level,
+						      Z_DEFAULT_STRATEGY);
+					wp->zlevel = comp_level;
+				}
+			}
+
+			strm_compress->next_in = bp->b_data;
+			strm_compress->avail_in = pblksize;
+			strm_compress->next_out = comp_buffer;
+			strm_compress->avail_out = pblksize / 2;
+			ret = deflate(strm_compress, Z_FINISH);
+			if (ret == Z_STREAM_END) {
+				comp_size = pblksize / 2 -
+					    strm_compress->avail_out;
+			} else {
+				comp_size = 0;
+			}
+			break;
+		case HAMMER2_COMP_ZSTD:
+			comp_level = HAMMER2_DEC_LEVEL(comp_algo);
+			if (comp_level == 0)
+				comp_level = ZSTD_CLEVEL_DEFAULT;
+			else if (comp_level > 9)
+				comp_level = 9;
+
+			/*
+			 * zstd frames carry their own length, the tail of
+			 * the physical block is zero-filled on write and
+			 * skipped on read.
+			 */
+			cctx = hammer2_zstd_cctx(wp, comp_level);
+			if (cctx == NULL)
+				break;
+			zret = ZSTD_compressCCtx(cctx, comp_buffer,
+						 pblksize / 2,
+						 bp->b_data, pblksize,
+						 comp_level);
+			if (ZSTD_isError(zret))
+				comp_size = 0;
+			else
+				comp_size = (int)zret;
+			break;
+		default:
+			printf("Error: Unknown compression method.\n");
+			printf("Comp_method = %d.\n", comp_algo);
+			break;
+		}
+	}
+	wp->comp_size = comp_size;
+}
+
+/*
+ * Return the worker's zstd compression context, sized for a 64KB block
+ * at the requested level.  The workspace only grows, a lower level runs
+ * in the workspace of a higher one.  Stage 1 runs without the inode
+ * lock so the allocation may sleep.
+ */
+static
+ZSTD_CCtx *
+hammer2_zstd_cctx(struct hammer2_wprep *wp, int level)
+{
+	size_t size;
+
+	size = ZSTD_estimateCCtxSize_usingCParams(
+			ZSTD_getCParams(level, HAMMER2_PBUFSIZE, 0));
+	if (wp->zcctx && size <= wp->zworksize)
+		return (wp->zcctx);
+
+	if (wp->zwork)
+		free(wp->zwork, M_HAMMER2, wp->zworksize);
+	wp->zwork = malloc(size, M_HAMMER2, M_WAITOK);
+	wp->zworksize = size;
+	wp->zcctx = ZSTD_initStaticCCtx(wp->zwork, size);
+
+	return (wp->zcctx);
+}
+
 /* 
  * bio queued from hammer2_vnops.c.
  *
@@ -1346,6 +1769,11 @@ retry:
  * depending on compression settings.  We also have to locate the
  * related clusters so we can calculate and set the check data for
  * the blockref.
+ *
+ * This is the commit stage of the write pipeline and is called with the
+ * inode locked exclusively.  The zero-check and compression were already
+ * done by hammer2_write_prep() unless the file was resized in the mean
+ * time, in which case they are redone against the new block size.
  */
 static
 void
@@ -1353,12 +1781,16 @@ hammer2_write_file_core(struct buf *bp, hammer2_trans_t *trans,
 			hammer2_inode_t *ip, hammer2_inode_data_t *ipdata,
 			hammer2_cluster_t *cparent,
 			hammer2_key_t lbase, int ioflag, int pblksize,
-			int *errorp)
+			int *errorp, struct hammer2_wprep *wp)
 {
 	hammer2_cluster_t *cluster;
 
-	switch(HAMMER2_DEC_ALGO(ipdata->comp_algo)) {
+	if (wp->pblksize != pblksize)
+		hammer2_write_prep(bp, ip, lbase, wp->comp_algo, pblksize, wp);
+
+	switch(HAMMER2_DEC_ALGO(wp->comp_algo)) {
 	case HAMMER2_COMP_NONE:
+	case HAMMER2_COMP_AUTOZERO:
 		/*
 		 * We have to assign physical storage to the buffer
 		 * we intend to dirty or write now to avoid deadlocks
@@ -1367,43 +1799,48 @@ hammer2_write_file_core(struct buf *bp, hammer2_trans_t *trans,
 		 * This can return NOOFFSET for inode-embedded data.
 		 * The strategy code will take care of it in that case.
 		 */
+		if (wp->zero) {
+			zero_write(bp, trans, ip, ipdata, cparent,
+				   lbase, errorp);
+			break;
+		}
 		cluster = hammer2_assign_physical(trans, ip, cparent,
-						lbase, pblksize,
+						lbase, pblksize, pblksize,
 						errorp);
-		hammer2_write_bp(cluster, bp, ioflag, pblksize, errorp,
-				 ipdata->check_algo);
+		if (cluster && hammer2_write_direct(cluster, bp, pblksize,
+						    ipdata->check_algo, wp)) {
+			wp->direct = 1;
+		} else {
+			hammer2_write_bp(cluster, bp, ioflag, pblksize, errorp,
+					 ipdata->check_algo);
+		}
 		if (cluster)
 			hammer2_cluster_unlock(cluster);
 		break;
-	case HAMMER2_COMP_AUTOZERO:
-		/*
-		 * Check for zero-fill only
-		 */
-		hammer2_zero_check_and_write(bp, trans, ip,
-				    ipdata, cparent, lbase,
-				    ioflag, pblksize, errorp,
-				    ipdata->check_algo);
-		break;
 	case HAMMER2_COMP_LZ4:
 	case HAMMER2_COMP_ZLIB:
+	case HAMMER2_COMP_ZSTD:
 	default:
 		/*
-		 * Check for zero-fill and attempt compression.
+		 * Zero-fill or (possibly) compressed data.
 		 */
+		if (wp->zero) {
+			zero_write(bp, trans, ip, ipdata, cparent,
+				   lbase, errorp);
+			break;
+		}
 		hammer2_compress_and_write(bp, trans, ip,
 					   ipdata, cparent,
 					   lbase, ioflag,
 					   pblksize, errorp,
-					   ipdata->comp_algo,
-					   ipdata->check_algo);
+					   wp, ipdata->check_algo);
 		break;
 	}
 }
 
 /*
- * Generic function that will perform the compression in compression
- * write path. The compression algorithm is determined by the settings
- * obtained from inode.
+ * Write out the result of the compression stage.  The compression
+ * algorithm is the one obtained from the inode by hammer2_write_prep().
  */
 static
 void
@@ -1411,98 +1848,33 @@ hammer2_compress_and_write(struct buf *bp, hammer2_trans_t *trans,
 	hammer2_inode_t *ip, hammer2_inode_data_t *ipdata,
 	hammer2_cluster_t *cparent,
 	hammer2_key_t lbase, int ioflag, int pblksize,
-	int *errorp, int comp_algo, int check_algo)
+	int *errorp, struct hammer2_wprep *wp, int check_algo)
 {
 	hammer2_cluster_t *cluster;
 	hammer2_chain_t *chain;
+	uint8_t *heur;
 	int comp_size;
 	int comp_block_size;
+	int comp_psize;
+	int slot;
 	int i;
-	char *comp_buffer;
-
-	if (test_block_zeros(bp->b_data, pblksize)) {
-		zero_write(bp, trans, ip, ipdata, cparent, lbase, errorp);
-		return;
-	}
-
-	comp_size = 0;
-	comp_buffer = NULL;
-
-	KKASSERT(pblksize / 2 <= 32768);
-		
-	if (ip->comp_heuristic < 8 || (ip->comp_heuristic & 7) == 0) {
-		z_stream strm_compress;
-		int comp_level;
-		int ret;
 
-		switch(HAMMER2_DEC_ALGO(comp_algo)) {
-		case HAMMER2_COMP_LZ4:
-			/* XXX comp_buffer = objcache_get(cache_buffer_write,
-						   M_INTWAIT);
-			*/
-			comp_size = LZ4_compress_limitedOutput(
-					bp->b_data,
-					&comp_buffer[sizeof(int)],
-					pblksize,
-					pblksize / 2 - sizeof(int));
-			/*
-			 * We need to prefix with the size, LZ4
-			 * doesn't do it for us.  Add the related
-			 * overhead.
-			 */
-			*(int *)comp_buffer = comp_size;
-			if (comp_size)
-				comp_size += sizeof(int);
-			break;
-		case HAMMER2_COMP_ZLIB:
-			comp_level = HAMMER2_DEC_LEVEL(comp_algo);
-			if (comp_level == 0)
-				comp_level = 6;	/* default zlib compression */
-			else if (comp_level < 6)
-				comp_level = 6;
-			else if (comp_level > 9)
-				comp_level = 9;
-			ret = deflateInit(&strm_compress, comp_level);
-			if (ret != Z_OK) {
-				printf("HAMMER2 ZLIB: fatal error "
-					"on deflateInit.\n");
-			}
-
-			/* XXX comp_buffer = objcache_get(cache_buffer_write,
-						   M_INTWAIT);
-			*/
-			strm_compress.next_in = bp->b_data;
-			strm_compress.avail_in = pblksize;
-			strm_compress.next_out = comp_buffer;
-			strm_compress.avail_out = pblksize / 2;
-			ret = deflate(&strm_compress, Z_FINISH);
-			if (ret == Z_STREAM_END) {
-				comp_size = pblksize / 2 -
-					    strm_compress.avail_out;
-			} else {
-				comp_size = 0;
-			}
-			ret = deflateEnd(&strm_compress);
-			break;
-		default:
-			printf("Error: Unknown compression method.\n");
-			printf("Comp_method = %d.\n", comp_algo);
-			break;
-		}
-	}
+	comp_size = wp->comp_size;
+	slot = HAMMER2_COMP_HEUR_SLOT(lbase);
+	heur = &ip->comp_heuristic[slot];
 
 	if (comp_size == 0) {
 		/*
 		 * compression failed or turned off
 		 */
 		comp_block_size = pblksize;	/* safety */
-		if (++ip->comp_heuristic > 128)
-			ip->comp_heuristic = 8;
+		if (++*heur > 128)
+			*heur = 8;
 	} else {
 		/*
 		 * compression succeeded
 		 */
-		ip->comp_heuristic = 0;
+		*heur = 0;
 		if (comp_size <= 1024) {
 			comp_block_size = 1024;
 		} else if (comp_size <= 2048) {
@@ -1523,11 +1895,37 @@ hammer2_compress_and_write(struct buf *bp, hammer2_trans_t *trans,
 		}
 	}
 
+	/*
+	 * Results which fit in a freemap block are packed in 1KB units
+	 * rather than rounded up to the power-of-2 block size, provided
+	 * every volume of the cluster supports packing.
+	 */
+	comp_psize = comp_block_size;
+	if (comp_size && comp_block_size <= HAMMER2_FREEMAP_BLOCK_SIZE) {
+		for (i = 0; i < cparent->nchains; ++i) {
+			chain = cparent->array[i];
+			if (chain && !HAMMER2_VOL_PACKABLE(chain->hmp))
+				break;
+		}
+		if (i == cparent->nchains)
+			comp_psize = roundup(comp_size, HAMMER2_ALLOC_MIN);
+	}
+
 	cluster = hammer2_assign_physical(trans, ip, cparent,
-					  lbase, comp_block_size,
+					  lbase, comp_block_size, comp_psize,
 					  errorp);
 	ipdata = &hammer2_cluster_data(cparent)->ipdata;
 
+	/*
+	 * Remember incompressible ranges in the inode meta-data (which
+	 * the caller has already modified) so the heuristic survives
+	 * inode eviction.
+	 */
+	if (*heur >= 8)
+		ipdata->comp_hint |= 1 << slot;
+	else
+		ipdata->comp_hint &= ~(1 << slot);
+
 	if (*errorp) {
 		printf("WRITE PATH: An error occurred while "
 			"assigning physical space.\n");
@@ -1553,12 +1951,22 @@ hammer2_compress_and_write(struct buf *bp, hammer2_trans_t *trans,
 		case HAMMER2_BREF_TYPE_DATA:
 			/*
 			 * Optimize out the read-before-write
-			 * if possible.
+			 * if possible.  A packed block shares its
+			 * device buffer with other allocations so
+			 * it must not be instantiated without being
+			 * read.
 			 */
-			*errorp = hammer2_io_newnz(chain->hmp,
+			if (hammer2_chain_psize(chain) != chain->bytes) {
+				*errorp = hammer2_io_bread(chain->hmp,
 						   chain->bref.data_off,
 						   chain->bytes,
 						   &dio);
+			} else {
+				*errorp = hammer2_io_newnz(chain->hmp,
+						   chain->bref.data_off,
+						   chain->bytes,
+						   &dio);
+			}
 			if (*errorp) {
 				hammer2_io_brelse(&dio);
 				printf("hammer2: WRITE PATH: "
@@ -1573,12 +1981,12 @@ hammer2_compress_and_write(struct buf *bp, hammer2_trans_t *trans,
 			 */
 			if (comp_size) {
 				chain->bref.methods =
-					HAMMER2_ENC_COMP(comp_algo) +
+					HAMMER2_ENC_COMP(wp->comp_algo) +
 					HAMMER2_ENC_CHECK(check_algo);
-				bcopy(comp_buffer, bdata, comp_size);
-				if (comp_size != comp_block_size) {
+				bcopy(wp->comp_buffer, bdata, comp_size);
+				if (comp_size != comp_psize) {
 					bzero(bdata + comp_size,
-					      comp_block_size - comp_size);
+					      comp_psize - comp_size);
 				}
 			} else {
 				chain->bref.methods =
@@ -1630,51 +2038,88 @@ hammer2_compress_and_write(struct buf *bp, hammer2_trans_t *trans,
 done:
 	if (cluster)
 		hammer2_cluster_unlock(cluster);
-	// XX if (comp_buffer)
-		// XX objcache_put(cache_buffer_write, comp_buffer);
 }
 
 /*
- * Function that performs zero-checking and writing without compression,
- * it corresponds to default zero-checking path.
+ * A function to test whether a block of data contains only zeros,
+ * returns TRUE (non-zero) if the block is all zeros.
+ *
+ * This runs on every write with AUTOZERO or compression enabled.  The
+ * first and last words are tested up front since ordinary data almost
+ * always fails there, then the block is OR-reduced a 64-byte cache line
+ * at a time with one branch per line.  Non-zero data thus exits within
+ * the first line touched and the compressor remains the only full pass
+ * over the buffer.
+ *
+ * (SIMD is not used, the kernel does not save FPU state for us here.)
  */
 static
-void
-hammer2_zero_check_and_write(struct buf *bp, hammer2_trans_t *trans,
-	hammer2_inode_t *ip, hammer2_inode_data_t *ipdata,
-	hammer2_cluster_t *cparent,
-	hammer2_key_t lbase, int ioflag, int pblksize, int *errorp,
-	int check_algo)
+int
+test_block_zeros(const char *buf, size_t bytes)
 {
-	hammer2_cluster_t *cluster;
+	const u_long *lp = (const u_long *)buf;
+	size_t count = bytes / sizeof(u_long);
+	size_t i;
 
-	if (test_block_zeros(bp->b_data, pblksize)) {
-		zero_write(bp, trans, ip, ipdata, cparent, lbase, errorp);
-	} else {
-		cluster = hammer2_assign_physical(trans, ip, cparent,
-						  lbase, pblksize, errorp);
-		hammer2_write_bp(cluster, bp, ioflag, pblksize, errorp,
-				 check_algo);
-		if (cluster)
-			hammer2_cluster_unlock(cluster);
+	if (count == 0)
+		return (1);
+	if (lp[0] | lp[count - 1])
+		return (0);
+	for (i = 0; i + 8 <= count; i += 8) {
+		if (lp[i + 0] | lp[i + 1] | lp[i + 2] | lp[i + 3] |
+		    lp[i + 4] | lp[i + 5] | lp[i + 6] | lp[i + 7]) {
+			return (0);
+		}
+	}
+	for (; i < count; ++i) {
+		if (lp[i])
+			return (0);
 	}
+	return (1);
 }
 
 /*
- * A function to test whether a block of data contains only zeros,
- * returns TRUE (non-zero) if the block is all zeros.
+ * Cheap pre-check run before attempting compression.  A byte histogram
+ * is built from HAMMER2_COMP_SAMPLES evenly spaced 32-byte samples of the
+ * block and its collision entropy is estimated from the sum of the squared
+ * counts.  Returns TRUE (non-zero) if the sample looks like random data
+ * (more than ~7 bits per byte), which LZ4 and ZLIB will fail to compress
+ * by the required 50%.
  */
+#define HAMMER2_COMP_SAMPLES	16
+#define HAMMER2_COMP_SAMPLE_LEN	32
+
 static
 int
-test_block_zeros(const char *buf, size_t bytes)
+hammer2_comp_incompressible(const char *buf, int bytes)
 {
-	size_t i;
+	uint16_t hist[256];
+	const uint8_t *scan;
+	uint32_t sumsq;
+	int stride;
+	int n;
+	int i;
+	int j;
 
-	for (i = 0; i < bytes; i += sizeof(long)) {
-		if (*(const long *)(buf + i) != 0)
-			return (0);
+	stride = bytes / HAMMER2_COMP_SAMPLES;
+	if (stride < HAMMER2_COMP_SAMPLE_LEN)
+		return (0);
+
+	bzero(hist, sizeof(hist));
+	for (i = 0; i < HAMMER2_COMP_SAMPLES; ++i) {
+		scan = (const uint8_t *)buf + i * stride;
+		for (j = 0; j < HAMMER2_COMP_SAMPLE_LEN; ++j)
+			++hist[scan[j]];
 	}
-	return (1);
+	sumsq = 0;
+	for (i = 0; i < 256; ++i)
+		sumsq += (uint32_t)hist[i] * hist[i];
+
+	/*
+	 * Collision entropy is log2(n^2 / sumsq), compare against 7 bits.
+	 */
+	n = HAMMER2_COMP_SAMPLES * HAMMER2_COMP_SAMPLE_LEN;
+	return ((uint32_t)n * n > sumsq * 128);
 }
 
 /*
@@ -1712,6 +2157,96 @@ zero_write(struct buf *bp, hammer2_trans_t *trans,
 	hammer2_cluster_lookup_done(cparent);
 }
 
+/*
+ * Write a full uncompressed block straight from the logical buffer to
+ * its newly assigned physical block, without instantiating a dio.  This
+ * avoids copying the data into a device buffer and keeping it cached
+ * twice.  Returns 0 if the direct path cannot be used, in which case the
+ * caller falls back to hammer2_write_bp().
+ *
+ * Only asynchronous full-size (device buffer sized) writes to a single
+ * chain are handled.  The logical buffer itself is issued to the device
+ * (like ufs_strategy() does) with its block number and device pointed
+ * at the media, the originals are saved in the wprep.  The write is not
+ * waited for here, the caller must call hammer2_write_direct_wait()
+ * once the inode has been unlocked and handed to the next ticket.
+ *
+ * The block check is computed from the buffer up front, the data cannot
+ * change while the buffer is busy.  The vnode's output count covers the
+ * write until the device completes it, so a sync (vflushbuf()) still
+ * waits for the data before the blockref can be flushed.  Like a
+ * delayed dio write, a device error is only reported on the buffer.
+ *
+ * Any device buffers left over from a previous use of the storage are
+ * invalidated first so they cannot be written back over the new data or
+ * be read in place of it.
+ */
+static
+int
+hammer2_write_direct(hammer2_cluster_t *cluster, struct buf *bp,
+		     int pblksize, int check_algo, struct hammer2_wprep *wp)
+{
+	struct vop_strategy_args ap;
+	hammer2_chain_t *chain;
+	hammer2_mount_t *hmp;
+	hammer2_off_t pbase;
+
+	if (hammer2_direct_write == 0 || cluster->nchains != 1)
+		return (0);
+	chain = cluster->array[0];
+	if (chain == NULL ||
+	    chain->bref.type != HAMMER2_BREF_TYPE_DATA ||
+	    chain->bytes != HAMMER2_PBUFSIZE ||
+	    pblksize != chain->bytes || bp->b_bcount != pblksize ||
+	    chain->dio != NULL) {
+		return (0);
+	}
+	if ((bp->b_flags & (B_ASYNC | B_CALL)) != B_ASYNC)
+		return (0);
+	KKASSERT(chain->flags & HAMMER2_CHAIN_MODIFIED);
+
+	hmp = chain->hmp;
+	pbase = chain->bref.data_off & ~HAMMER2_OFF_MASK_RADIX;
+
+	hammer2_io_inval(hmp, pbase, pblksize);
+	++hammer2_iod_file_write;
+
+	chain->bref.methods = HAMMER2_ENC_COMP(HAMMER2_COMP_NONE) +
+			      HAMMER2_ENC_CHECK(check_algo);
+	hammer2_chain_setcheck(chain, bp->b_data);
+	atomic_clear_int(&chain->flags, HAMMER2_CHAIN_INITIAL);
+
+	CLR(bp->b_flags, B_ASYNC);
+	wp->dsave_blkno = bp->b_blkno;
+	wp->dsave_dev = bp->b_dev;
+	bp->b_blkno = pbase;
+	bp->b_dev = hmp->devvp->v_rdev;
+	ap.a_bp = bp;
+	(hmp->devvp->v_op->vop_strategy)(&ap);
+
+	return (1);
+}
+
+/*
+ * Wait for a logical buffer issued by hammer2_write_direct(), restore
+ * its logical identity and release it.
+ */
+static
+void
+hammer2_write_direct_wait(struct buf *bp, struct hammer2_wprep *wp)
+{
+	daddr_t pbase;
+
+	pbase = bp->b_blkno;
+	if (biowait(bp)) {
+		printf("hammer2: direct write error %d @ %016llx\n",
+		       bp->b_error, (long long)pbase);
+	}
+	bp->b_blkno = wp->dsave_blkno;
+	bp->b_dev = wp->dsave_dev;
+	brelse(bp);
+}
+
 /*
  * Function to write the data as it is, without performing any sort of
  * compression. This function is used in path without compression and
@@ -1804,6 +2339,93 @@ hammer2_write_bp(hammer2_cluster_t *cluster, struct buf *bp, int ioflag,
 	*errorp = error;
 }
 
+/*
+ * A PFS cluster spanning several devices must rendezvous on a single
+ * transaction manager, a flush of any of the devices has to exclude the
+ * PFS's frontend transactions.  Such devices, and every PFS mounted from
+ * them, are moved to hammer2_tmanage_shared.  Devices are never moved
+ * back.
+ *
+ * A device's own manager is held with a flush transaction while its
+ * users are switched over.  Transactions waiting on it then retry on the
+ * shared manager, see hammer2_trans_init().
+ *
+ * Called with hammer2_mntlk held exclusively.
+ */
+static
+void
+hammer2_mount_share_tman(void)
+{
+	hammer2_pfsmount_t *pmp;
+	hammer2_mount_t *hmp;
+	hammer2_mount_t *xhmp;
+	hammer2_chain_t *chain;
+	hammer2_trans_t trans;
+	int changed;
+	int share;
+	int i;
+
+	/*
+	 * Mark the devices to move.  Repeat until no PFS spans both a
+	 * device which uses (or is about to use) the shared manager and
+	 * one which does not.
+	 */
+	do {
+		changed = 0;
+		TAILQ_FOREACH(pmp, &hammer2_pfslist, mntentry) {
+			if (pmp->iroot == NULL)
+				continue;
+			share = 0;
+			xhmp = NULL;
+			for (i = 0; i < pmp->iroot->cluster.nchains; ++i) {
+				chain = pmp->iroot->cluster.array[i];
+				if (chain == NULL)
+					continue;
+				hmp = chain->hmp;
+				if ((xhmp && hmp != xhmp) || hmp->tman_share ||
+				    hmp->tman == &hammer2_tmanage_shared) {
+					share = 1;
+				}
+				xhmp = hmp;
+			}
+			for (i = 0; share && i < pmp->iroot->cluster.nchains;
+			     ++i) {
+				chain = pmp->iroot->cluster.array[i];
+				if (chain == NULL)
+					continue;
+				hmp = chain->hmp;
+				if (hmp->tman_share == 0 &&
+				    hmp->tman != &hammer2_tmanage_shared) {
+					hmp->tman_share = 1;
+					changed = 1;
+				}
+			}
+		}
+	} while (changed);
+
+	TAILQ_FOREACH(hmp, &hammer2_mntlist, mntentry) {
+		if (hmp->tman_share == 0)
+			continue;
+		hmp->tman_share = 0;
+		hammer2_trans_init(&trans, hmp->spmp, HAMMER2_TRANS_ISFLUSH);
+		hmp->tman = &hammer2_tmanage_shared;
+		hmp->spmp->tman = hmp->tman;
+		TAILQ_FOREACH(pmp, &hammer2_pfslist, mntentry) {
+			if (pmp->iroot == NULL)
+				continue;
+			for (i = 0; i < pmp->iroot->cluster.nchains; ++i) {
+				chain = pmp->iroot->cluster.array[i];
+				if (chain && chain->hmp == hmp)
+					pmp->tman = hmp->tman;
+			}
+		}
+		membar_producer();
+		hammer2_trans_done(&trans);
+		printf("hammer2: %p now uses the shared transaction manager\n",
+		       hmp);
+	}
+}
+
 static
 int
 hammer2_remount(hammer2_mount_t *hmp, struct mount *mp, char *path,
@@ -1813,6 +2435,8 @@ hammer2_remount(hammer2_mount_t *hmp, struct mount *mp, char *path,
 
 	if (hmp->ronly && (mp->mnt_kern_flag & MNTK_WANTRDWR)) {
 		error = hammer2_recovery(hmp);
+		if (error == 0)
+			error = hammer2_fsynclog_replay(hmp);
 	} else {
 		error = 0;
 	}
@@ -1855,18 +2479,8 @@ hammer2_vfs_unmount(struct mount *mp, int mntflags)
 
 	ccms_domain_uninit(&pmp->ccms_dom);
 
-	if (pmp->wthread_td) {
-		mtx_enter((struct mutex *)&pmp->wthread_mtx);
-		pmp->wthread_destroy = 1;
-		wakeup(&pmp->wthread_bioq);
-		while (pmp->wthread_destroy != -1) {
-			mtxsleep(&pmp->wthread_destroy,
-				(struct mutex *)&pmp->wthread_mtx, 0,
-				"umount-sleep",	0);
-		}
-		mtx_leave((struct mutex *)&pmp->wthread_mtx);
-		pmp->wthread_td = NULL;
-	}
+	hammer2_bgflush_uninit(pmp);
+	hammer2_wthread_stop(pmp);
 
 	/*
 	 * Cleanup our reference on ihidden.
@@ -1939,6 +2553,12 @@ hammer2_vfs_unmount_hmp1(struct mount *mp, hammer2_mount_t *hmp)
 
 	printf("hammer2_unmount hmp=%p pmpcnt=%d\n", hmp, hmp->pmp_count);
 
+	/*
+	 * Stop the bulkfree thread before the final flushes.
+	 */
+	if (hmp->pmp_count == 0)
+		hammer2_bulkfree_uninit(hmp);
+
 	kdmsg_iocom_uninit(&hmp->iocom);	/* XXX chain depend deadlck? */
 
 	/*
@@ -1960,6 +2580,7 @@ hammer2_vfs_unmount_hmp1(struct mount *mp, hammer2_mount_t *hmp)
 	}
 
 	if (hmp->pmp_count == 0) {
+		hammer2_flush_uninit(hmp);
 		if ((hmp->vchain.flags | hmp->fchain.flags) &
 		    HAMMER2_CHAIN_FLUSH_MASK) {
 			printf("hammer2_unmount: chains left over "
@@ -2064,7 +2685,8 @@ hammer2_vfs_unmount_hmp2(struct mount *mp, hammer2_mount_t *hmp)
 		hammer2_mount_unlock(hmp);
 		hammer2_chain_drop(&hmp->vchain);
 
-		hammer2_io_cleanup(hmp, &hmp->iotree);
+		hammer2_io_uninit(hmp);
+		hammer2_io_cleanup_all(hmp);
 		if (hmp->iofree_count) {
 			printf("io_cleanup: %d I/O's left hanging\n",
 				hmp->iofree_count);
@@ -2131,7 +2753,7 @@ hammer2_vfs_statfs(struct mount *mp, struct statfs *sbp, struct ucred *cred)
 	mp->mnt_stat.f_files = pmp->inode_count;
 	mp->mnt_stat.f_ffree = 0;
 	mp->mnt_stat.f_blocks = hmp->voldata.allocator_size / HAMMER2_PBUFSIZE;
-	mp->mnt_stat.f_bfree =  hmp->voldata.allocator_free / HAMMER2_PBUFSIZE;
+	mp->mnt_stat.f_bfree =  hammer2_freemap_free(hmp) / HAMMER2_PBUFSIZE;
 	mp->mnt_stat.f_bavail = mp->mnt_stat.f_bfree;
 
 	*sbp = mp->mnt_stat;
@@ -2153,7 +2775,7 @@ hammer2_vfs_statvfs(struct mount *mp, struct statfs *sbp, struct ucred *cred)
 	mp->mnt_stat.f_files = pmp->inode_count;
 	mp->mnt_stat.f_ffree = 0;
 	mp->mnt_stat.f_blocks = hmp->voldata.allocator_size / HAMMER2_PBUFSIZE;
-	mp->mnt_stat.f_bfree =  hmp->voldata.allocator_free / HAMMER2_PBUFSIZE;
+	mp->mnt_stat.f_bfree =  hammer2_freemap_free(hmp) / HAMMER2_PBUFSIZE;
 	// XXX mp->mnt_stat.f_bavail = mp->mnt_vstat.f_bfree;
 
 	// XXX *sbp = mp->mnt_vstat;
@@ -2170,6 +2792,13 @@ hammer2_vfs_statvfs(struct mount *mp, struct statfs *sbp, struct ucred *cred)
  *
  * The super-root topology and each PFS has its own transaction id domain,
  * so we must track PFS boundary transitions.
+ *
+ * The scan is run by the mounting thread plus up to
+ * HAMMER2_RECOVERY_WORKERS helper threads.  Subtrees are deferred to a
+ * shared list at the depth limit, at PFS boundaries, and whenever a
+ * worker is idle, and any worker may pick them up.  Before descending,
+ * read-ahead is issued for all inode and indirect children that pass
+ * the sync_tid test so the media I/O overlaps the scan.
  */
 struct hammer2_recovery_elm {
 	TAILQ_ENTRY(hammer2_recovery_elm) entry;
@@ -2181,15 +2810,23 @@ TAILQ_HEAD(hammer2_recovery_list, hammer2_recovery_elm);
 
 struct hammer2_recovery_info {
 	struct hammer2_recovery_list list;
-	int	depth;
+	struct mutex	list_mtx;	/* interlock for the fields below */
+	hammer2_mount_t	*hmp;
+	int		active;		/* workers scanning */
+	int		idle;		/* workers waiting for work */
+	int		nthreads;	/* helper threads running */
+	int		error;
 };
 
 static int hammer2_recovery_scan(hammer2_trans_t *trans, hammer2_mount_t *hmp,
 			hammer2_chain_t *parent,
 			struct hammer2_recovery_info *info,
-			hammer2_tid_t sync_tid);
+			hammer2_tid_t sync_tid, int depth);
+static void hammer2_recovery_worker(struct hammer2_recovery_info *info);
+static void hammer2_recovery_thread(void *arg);
 
 #define HAMMER2_RECOVERY_MAXDEPTH	10
+#define HAMMER2_RECOVERY_WORKERS	8
 
 static
 int
@@ -2197,39 +2834,186 @@ hammer2_recovery(hammer2_mount_t *hmp)
 {
 	hammer2_trans_t trans;
 	struct hammer2_recovery_info info;
-	struct hammer2_recovery_elm *elm;
 	hammer2_chain_t *parent;
 	hammer2_tid_t sync_tid;
 	int error;
-	int cumulative_error = 0;
+	int n;
 
-	hammer2_trans_init(&trans, hmp->spmp, 0);
+	bzero(&info, sizeof(info));
+	TAILQ_INIT(&info.list);
+	mtx_init(&info.list_mtx, IPL_BIO);
+	info.hmp = hmp;
+	info.active = 1;		/* the initial scan below */
+
+	/*
+	 * Start the helpers, they sleep until subtrees are deferred.
+	 */
+	n = ncpus - 1;
+	if (n > HAMMER2_RECOVERY_WORKERS)
+		n = HAMMER2_RECOVERY_WORKERS;
+	while (n > 0) {
+		mtx_enter(&info.list_mtx);
+		++info.nthreads;
+		mtx_leave(&info.list_mtx);
+		if (kthread_create(hammer2_recovery_thread, &info, NULL,
+				   "h2recover")) {
+			mtx_enter(&info.list_mtx);
+			--info.nthreads;
+			mtx_leave(&info.list_mtx);
+			break;
+		}
+		--n;
+	}
 
+	hammer2_trans_init(&trans, hmp->spmp, 0);
 	sync_tid = 0;
-	TAILQ_INIT(&info.list);
-	info.depth = 0;
 	parent = hammer2_chain_lookup_init(&hmp->vchain, 0);
-	cumulative_error = hammer2_recovery_scan(&trans, hmp, parent,
-						 &info, sync_tid);
+	error = hammer2_recovery_scan(&trans, hmp, parent, &info, sync_tid, 0);
 	hammer2_chain_lookup_done(parent);
+	hammer2_trans_done(&trans);
+
+	mtx_enter(&info.list_mtx);
+	if (error)
+		info.error = error;
+	--info.active;
+	mtx_leave(&info.list_mtx);
 
-	while ((elm = TAILQ_FIRST(&info.list)) != NULL) {
-		TAILQ_REMOVE(&info.list, elm, entry);
-		parent = elm->chain;
-		sync_tid = elm->sync_tid;
-		free(elm, M_HAMMER2, 0);
+	/*
+	 * Help with the deferred subtrees, then wait for the helpers.
+	 */
+	hammer2_recovery_worker(&info);
 
-		hammer2_chain_lock(parent, HAMMER2_RESOLVE_ALWAYS |
-					   HAMMER2_RESOLVE_NOREF);
-		error = hammer2_recovery_scan(&trans, hmp, parent,
-					      &info, sync_tid);
-		hammer2_chain_unlock(parent);
-		if (error)
-			cumulative_error = error;
+	mtx_enter(&info.list_mtx);
+	while (info.nthreads)
+		msleep(&info.nthreads, &info.list_mtx, PRIBIO, "h2recx", 0);
+	mtx_leave(&info.list_mtx);
+
+	return (info.error);
+}
+
+/*
+ * Pull deferred subtrees off the list until the list is empty and no
+ * worker is still scanning (and thus able to defer more).
+ */
+static
+void
+hammer2_recovery_worker(struct hammer2_recovery_info *info)
+{
+	hammer2_mount_t *hmp = info->hmp;
+	hammer2_trans_t trans;
+	struct hammer2_recovery_elm *elm;
+	hammer2_chain_t *parent;
+	hammer2_tid_t sync_tid;
+	int error;
+
+	hammer2_trans_init(&trans, hmp->spmp, 0);
+
+	mtx_enter(&info->list_mtx);
+	for (;;) {
+		if ((elm = TAILQ_FIRST(&info->list)) != NULL) {
+			TAILQ_REMOVE(&info->list, elm, entry);
+			++info->active;
+			mtx_leave(&info->list_mtx);
+
+			parent = elm->chain;
+			sync_tid = elm->sync_tid;
+			free(elm, M_HAMMER2, 0);
+
+			hammer2_chain_lock(parent, HAMMER2_RESOLVE_ALWAYS |
+						   HAMMER2_RESOLVE_NOREF);
+			error = hammer2_recovery_scan(&trans, hmp, parent,
+						      info, sync_tid, 0);
+			hammer2_chain_unlock(parent);
+
+			mtx_enter(&info->list_mtx);
+			if (error)
+				info->error = error;
+			--info->active;
+			continue;
+		}
+		if (info->active == 0)
+			break;
+		++info->idle;
+		msleep(info, &info->list_mtx, PRIBIO, "h2recw", 0);
+		--info->idle;
 	}
+	wakeup(info);
+	mtx_leave(&info->list_mtx);
+
 	hammer2_trans_done(&trans);
+}
 
-	return cumulative_error;
+static
+void
+hammer2_recovery_thread(void *arg)
+{
+	struct hammer2_recovery_info *info = arg;
+
+	hammer2_recovery_worker(info);
+
+	mtx_enter(&info->list_mtx);
+	if (--info->nthreads == 0)
+		wakeup(&info->nthreads);
+	mtx_leave(&info->list_mtx);
+	kthread_exit(0);
+}
+
+static
+void
+hammer2_recovery_racb(hammer2_io_t *dio, hammer2_cluster_t *cluster,
+		      hammer2_chain_t *chain, void *arg_p, off_t arg_o)
+{
+	/* read-ahead only, the dio stays cached */
+}
+
+/*
+ * Issue read-ahead for the inode and indirect blocks under parent which
+ * the scan will descend into.  parent's data must be resolved.
+ */
+static
+void
+hammer2_recovery_readahead(hammer2_mount_t *hmp, hammer2_chain_t *parent,
+			   hammer2_tid_t sync_tid)
+{
+	hammer2_blockref_t *base;
+	hammer2_blockref_t *bref;
+	int count;
+	int radix;
+	int i;
+
+	switch(parent->bref.type) {
+	case HAMMER2_BREF_TYPE_VOLUME:
+		base = &hmp->voldata.sroot_blockset.blockref[0];
+		count = HAMMER2_SET_COUNT;
+		break;
+	case HAMMER2_BREF_TYPE_INODE:
+		base = &parent->data->ipdata.u.blockset.blockref[0];
+		count = HAMMER2_SET_COUNT;
+		break;
+	case HAMMER2_BREF_TYPE_INDIRECT:
+		if (parent->flags & HAMMER2_CHAIN_INITIAL)
+			return;
+		base = &parent->data->npdata[0];
+		count = parent->bytes / sizeof(hammer2_blockref_t);
+		break;
+	default:
+		return;
+	}
+
+	for (i = 0; i < count; ++i) {
+		bref = &base[i];
+		if (bref->type != HAMMER2_BREF_TYPE_INODE &&
+		    bref->type != HAMMER2_BREF_TYPE_INDIRECT) {
+			continue;
+		}
+		if (bref->mirror_tid < sync_tid)
+			continue;
+		radix = (int)(bref->data_off & HAMMER2_OFF_MASK_RADIX);
+		if (radix == 0)
+			continue;
+		hammer2_io_breadcb(hmp, bref->data_off, 1 << radix,
+				   hammer2_recovery_racb, NULL, NULL, NULL, 0);
+	}
 }
 
 static
@@ -2237,7 +3021,7 @@ int
 hammer2_recovery_scan(hammer2_trans_t *trans, hammer2_mount_t *hmp,
 		      hammer2_chain_t *parent,
 		      struct hammer2_recovery_info *info,
-		      hammer2_tid_t sync_tid)
+		      hammer2_tid_t sync_tid, int depth)
 {
 	hammer2_chain_t *chain;
 	int cache_index;
@@ -2259,6 +3043,7 @@ hammer2_recovery_scan(hammer2_trans_t *trans, hammer2_mount_t *hmp,
 	switch(parent->bref.type) {
 	case HAMMER2_BREF_TYPE_VOLUME:
 		/* data already instantiated */
+		hammer2_recovery_readahead(hmp, parent, sync_tid);
 		break;
 	case HAMMER2_BREF_TYPE_INODE:
 		/*
@@ -2272,10 +3057,11 @@ hammer2_recovery_scan(hammer2_trans_t *trans, hammer2_mount_t *hmp,
 			return 0;
 		}
 		if ((parent->data->ipdata.op_flags & HAMMER2_OPFLAG_PFSROOT) &&
-		    info->depth != 0) {
+		    depth != 0) {
 			pfs_boundary = 1;
 			sync_tid = parent->bref.mirror_tid - 1;
 		}
+		hammer2_recovery_readahead(hmp, parent, sync_tid);
 		hammer2_chain_unlock(parent);
 		break;
 	case HAMMER2_BREF_TYPE_INDIRECT:
@@ -2283,6 +3069,7 @@ hammer2_recovery_scan(hammer2_trans_t *trans, hammer2_mount_t *hmp,
 		 * Must instantiate data for recursion
 		 */
 		hammer2_chain_lock(parent, HAMMER2_RESOLVE_ALWAYS);
+		hammer2_recovery_readahead(hmp, parent, sync_tid);
 		hammer2_chain_unlock(parent);
 		break;
 	case HAMMER2_BREF_TYPE_DATA:
@@ -2297,17 +3084,21 @@ hammer2_recovery_scan(hammer2_trans_t *trans, hammer2_mount_t *hmp,
 	}
 
 	/*
-	 * Defer operation if depth limit reached or if we are crossing a
-	 * PFS boundary.
+	 * Defer operation if depth limit reached, if we are crossing a
+	 * PFS boundary, or if another worker is idle.
 	 */
-	if (info->depth >= HAMMER2_RECOVERY_MAXDEPTH || pfs_boundary) {
+	if (depth >= HAMMER2_RECOVERY_MAXDEPTH || pfs_boundary ||
+	    (depth != 0 && info->idle)) {
 		struct hammer2_recovery_elm *elm;
 
 		elm = malloc(sizeof(*elm), M_HAMMER2, M_ZERO | M_WAITOK);
 		elm->chain = parent;
 		elm->sync_tid = sync_tid;
 		hammer2_chain_ref(parent);
+		mtx_enter(&info->list_mtx);
 		TAILQ_INSERT_TAIL(&info->list, elm, entry);
+		wakeup_one(info);
+		mtx_leave(&info->list_mtx);
 		/* unlocked by caller */
 
 		return(0);
@@ -2325,10 +3116,9 @@ hammer2_recovery_scan(hammer2_trans_t *trans, hammer2_mount_t *hmp,
 	while (chain) {
 		atomic_set_int(&chain->flags, HAMMER2_CHAIN_RELEASE);
 		if (chain->bref.mirror_tid >= sync_tid) {
-			++info->depth;
 			error = hammer2_recovery_scan(trans, hmp, chain,
-						      info, sync_tid);
-			--info->depth;
+						      info, sync_tid,
+						      depth + 1);
 			if (error)
 				cumulative_error = error;
 		}
@@ -2511,6 +3301,15 @@ hammer2_vfs_sync(struct mount *mp, int waitfor)
 			chain = &hmp->fchain;
 			hammer2_flush(&info.trans, chain);
 			KKASSERT(chain == &hmp->fchain);
+
+			/*
+			 * Fold the per-cpu allocator_free deltas into voldata
+			 * only now, the fchain flush allocates (COWs) freemap
+			 * blocks itself.  fchain is still locked so the sum
+			 * matches the freemap just flushed, and the vchain
+			 * flush below copies it to volsync.
+			 */
+			hammer2_freemap_sync(hmp);
 		}
 		hammer2_chain_unlock(&hmp->fchain);
 		hammer2_chain_unlock(&hmp->vchain);
@@ -2595,6 +3394,13 @@ hammer2_vfs_sync(struct mount *mp, int waitfor)
 			bcopy(&hmp->volsync, bp->b_data, HAMMER2_PBUFSIZE);
 			bawrite(bp);
 			hmp->volhdrno = i;
+
+			/*
+			 * fsync log records are reused once covered by two
+			 * volume headers (see hammer2_fsynclog.c).
+			 */
+			hmp->fsynclog_base = hmp->fsynclog_hdr;
+			hmp->fsynclog_hdr = hmp->volsync.fsynclog_seq;
 		}
 		if (error)
 			total_error = error;
@@ -2768,7 +3574,15 @@ hammer2_install_volume_header(hammer2_mount_t *hmp)
 		brelse(bp);
 		bp = NULL;
 	}
-	if (valid) {
+	if (valid && (hmp->voldata.flags & ~HAMMER2_VOLF_SUPPORTED)) {
+		/*
+		 * Unknown features may change the meaning of on-media
+		 * fields, e.g. the blockref psize for HAMMER2_VOLF_PACKED.
+		 */
+		error = EINVAL;
+		printf("hammer2: unsupported volume features %08x\n",
+			hmp->voldata.flags & ~HAMMER2_VOLF_SUPPORTED);
+	} else if (valid) {
 		hmp->volsync = hmp->voldata;
 		error = 0;
 		if (error_reported || bootverbose || 1) { /* 1/DEBUG */
@@ -3073,9 +3887,31 @@ hammer2_lwinprog_wait(hammer2_pfsmount_t *pmp)
 	}
 }
 
+/*
+ * Dirty chain limit for a PFS.
+ */
+static uint32_t
+hammer2_pfs_memory_limit(hammer2_pfsmount_t *pmp)
+{
+	uint32_t limit;
+
+	limit = pmp->mp->mnt_nvnodelistsize / 10;
+	if (limit < hammer2_limit_dirty_chains)
+		limit = hammer2_limit_dirty_chains;
+	if (limit < 1000)
+		limit = 1000;
+	return limit;
+}
+
 /*
  * Manage excessive memory resource use for chain and related
  * structures.
+ *
+ * Past hammer2_dirty_lowat percent of the limit the PFS's background
+ * flusher is kicked.  Past hammer2_dirty_throttle percent the caller is
+ * delayed in proportion to how far the dirty count is into the remaining
+ * range, up to 1/10 second at the limit, so writers slow down smoothly
+ * instead of running into the hard stall at the limit.
  */
 void
 hammer2_pfs_memory_wait(hammer2_pfsmount_t *pmp)
@@ -3083,6 +3919,8 @@ hammer2_pfs_memory_wait(hammer2_pfsmount_t *pmp)
 	uint32_t waiting;
 	uint32_t count;
 	uint32_t limit;
+	uint32_t start;
+	int delay;
 #if 0
 	static int zzticks;
 #endif
@@ -3095,12 +3933,7 @@ hammer2_pfs_memory_wait(hammer2_pfsmount_t *pmp)
 		waiting = pmp->inmem_dirty_chains;
 		cpu_ccfence();
 		count = waiting & HAMMER2_DIRTYCHAIN_MASK;
-
-		limit = pmp->mp->mnt_nvnodelistsize / 10;
-		if (limit < hammer2_limit_dirty_chains)
-			limit = hammer2_limit_dirty_chains;
-		if (limit < 1000)
-			limit = 1000;
+		limit = hammer2_pfs_memory_limit(pmp);
 
 #if 0
 		if ((int)(ticks - zzticks) > hz) {
@@ -3118,7 +3951,11 @@ hammer2_pfs_memory_wait(hammer2_pfsmount_t *pmp)
 			if (atomic_cmpset_int(&pmp->inmem_dirty_chains,
 					       waiting,
 				       waiting | HAMMER2_DIRTYCHAIN_WAITING)) {
-				speedup_syncer(); // XX ?? pmp->mp);
+				++hammer2_throttle_stalls;
+				if (pmp->bgflush_td)
+					wakeup(&pmp->bgflush_td);
+				else
+					speedup_syncer(); // XX ?? pmp->mp);
 				tsleep(&pmp->inmem_dirty_chains, PINTERLOCKED,
 				       "chnmem", hz);
 			}
@@ -3128,12 +3965,220 @@ hammer2_pfs_memory_wait(hammer2_pfsmount_t *pmp)
 		/*
 		 * Try to start an early flush before we are forced to block.
 		 */
-		if (count > limit * 7 / 10)
-			speedup_syncer(); // XX ?? pmp->mp);
+		if (count > (uint64_t)limit * hammer2_dirty_lowat / 100) {
+			if (pmp->bgflush_td == NULL)
+				speedup_syncer(); // XX ?? pmp->mp);
+			else if (pmp->bgflush_active == 0)
+				wakeup(&pmp->bgflush_td);
+		}
+
+		/*
+		 * Proportional throttle.  Delays below one tick round
+		 * down to none.
+		 */
+		start = (uint64_t)limit * hammer2_dirty_throttle / 100;
+		if (count > start && start < limit) {
+			delay = (int)((uint64_t)(count - start) * (hz / 10) /
+				      (limit - start));
+			if (delay > 0) {
+				++hammer2_throttle_count;
+				hammer2_throttle_ticks += delay;
+				tsleep(&pmp->inmem_dirty_chains, 0,
+				       "h2thrtl", delay);
+			}
+		}
 		break;
 	}
 }
 
+/*
+ * Start the background flusher for a PFS mount.  It flushes batches of
+ * modified inodes whenever the dirty chain count is past
+ * hammer2_dirty_lowat percent of the limit, so frontends rarely reach the
+ * throttle.
+ */
+void
+hammer2_bgflush_init(hammer2_pfsmount_t *pmp)
+{
+	pmp->bgflush_stop = 0;
+	if (kthread_create(hammer2_bgflush_thread, pmp, &pmp->bgflush_td,
+			   "h2bgfl")) {
+		printf("hammer2: unable to start background flusher\n");
+		pmp->bgflush_td = NULL;
+	}
+}
+
+/*
+ * Stop the background flusher, waits for an in-progress flush.
+ */
+void
+hammer2_bgflush_uninit(hammer2_pfsmount_t *pmp)
+{
+	pmp->bgflush_stop = 1;
+	while (pmp->bgflush_td) {
+		wakeup(&pmp->bgflush_td);
+		tsleep(&pmp->bgflush_stop, 0, "h2bgst", hz);
+	}
+}
+
+/*
+ * The background flusher works in batches of at most hammer2_bgflush_batch
+ * modified inodes, flushing each inode's subtree.  This cleans the file
+ * data and indirect chains, which make up most of the dirty count, without
+ * touching the volume header.  The parent directories, the freemap and the
+ * header are left to a full sync, which the flusher runs at most once per
+ * hammer2_bgflush_interval seconds.
+ */
+static
+void
+hammer2_bgflush_thread(void *arg)
+{
+	hammer2_pfsmount_t *pmp = arg;
+	struct vnode **vps;
+	uint32_t count;
+	int lastsync;
+	int batch;
+	int again;
+	int n;
+
+	batch = hammer2_bgflush_batch;
+	if (batch < 1)
+		batch = 1;
+	vps = mallocarray(batch, sizeof(*vps), M_HAMMER2, M_WAITOK);
+
+	lastsync = ticks - hammer2_bgflush_interval * hz;
+	again = 0;
+	while (pmp->bgflush_stop == 0) {
+		if (again == 0)
+			tsleep(&pmp->bgflush_td, 0, "h2bgfl", hz);
+		if (pmp->bgflush_stop)
+			break;
+		count = pmp->inmem_dirty_chains & HAMMER2_DIRTYCHAIN_MASK;
+		if (count <= (uint64_t)hammer2_pfs_memory_limit(pmp) *
+			     hammer2_dirty_lowat / 100) {
+			again = 0;
+			continue;
+		}
+		pmp->bgflush_active = 1;
+		n = hammer2_bgflush_inodes(pmp, vps, batch);
+		if (n)
+			++hammer2_bgflush_count;
+
+		/*
+		 * Whatever the batches cannot reach is left to a full
+		 * sync, rate limited so the volume header is written at
+		 * most once per interval.
+		 */
+		count = pmp->inmem_dirty_chains & HAMMER2_DIRTYCHAIN_MASK;
+		if (count > (uint64_t)hammer2_pfs_memory_limit(pmp) *
+			    hammer2_dirty_lowat / 100 &&
+		    (int)(ticks - lastsync) >= hammer2_bgflush_interval * hz) {
+			hammer2_vfs_sync(pmp->mp, MNT_NOWAIT);
+			lastsync = ticks;
+			++hammer2_bgflush_syncs;
+			count = pmp->inmem_dirty_chains &
+				HAMMER2_DIRTYCHAIN_MASK;
+		}
+		pmp->bgflush_active = 0;
+
+		/*
+		 * Go again right away while batches make progress and the
+		 * count is still past the watermark.
+		 */
+		again = (n && count > (uint64_t)hammer2_pfs_memory_limit(pmp) *
+				      hammer2_dirty_lowat / 100);
+	}
+	free(vps, M_HAMMER2, batch * sizeof(*vps));
+	pmp->bgflush_td = NULL;
+	wakeup(&pmp->bgflush_stop);
+	kthread_exit(0);
+}
+
+struct hammer2_bgflush_info {
+	struct vnode	**vps;
+	int		count;
+	int		batch;
+};
+
+/*
+ * Collect referenced vnodes whose inodes have modified chains, stops the
+ * vnode scan once the batch is full.  The vnode is referenced before its
+ * inode is looked at so a concurrent reclaim cannot free the inode, vnodes
+ * being reclaimed are skipped.
+ */
+static
+int
+hammer2_bgflush_scan(struct vnode *vp, void *data)
+{
+	struct hammer2_bgflush_info *info = data;
+	hammer2_inode_t *ip;
+
+	if (vp->v_type == VNON || vp->v_type == VBAD)
+		return (0);
+	if (vget(vp, LK_NOWAIT, NULL))
+		return (0);
+	ip = VTOI(vp);
+	if (ip == NULL || (ip->flags & HAMMER2_INODE_MODIFIED) == 0) {
+		vrele(vp);
+		return (0);
+	}
+	info->vps[info->count++] = vp;
+
+	return (info->count == info->batch);
+}
+
+/*
+ * Flush the subtrees of up to batch modified inodes in one background
+ * flush transaction.  Each inode is held locked while its subtree is
+ * flushed, so frontend transactions are allowed to run concurrently
+ * and are not held up for the whole batch.  Returns the number of
+ * inodes flushed.
+ */
+static
+int
+hammer2_bgflush_inodes(hammer2_pfsmount_t *pmp, struct vnode **vps,
+		       int batch)
+{
+	struct hammer2_bgflush_info info;
+	hammer2_trans_t trans;
+	hammer2_cluster_t *cluster;
+	hammer2_chain_t *chain;
+	hammer2_inode_t *ip;
+	int i;
+	int j;
+
+	info.vps = vps;
+	info.count = 0;
+	info.batch = batch;
+	vfs_mount_foreach_vnode(pmp->mp, hammer2_bgflush_scan, &info);
+	if (info.count == 0)
+		return (0);
+
+	/*
+	 * PREFLUSH stays set, buffer cache transactions from the write
+	 * threads serialize against the flush on the inode lock.
+	 */
+	hammer2_trans_init(&trans, pmp, HAMMER2_TRANS_ISFLUSH |
+					HAMMER2_TRANS_PREFLUSH |
+					HAMMER2_TRANS_BACKGROUND);
+	for (i = 0; i < info.count; ++i) {
+		ip = VTOI(vps[i]);
+		cluster = hammer2_inode_lock_ex(ip);
+		atomic_clear_int(&ip->flags, HAMMER2_INODE_MODIFIED);
+		for (j = 0; j < cluster->nchains; ++j) {
+			chain = cluster->array[j];
+			if (chain)
+				hammer2_flush(&trans, chain);
+		}
+		hammer2_inode_unlock_ex(ip, cluster);
+	}
+	hammer2_trans_done(&trans);
+	for (i = 0; i < info.count; ++i)
+		vrele(vps[i]);
+
+	return (info.count);
+}
+
 void
 hammer2_pfs_memory_inc(hammer2_pfsmount_t *pmp)
 {
@@ -55,6 +55,8 @@
 #include <sys/event.h>
 #include <ntfs/ntfs.h>
 #include <lib/libz/zlib.h>
+#define ZSTD_STATIC_LINKING_ONLY
+#include <lib/libzstd/zstd.h>
 #include <machine/mplock.h>
 
 #include <sys/syslog.h>
@@ -82,7 +84,9 @@ struct thread *curthread;
 #define VOP_UNLOCK(a, b) vn_unlock((a))
 
 static int hammer2_read_file(hammer2_inode_t *ip, struct uio *uio,
-				int seqcount);
+				int seqcount, int direct);
+static int hammer2_read_direct(hammer2_inode_t *ip, struct uio *uio,
+				hammer2_key_t lbase, int n, int *errorp);
 static int hammer2_write_file(hammer2_inode_t *ip, struct uio *uio,
 				int ioflag, int seqcount);
 static void hammer2_extend_file(hammer2_inode_t *ip, hammer2_key_t nsize);
@@ -101,10 +105,9 @@ int vop_stdmountctl(struct vop_mountctl_args *ap);
 void cache_setvp(struct nchandle *nch, struct vnode *vp);
 //static void _cache_setvp(struct mount *mp, struct namecache *ncp, struct vnode *vp);
 
-//struct objcache *cache_buffer_read;
-
-struct vnode *cache_buffer_read;
-struct objcache *cache_buffer_write;
+struct pool cache_buffer_read;
+struct pool cache_buffer_write;
+struct pool cache_zstd_dctx;
 struct lwp;
 
 #define B_HEAVY         0x00100000      /* Heavy-weight buffer */
@@ -718,7 +721,7 @@ hammer2_decompress_LZ4_callback(const char *data, u_int bytes, struct bioh2 *bio
 	compressed_size = *(const int *)data;
 	KKASSERT(compressed_size <= bytes - sizeof(int));
 
-	// compressed_buffer = cache_lookup((struct vnode*)cache_buffer_read, NULL, NULL);  XX fix me
+	compressed_buffer = pool_get(&cache_buffer_read, PR_WAITOK);
 	result = LZ4_decompress_safe(__DECONST(char *, &data[sizeof(int)]),
 				     compressed_buffer,
 				     compressed_size,
@@ -734,11 +737,71 @@ hammer2_decompress_LZ4_callback(const char *data, u_int bytes, struct bioh2 *bio
 	bcopy(compressed_buffer, bp->b_data, bp->b_bufsize);
 	if (result < bp->b_bufsize)
 		bzero(bp->b_data + result, bp->b_bufsize - result);
-	// XXX objcache_put(cache_buffer_read, compressed_buffer);
+	pool_put(&cache_buffer_read, compressed_buffer);
 	bp->b_resid = 0;
 	bp->b_flags |= B_AGE;
 }
 
+/*
+ * Inflate streams are kept for reuse once set up, decompression runs in
+ * whichever thread completes the read so they are handed out from a free
+ * list and only need an inflateReset() per block.
+ */
+struct hammer2_inflate {
+	SLIST_ENTRY(hammer2_inflate) entry;
+	z_stream	strm;
+};
+
+static SLIST_HEAD(, hammer2_inflate) hammer2_inflate_free =
+	SLIST_HEAD_INITIALIZER(hammer2_inflate_free);
+static struct mutex hammer2_inflate_mtx = MUTEX_INITIALIZER(IPL_NONE);
+
+static
+struct hammer2_inflate *
+hammer2_inflate_get(void)
+{
+	struct hammer2_inflate *zi;
+
+	mtx_enter(&hammer2_inflate_mtx);
+	zi = SLIST_FIRST(&hammer2_inflate_free);
+	if (zi)
+		SLIST_REMOVE_HEAD(&hammer2_inflate_free, entry);
+	mtx_leave(&hammer2_inflate_mtx);
+
+	if (zi) {
+		inflateReset(&zi->strm);
+		return (zi);
+	}
+	zi = malloc(sizeof(*zi), M_HAMMER2, M_WAITOK | M_ZERO);
+	if (inflateInit(&zi->strm) != Z_OK) {
+		printf("HAMMER2 ZLIB: Fatal error in inflateInit.\n");
+		free(zi, M_HAMMER2, sizeof(*zi));
+		return (NULL);
+	}
+	return (zi);
+}
+
+static
+void
+hammer2_inflate_put(struct hammer2_inflate *zi)
+{
+	mtx_enter(&hammer2_inflate_mtx);
+	SLIST_INSERT_HEAD(&hammer2_inflate_free, zi, entry);
+	mtx_leave(&hammer2_inflate_mtx);
+}
+
+void
+hammer2_decompress_uninit(void)
+{
+	struct hammer2_inflate *zi;
+
+	while ((zi = SLIST_FIRST(&hammer2_inflate_free)) != NULL) {
+		SLIST_REMOVE_HEAD(&hammer2_inflate_free, entry);
+		inflateEnd(&zi->strm);
+		free(zi, M_HAMMER2, sizeof(*zi));
+	}
+}
+
 /*
  * Callback used in read path in case that a block is compressed with ZLIB.
  * It is almost identical to LZ4 callback, so in theory they can be unified,
@@ -749,41 +812,84 @@ void
 hammer2_decompress_ZLIB_callback(const char *data, u_int bytes, struct bioh2 *bio)
 {
 	struct buf *bp;
+	struct hammer2_inflate *zi;
+	z_stream *strm_decompress;
 	char *compressed_buffer;
-	z_stream strm_decompress;
 	int result;
 	int ret;
 
 	bp = bio->bio_buf;
 
 	KKASSERT(bp->b_bufsize <= HAMMER2_PBUFSIZE);
-	strm_decompress.avail_in = 0;
-	strm_decompress.next_in = Z_NULL;
+	compressed_buffer = pool_get(&cache_buffer_read, PR_WAITOK);
 
-	ret = inflateInit(&strm_decompress);
+	zi = hammer2_inflate_get();
+	if (zi == NULL) {
+		bzero(compressed_buffer, bp->b_bufsize);
+		result = 0;
+	} else {
+		strm_decompress = &zi->strm;
+		strm_decompress->next_in = __DECONST(char *, data);
+
+		/* XXX supply proper size, subset of device bp */
+		strm_decompress->avail_in = bytes;
+		strm_decompress->next_out = compressed_buffer;
+		strm_decompress->avail_out = bp->b_bufsize;
+
+		ret = inflate(strm_decompress, Z_FINISH);
+		if (ret != Z_STREAM_END) {
+			printf("HAMMER2 ZLIB: Fatar error during "
+				"decompression.\n");
+			bzero(compressed_buffer, bp->b_bufsize);
+		}
+		result = bp->b_bufsize - strm_decompress->avail_out;
+		hammer2_inflate_put(zi);
+	}
+	bcopy(compressed_buffer, bp->b_data, bp->b_bufsize);
+	if (result < bp->b_bufsize)
+		bzero(bp->b_data + result, bp->b_bufsize - result);
+	pool_put(&cache_buffer_read, compressed_buffer);
 
-	if (ret != Z_OK)
-		printf("HAMMER2 ZLIB: Fatal error in inflateInit.\n");
+	bp->b_resid = 0;
+	bp->b_flags |= B_AGE;
+}
 
-	// XXX compressed_buffer = objcache_get(cache_buffer_read, M_INTWAIT);
-	strm_decompress.next_in = __DECONST(char *, data);
+/*
+ * Callback used in read path in case that a block is compressed with ZSTD.
+ * The frame is followed by the zero-fill of the physical block, only the
+ * frame itself is handed to the decompressor.  ZSTD never writes past
+ * dstCapacity so it decompresses straight into the logical buffer.
+ */
+static
+void
+hammer2_decompress_ZSTD_callback(const char *data, u_int bytes, struct bioh2 *bio)
+{
+	struct buf *bp;
+	ZSTD_DCtx *dctx;
+	size_t csize;
+	size_t result;
 
-	/* XXX supply proper size, subset of device bp */
-	strm_decompress.avail_in = bytes;
-	strm_decompress.next_out = compressed_buffer;
-	strm_decompress.avail_out = bp->b_bufsize;
+	bp = bio->bio_buf;
 
-	ret = inflate(&strm_decompress, Z_FINISH);
-	if (ret != Z_STREAM_END) {
-		printf("HAMMER2 ZLIB: Fatar error during decompression.\n");
-		bzero(compressed_buffer, bp->b_bufsize);
+	KKASSERT(bp->b_bufsize <= HAMMER2_PBUFSIZE);
+	dctx = ZSTD_initStaticDCtx(pool_get(&cache_zstd_dctx, PR_WAITOK),
+				   cache_zstd_dctx.pr_size);
+
+	csize = ZSTD_findFrameCompressedSize(data, bytes);
+	if (ZSTD_isError(csize))
+		result = csize;
+	else
+		result = ZSTD_decompressDCtx(dctx, bp->b_data,
+					     bp->b_bufsize, data, csize);
+	if (ZSTD_isError(result)) {
+		printf("HAMMER2 ZSTD: Fatal error during decompression: %s\n",
+			ZSTD_getErrorName(result));
+		result = 0;
 	}
-	bcopy(compressed_buffer, bp->b_data, bp->b_bufsize);
-	result = bp->b_bufsize - strm_decompress.avail_out;
+	KKASSERT(result <= bp->b_bufsize);
 	if (result < bp->b_bufsize)
-		bzero(bp->b_data + result, strm_decompress.avail_out);
-	// XXX objcache_put(cache_buffer_read, compressed_buffer);
-	ret = inflateEnd(&strm_decompress);
+		bzero(bp->b_data + result, bp->b_bufsize - result);
+	pool_put(&cache_zstd_dctx, dctx);
 
 	bp->b_resid = 0;
 	bp->b_flags |= B_AGE;
@@ -943,6 +1049,7 @@ hammer2_vop_fsync(struct vop_fsync_args *ap)
 	hammer2_trans_t trans;
 	hammer2_cluster_t *cluster;
 	struct vnode *vp;
+	int error;
 
 	LOCKSTART;
 	vp = ap->a_vp;
@@ -953,8 +1060,16 @@ hammer2_vop_fsync(struct vop_fsync_args *ap)
 	hammer2_trans_init(&trans, ip->pmp, HAMMER2_TRANS_ISFLUSH);
 	vfsync(vp, ap->a_waitfor, 1, NULL, NULL);
 #endif
+	/*
+	 * A waiting fsync must push the vnode's delayed-write buffers
+	 * through strategy before the inode is logged or flushed,
+	 * otherwise the blockset would not cover the data just written.
+	 */
+	if (ap->a_waitfor == MNT_WAIT &&
+	    (vp->v_mount->mnt_flag & MNT_RDONLY) == 0) {
+		vflushbuf(vp, 1);
+	}
 	hammer2_trans_init(&trans, ip->pmp, 0);
-	// XX vfsync(vp, ap->a_waitfor, 1, NULL, NULL);
 
 	/*
 	 * Calling chain_flush here creates a lot of duplicative
@@ -981,8 +1096,22 @@ hammer2_vop_fsync(struct vop_fsync_args *ap)
 	hammer2_inode_unlock_ex(ip, cluster);
 	hammer2_trans_done(&trans);
 
+	/*
+	 * A waiting fsync must make the inode durable.  The fsync log
+	 * only has to write out the inode's own subtree, fall back to a
+	 * full sync when it cannot be used.
+	 */
+	error = 0;
+	if (ap->a_waitfor == MNT_WAIT &&
+	    (vp->v_mount->mnt_flag & MNT_RDONLY) == 0) {
+		if (hammer2_fsynclog_enable == 0 ||
+		    hammer2_fsynclog_fsync(ip)) {
+			error = hammer2_vfs_sync(vp->v_mount, MNT_WAIT);
+		}
+	}
+
 	LOCKSTOP;
-	return (0);
+	return (error);
 }
 
 static
@@ -1453,7 +1582,7 @@ hammer2_vop_readlink(struct vop_readlink_args *ap)
 		return (EINVAL);
 	ip = VTOI(vp);
 
-	error = hammer2_read_file(ip, ap->a_uio, 0);
+	error = hammer2_read_file(ip, ap->a_uio, 0, 0);
 	return (error);
 }
 
@@ -1485,7 +1614,9 @@ hammer2_vop_read(struct vop_read_args *ap)
 	seqcount = ap->a_ioflag >> 16;
 	bigread = (uio->uio_resid > 100 * 1024 * 1024);
 
-	error = hammer2_read_file(ip, uio, seqcount);
+	error = hammer2_read_file(ip, uio, seqcount,
+				  (ap->a_ioflag & IO_DIRECT) ||
+				  (bigread && hammer2_direct_read));
 	return (error);
 }
 
@@ -1537,7 +1668,9 @@ hammer2_vop_write(struct vop_write_args *ap)
 	/*
 	 * The transaction interlocks against flushes initiations
 	 * (note: but will run concurrently with the actual flush).
+	 * Writers are throttled against the dirty chain limit first.
 	 */
+	hammer2_pfs_memory_wait(ip->pmp);
 	hammer2_trans_init(&trans, ip->pmp, 0);
 	error = hammer2_write_file(ip, uio, ap->a_ioflag, seqcount);
 	hammer2_trans_done(&trans);
@@ -1549,11 +1682,15 @@ hammer2_vop_write(struct vop_write_args *ap)
  * Perform read operations on a file or symlink given an UNLOCKED
  * inode and uio.
  *
+ * If (direct) is set full uncompressed blocks are read straight from
+ * the media when possible, see hammer2_read_direct().
+ *
  * The passed ip is not locked.
  */
 static
 int
-hammer2_read_file(hammer2_inode_t *ip, struct uio *uio, int seqcount)
+hammer2_read_file(hammer2_inode_t *ip, struct uio *uio, int seqcount,
+		  int direct)
 {
 	hammer2_off_t size;
 	struct buf *bp;
@@ -1578,6 +1715,18 @@ hammer2_read_file(hammer2_inode_t *ip, struct uio *uio, int seqcount)
 		lblksize = hammer2_calc_logical(ip, uio->uio_offset,
 						&lbase, &leof);
 
+		if (direct && lblksize == HAMMER2_PBUFSIZE &&
+		    uio->uio_offset == lbase &&
+		    uio->uio_resid >= lblksize &&
+		    size - lbase >= lblksize) {
+			if (hammer2_read_direct(ip, uio, lbase, lblksize,
+						&error)) {
+				if (error)
+					break;
+				continue;
+			}
+		}
+
 		error = cluster_read(ip->vp, leof, lbase, lblksize,
 				     uio->uio_resid, seqcount * BKVASIZE,
 				     &bp);
@@ -1597,6 +1746,83 @@ hammer2_read_file(hammer2_inode_t *ip, struct uio *uio, int seqcount)
 	return (error);
 }
 
+/*
+ * Read a full uncompressed block directly from the media into the uio,
+ * bypassing both the logical buffer and the hammer2_io device buffer
+ * tracking.  The device buffer is thrown away afterwards so the data
+ * is neither copied nor cached twice.
+ *
+ * Returns 0 without doing anything if the block must go through the
+ * buffer cache: holes, embedded or compressed data, partial blocks, and
+ * any block whose current contents may not be on the media yet (a
+ * logical or device buffer is cached, or the chain is modified).
+ * Otherwise returns 1 with *errorp set.
+ *
+ * Blocks are never overwritten in place, so once the chain has been
+ * looked up the media copy stays valid for the duration of the read.
+ *
+ * Each block is read synchronously with no read-ahead, which loses to
+ * the buffer cache path on sequential reads, so large reads only come
+ * here when hammer2_direct_read is set (off by default) or IO_DIRECT
+ * was requested.
+ */
+static
+int
+hammer2_read_direct(hammer2_inode_t *ip, struct uio *uio,
+		    hammer2_key_t lbase, int n, int *errorp)
+{
+	hammer2_cluster_t *cparent;
+	hammer2_cluster_t *cluster;
+	hammer2_chain_t *chain;
+	hammer2_mount_t *hmp;
+	hammer2_key_t key_dummy;
+	hammer2_off_t pbase;
+	struct buf *bp;
+	int ddflag;
+	int error;
+
+	if (incore(ip->vp, lbase))
+		return (0);
+
+	cparent = hammer2_inode_lock_sh(ip);
+	cluster = hammer2_cluster_lookup(cparent, &key_dummy,
+				       lbase, lbase,
+				       HAMMER2_LOOKUP_NODATA |
+				       HAMMER2_LOOKUP_SHARED,
+				       &ddflag);
+	hammer2_inode_unlock_sh(ip, cparent);
+	if (cluster == NULL)
+		return (0);
+
+	chain = cluster->focus;
+	hmp = chain->hmp;
+	pbase = chain->bref.data_off & ~HAMMER2_OFF_MASK_RADIX;
+	if (chain->bref.type != HAMMER2_BREF_TYPE_DATA ||
+	    HAMMER2_DEC_COMP(chain->bref.methods) != HAMMER2_COMP_NONE ||
+	    chain->bytes != n || hammer2_chain_psize(chain) != (size_t)n ||
+	    (chain->flags & HAMMER2_CHAIN_MODIFIED) ||
+	    incore(hmp->devvp, pbase)) {
+		hammer2_cluster_unlock(cluster);
+		return (0);
+	}
+
+	hammer2_adjreadcounter(&chain->bref, chain->bytes);
+	error = bread(hmp->devvp, pbase, n, &bp);
+	if (error == 0 && hammer2_chain_testcheck(chain, bp->b_data) == 0) {
+		printf("hammer2: direct read check failed %016llx/%d\n",
+		       (long long)chain->bref.data_off, n);
+		error = EIO;
+	}
+	if (error == 0)
+		error = uiomove(bp->b_data, n, uio);
+	bp->b_flags |= B_INVAL | B_NOCACHE;
+	brelse(bp);
+	hammer2_cluster_unlock(cluster);
+	*errorp = error;
+
+	return (1);
+}
+
 /*
  * Write to the file represented by the inode via the logical buffer cache.
  * The inode may represent a regular file or a symlink.
@@ -2680,6 +2906,13 @@ static void hammer2_strategy_read_callback(hammer2_io_t *dio,
 				hammer2_cluster_t *cluster,
 				hammer2_chain_t *chain,
 				void *arg_p, off_t arg_o);
+static void hammer2_strategy_readahead(hammer2_inode_t *ip,
+				hammer2_cluster_t *cparent,
+				hammer2_key_t lbase);
+static void hammer2_strategy_racb(hammer2_io_t *dio,
+				hammer2_cluster_t *cluster,
+				hammer2_chain_t *chain,
+				void *arg_p, off_t arg_o);
 
 static
 int
@@ -2739,6 +2972,7 @@ hammer2_strategy_read(struct vop_strategy_args *ap)
 				       HAMMER2_LOOKUP_NODATA |
 				       HAMMER2_LOOKUP_SHARED,
 				       &ddflag);
+	hammer2_strategy_readahead(ip, cparent, lbase);
 	hammer2_inode_unlock_sh(ip, cparent);
 
 	/*
@@ -2767,6 +3001,95 @@ hammer2_strategy_read(struct vop_strategy_args *ap)
 	return(0);
 }
 
+/*
+ * Read-ahead for sequential strategy reads.  The blockrefs following
+ * lbase are looked up in the (already resident) parent blocks and their
+ * device buffers are read asynchronously in one batch, so read-ahead
+ * follows the actual physical layout even when compressed blocks are
+ * not contiguous on the media.
+ *
+ * The window starts at 4 blocks once a second sequential read is seen
+ * and doubles up to hammer2_readahead_max.  A new batch is issued when
+ * the reader gets within half a window of the end of the previous one.
+ * A non-sequential read collapses the window.  The per-inode state is
+ * updated without interlock, races only affect the heuristic.
+ *
+ * The caller holds the inode locked shared.
+ */
+static
+void
+hammer2_strategy_readahead(hammer2_inode_t *ip, hammer2_cluster_t *cparent,
+			   hammer2_key_t lbase)
+{
+	hammer2_cluster_t *cluster;
+	hammer2_chain_t *chain;
+	hammer2_key_t key_next;
+	hammer2_key_t key_beg;
+	hammer2_key_t key_end;
+	int window;
+	int ddflag;
+
+	if (lbase != ip->ra_next) {
+		ip->ra_next = lbase + HAMMER2_PBUFSIZE;
+		ip->ra_end = 0;
+		ip->ra_window = 0;
+		return;
+	}
+	ip->ra_next = lbase + HAMMER2_PBUFSIZE;
+
+	window = ip->ra_window;
+	if (window == 0)
+		window = 4;
+	if (ip->ra_end > lbase + (hammer2_key_t)window / 2 * HAMMER2_PBUFSIZE)
+		return;
+	if (ip->ra_window && window < hammer2_readahead_max)
+		window *= 2;
+	if (window > hammer2_readahead_max)
+		window = hammer2_readahead_max;
+	ip->ra_window = window;
+	if (window <= 0)
+		return;
+
+	key_beg = lbase + HAMMER2_PBUFSIZE;
+	if (key_beg < ip->ra_end)
+		key_beg = ip->ra_end;
+	key_end = lbase + (hammer2_key_t)window * HAMMER2_PBUFSIZE;
+	if (key_end > ip->size)
+		key_end = ip->size;
+	if (key_beg >= key_end)
+		return;
+	ip->ra_end = key_end;
+
+	cluster = hammer2_cluster_lookup(cparent, &key_next,
+					 key_beg, key_end - 1,
+					 HAMMER2_LOOKUP_NODATA |
+					 HAMMER2_LOOKUP_SHARED,
+					 &ddflag);
+	while (cluster) {
+		chain = cluster->focus;
+		if (chain->bref.type == HAMMER2_BREF_TYPE_DATA &&
+		    (chain->bref.data_off & HAMMER2_OFF_MASK_RADIX)) {
+			hammer2_adjreadcounter(&chain->bref, chain->bytes);
+			hammer2_io_breadcb(chain->hmp, chain->bref.data_off,
+					   chain->bytes,
+					   hammer2_strategy_racb,
+					   NULL, NULL, NULL, 0);
+		}
+		cluster = hammer2_cluster_next(cparent, cluster, &key_next,
+					       key_next, key_end - 1,
+					       HAMMER2_LOOKUP_NODATA |
+					       HAMMER2_LOOKUP_SHARED);
+	}
+}
+
+static
+void
+hammer2_strategy_racb(hammer2_io_t *dio, hammer2_cluster_t *cluster,
+		      hammer2_chain_t *chain, void *arg_p, off_t arg_o)
+{
+	/* read-ahead only, the dio stays cached */
+}
+
 /*
  * Read callback for block that is not compressed.
  */
@@ -2787,12 +3110,12 @@ hammer2_strategy_read_callback(hammer2_io_t *dio,
 	 * cluster index for iteration.
 	 */
 	if (dio) {
-		if (dio->bp->b_flags & B_ERROR) {
+		if (dio->error) {
 			i = (int)arg_o + 1;
 			if (i >= cluster->nchains) {
 				bp->b_flags |= B_ERROR;
-				bp->b_error = dio->bp->b_error;
-				biodone((struct buf *)&bio);
+				bp->b_error = dio->error;
+				biodone((struct buf *)bio);
 				hammer2_cluster_unlock(cluster);
 			} else {
 				chain = cluster->array[i];
@@ -2827,7 +3150,8 @@ hammer2_strategy_read_callback(hammer2_io_t *dio,
 		/*
 		 * Data is on-media, issue device I/O and copy.
 		 *
-		 * XXX direct-IO shortcut could go here XXX.
+		 * (Large direct reads of uncompressed blocks do not
+		 * come through here, see hammer2_read_direct()).
 		 */
 		switch (HAMMER2_DEC_COMP(chain->bref.methods)) {
 		case HAMMER2_COMP_LZ4:
@@ -2838,6 +3162,10 @@ hammer2_strategy_read_callback(hammer2_io_t *dio,
 			hammer2_decompress_ZLIB_callback(data, chain->bytes,
 							 bio);
 			break;
+		case HAMMER2_COMP_ZSTD:
+			hammer2_decompress_ZSTD_callback(data, chain->bytes,
+							 bio);
+			break;
 		case HAMMER2_COMP_NONE:
 			KKASSERT(chain->bytes <= bp->b_bcount);
 			bcopy(data, bp->b_data, chain->bytes);
@@ -2877,16 +3205,15 @@ hammer2_strategy_write(struct vop_strategy_args *ap)
 	ip = VTOI(ap->a_vp);
 	pmp = ip->pmp;
 	
+	/*
+	 * Hand the buffer to the write workers.  Any idle worker may pick
+	 * it up, so wake one up for every buffer queued.
+	 */
 	hammer2_lwinprog_ref(pmp);
-	mtx_enter((struct mutex *)&pmp->wthread_mtx);
-	if (TAILQ_EMPTY(&pmp->wthread_bioq.queue)) {
-		bioq_insert_tail(&pmp->wthread_bioq, ap->a_bio);
-		mtx_leave((struct mutex *)&pmp->wthread_mtx);
-		wakeup(&pmp->wthread_bioq);
-	} else {
-		bioq_insert_tail(&pmp->wthread_bioq, ap->a_bio);
-		mtx_leave((struct mutex *)&pmp->wthread_mtx);
-	}
+	mtx_enter(&pmp->wthread_mtx);
+	bioq_insert_tail(&pmp->wthread_bioq, ap->a_bio);
+	mtx_leave(&pmp->wthread_mtx);
+	wakeup_one(&pmp->wthread_bioq);
 	hammer2_lwinprog_wait(pmp);
 
 	return(0);
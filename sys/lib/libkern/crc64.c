@@ -0,0 +1,793 @@
+/*	$OpenBSD$	*/
+
+/*
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * CRC-64 using the ECMA-182 polynomial in reflected form
+ * (0xC96C5795D7870F42), with the crc pre- and post-inverted.  This is the
+ * same CRC-64 used by xz, check("123456789") == 0x995DC9BBDF1939FA.
+ *
+ * HAMMER2 uses it for the HAMMER2_CHECK_CRC64 block check method, which
+ * provides much stronger error detection than the 32-bit iscsi crc on
+ * large (64KB) blocks at a fraction of the cost of the SHA192 path.
+ *
+ * The block loop uses slicing-by-8.
+ */
+#ifdef _KERNEL
+#include <sys/param.h>
+#include <sys/systm.h>
+#else
+#include <sys/types.h>
+#endif
+
+#ifndef _KERNEL
+/* prototypes for the kernel are in <sys/systm.h> */
+uint64_t crc64(const void *buf, size_t size);
+uint64_t crc64_ext(const void *buf, size_t size, uint64_t ocrc);
+#endif
+
+/*
+ * Slicing-by-8 tables, crc64Table[k][i] is the crc of byte i followed by
+ * k zero bytes for the polynomial above.  They are generated and must
+ * not be edited by hand.
+ */
+static const uint64_t crc64Table[8][256] = {
+    {
+	0x0000000000000000ULL, 0xB32E4CBE03A75F6FULL, 0xF4843657A840A05BULL,
+	0x47AA7AE9ABE7FF34ULL, 0x7BD0C384FF8F5E33ULL, 0xC8FE8F3AFC28015CULL,
+	0x8F54F5D357CFFE68ULL, 0x3C7AB96D5468A107ULL, 0xF7A18709FF1EBC66ULL,
+	0x448FCBB7FCB9E309ULL, 0x0325B15E575E1C3DULL, 0xB00BFDE054F94352ULL,
+	0x8C71448D0091E255ULL, 0x3F5F08330336BD3AULL, 0x78F572DAA8D1420EULL,
+	0xCBDB3E64AB761D61ULL, 0x7D9BA13851336649ULL, 0xCEB5ED8652943926ULL,
+	0x891F976FF973C612ULL, 0x3A31DBD1FAD4997DULL, 0x064B62BCAEBC387AULL,
+	0xB5652E02AD1B6715ULL, 0xF2CF54EB06FC9821ULL, 0x41E11855055BC74EULL,
+	0x8A3A2631AE2DDA2FULL, 0x39146A8FAD8A8540ULL, 0x7EBE1066066D7A74ULL,
+	0xCD905CD805CA251BULL, 0xF1EAE5B551A2841CULL, 0x42C4A90B5205DB73ULL,
+	0x056ED3E2F9E22447ULL, 0xB6409F5CFA457B28ULL, 0xFB374270A266CC92ULL,
+	0x48190ECEA1C193FDULL, 0x0FB374270A266CC9ULL, 0xBC9D3899098133A6ULL,
+	0x80E781F45DE992A1ULL, 0x33C9CD4A5E4ECDCEULL, 0x7463B7A3F5A932FAULL,
+	0xC74DFB1DF60E6D95ULL, 0x0C96C5795D7870F4ULL, 0xBFB889C75EDF2F9BULL,
+	0xF812F32EF538D0AFULL, 0x4B3CBF90F69F8FC0ULL, 0x774606FDA2F72EC7ULL,
+	0xC4684A43A15071A8ULL, 0x83C230AA0AB78E9CULL, 0x30EC7C140910D1F3ULL,
+	0x86ACE348F355AADBULL, 0x3582AFF6F0F2F5B4ULL, 0x7228D51F5B150A80ULL,
+	0xC10699A158B255EFULL, 0xFD7C20CC0CDAF4E8ULL, 0x4E526C720F7DAB87ULL,
+	0x09F8169BA49A54B3ULL, 0xBAD65A25A73D0BDCULL, 0x710D64410C4B16BDULL,
+	0xC22328FF0FEC49D2ULL, 0x85895216A40BB6E6ULL, 0x36A71EA8A7ACE989ULL,
+	0x0ADDA7C5F3C4488EULL, 0xB9F3EB7BF06317E1ULL, 0xFE5991925B84E8D5ULL,
+	0x4D77DD2C5823B7BAULL, 0x64B62BCAEBC387A1ULL, 0xD7986774E864D8CEULL,
+	0x90321D9D438327FAULL, 0x231C512340247895ULL, 0x1F66E84E144CD992ULL,
+	0xAC48A4F017EB86FDULL, 0xEBE2DE19BC0C79C9ULL, 0x58CC92A7BFAB26A6ULL,
+	0x9317ACC314DD3BC7ULL, 0x2039E07D177A64A8ULL, 0x67939A94BC9D9B9CULL,
+	0xD4BDD62ABF3AC4F3ULL, 0xE8C76F47EB5265F4ULL, 0x5BE923F9E8F53A9BULL,
+	0x1C4359104312C5AFULL, 0xAF6D15AE40B59AC0ULL, 0x192D8AF2BAF0E1E8ULL,
+	0xAA03C64CB957BE87ULL, 0xEDA9BCA512B041B3ULL, 0x5E87F01B11171EDCULL,
+	0x62FD4976457FBFDBULL, 0xD1D305C846D8E0B4ULL, 0x96797F21ED3F1F80ULL,
+	0x2557339FEE9840EFULL, 0xEE8C0DFB45EE5D8EULL, 0x5DA24145464902E1ULL,
+	0x1A083BACEDAEFDD5ULL, 0xA9267712EE09A2BAULL, 0x955CCE7FBA6103BDULL,
+	0x267282C1B9C65CD2ULL, 0x61D8F8281221A3E6ULL, 0xD2F6B4961186FC89ULL,
+	0x9F8169BA49A54B33ULL, 0x2CAF25044A02145CULL, 0x6B055FEDE1E5EB68ULL,
+	0xD82B1353E242B407ULL, 0xE451AA3EB62A1500ULL, 0x577FE680B58D4A6FULL,
+	0x10D59C691E6AB55BULL, 0xA3FBD0D71DCDEA34ULL, 0x6820EEB3B6BBF755ULL,
+	0xDB0EA20DB51CA83AULL, 0x9CA4D8E41EFB570EULL, 0x2F8A945A1D5C0861ULL,
+	0x13F02D374934A966ULL, 0xA0DE61894A93F609ULL, 0xE7741B60E174093DULL,
+	0x545A57DEE2D35652ULL, 0xE21AC88218962D7AULL, 0x5134843C1B317215ULL,
+	0x169EFED5B0D68D21ULL, 0xA5B0B26BB371D24EULL, 0x99CA0B06E7197349ULL,
+	0x2AE447B8E4BE2C26ULL, 0x6D4E3D514F59D312ULL, 0xDE6071EF4CFE8C7DULL,
+	0x15BB4F8BE788911CULL, 0xA6950335E42FCE73ULL, 0xE13F79DC4FC83147ULL,
+	0x521135624C6F6E28ULL, 0x6E6B8C0F1807CF2FULL, 0xDD45C0B11BA09040ULL,
+	0x9AEFBA58B0476F74ULL, 0x29C1F6E6B3E0301BULL, 0xC96C5795D7870F42ULL,
+	0x7A421B2BD420502DULL, 0x3DE861C27FC7AF19ULL, 0x8EC62D7C7C60F076ULL,
+	0xB2BC941128085171ULL, 0x0192D8AF2BAF0E1EULL, 0x4638A2468048F12AULL,
+	0xF516EEF883EFAE45ULL, 0x3ECDD09C2899B324ULL, 0x8DE39C222B3EEC4BULL,
+	0xCA49E6CB80D9137FULL, 0x7967AA75837E4C10ULL, 0x451D1318D716ED17ULL,
+	0xF6335FA6D4B1B278ULL, 0xB199254F7F564D4CULL, 0x02B769F17CF11223ULL,
+	0xB4F7F6AD86B4690BULL, 0x07D9BA1385133664ULL, 0x4073C0FA2EF4C950ULL,
+	0xF35D8C442D53963FULL, 0xCF273529793B3738ULL, 0x7C0979977A9C6857ULL,
+	0x3BA3037ED17B9763ULL, 0x888D4FC0D2DCC80CULL, 0x435671A479AAD56DULL,
+	0xF0783D1A7A0D8A02ULL, 0xB7D247F3D1EA7536ULL, 0x04FC0B4DD24D2A59ULL,
+	0x3886B22086258B5EULL, 0x8BA8FE9E8582D431ULL, 0xCC0284772E652B05ULL,
+	0x7F2CC8C92DC2746AULL, 0x325B15E575E1C3D0ULL, 0x8175595B76469CBFULL,
+	0xC6DF23B2DDA1638BULL, 0x75F16F0CDE063CE4ULL, 0x498BD6618A6E9DE3ULL,
+	0xFAA59ADF89C9C28CULL, 0xBD0FE036222E3DB8ULL, 0x0E21AC88218962D7ULL,
+	0xC5FA92EC8AFF7FB6ULL, 0x76D4DE52895820D9ULL, 0x317EA4BB22BFDFEDULL,
+	0x8250E80521188082ULL, 0xBE2A516875702185ULL, 0x0D041DD676D77EEAULL,
+	0x4AAE673FDD3081DEULL, 0xF9802B81DE97DEB1ULL, 0x4FC0B4DD24D2A599ULL,
+	0xFCEEF8632775FAF6ULL, 0xBB44828A8C9205C2ULL, 0x086ACE348F355AADULL,
+	0x34107759DB5DFBAAULL, 0x873E3BE7D8FAA4C5ULL, 0xC094410E731D5BF1ULL,
+	0x73BA0DB070BA049EULL, 0xB86133D4DBCC19FFULL, 0x0B4F7F6AD86B4690ULL,
+	0x4CE50583738CB9A4ULL, 0xFFCB493D702BE6CBULL, 0xC3B1F050244347CCULL,
+	0x709FBCEE27E418A3ULL, 0x3735C6078C03E797ULL, 0x841B8AB98FA4B8F8ULL,
+	0xADDA7C5F3C4488E3ULL, 0x1EF430E13FE3D78CULL, 0x595E4A08940428B8ULL,
+	0xEA7006B697A377D7ULL, 0xD60ABFDBC3CBD6D0ULL, 0x6524F365C06C89BFULL,
+	0x228E898C6B8B768BULL, 0x91A0C532682C29E4ULL, 0x5A7BFB56C35A3485ULL,
+	0xE955B7E8C0FD6BEAULL, 0xAEFFCD016B1A94DEULL, 0x1DD181BF68BDCBB1ULL,
+	0x21AB38D23CD56AB6ULL, 0x9285746C3F7235D9ULL, 0xD52F0E859495CAEDULL,
+	0x6601423B97329582ULL, 0xD041DD676D77EEAAULL, 0x636F91D96ED0B1C5ULL,
+	0x24C5EB30C5374EF1ULL, 0x97EBA78EC690119EULL, 0xAB911EE392F8B099ULL,
+	0x18BF525D915FEFF6ULL, 0x5F1528B43AB810C2ULL, 0xEC3B640A391F4FADULL,
+	0x27E05A6E926952CCULL, 0x94CE16D091CE0DA3ULL, 0xD3646C393A29F297ULL,
+	0x604A2087398EADF8ULL, 0x5C3099EA6DE60CFFULL, 0xEF1ED5546E415390ULL,
+	0xA8B4AFBDC5A6ACA4ULL, 0x1B9AE303C601F3CBULL, 0x56ED3E2F9E224471ULL,
+	0xE5C372919D851B1EULL, 0xA26908783662E42AULL, 0x114744C635C5BB45ULL,
+	0x2D3DFDAB61AD1A42ULL, 0x9E13B115620A452DULL, 0xD9B9CBFCC9EDBA19ULL,
+	0x6A978742CA4AE576ULL, 0xA14CB926613CF817ULL, 0x1262F598629BA778ULL,
+	0x55C88F71C97C584CULL, 0xE6E6C3CFCADB0723ULL, 0xDA9C7AA29EB3A624ULL,
+	0x69B2361C9D14F94BULL, 0x2E184CF536F3067FULL, 0x9D36004B35545910ULL,
+	0x2B769F17CF112238ULL, 0x9858D3A9CCB67D57ULL, 0xDFF2A94067518263ULL,
+	0x6CDCE5FE64F6DD0CULL, 0x50A65C93309E7C0BULL, 0xE388102D33392364ULL,
+	0xA4226AC498DEDC50ULL, 0x170C267A9B79833FULL, 0xDCD7181E300F9E5EULL,
+	0x6FF954A033A8C131ULL, 0x28532E49984F3E05ULL, 0x9B7D62F79BE8616AULL,
+	0xA707DB9ACF80C06DULL, 0x14299724CC279F02ULL, 0x5383EDCD67C06036ULL,
+	0xE0ADA17364673F59ULL,
+    },
+    {
+	0x0000000000000000ULL, 0x54E979925CD0F10DULL, 0xA9D2F324B9A1E21AULL,
+	0xFD3B8AB6E5711317ULL, 0xC17D4962DC4DDAB1ULL, 0x959430F0809D2BBCULL,
+	0x68AFBA4665EC38ABULL, 0x3C46C3D4393CC9A6ULL, 0x10223DEE1795ABE7ULL,
+	0x44CB447C4B455AEAULL, 0xB9F0CECAAE3449FDULL, 0xED19B758F2E4B8F0ULL,
+	0xD15F748CCBD87156ULL, 0x85B60D1E9708805BULL, 0x788D87A87279934CULL,
+	0x2C64FE3A2EA96241ULL, 0x20447BDC2F2B57CEULL, 0x74AD024E73FBA6C3ULL,
+	0x899688F8968AB5D4ULL, 0xDD7FF16ACA5A44D9ULL, 0xE13932BEF3668D7FULL,
+	0xB5D04B2CAFB67C72ULL, 0x48EBC19A4AC76F65ULL, 0x1C02B80816179E68ULL,
+	0x3066463238BEFC29ULL, 0x648F3FA0646E0D24ULL, 0x99B4B516811F1E33ULL,
+	0xCD5DCC84DDCFEF3EULL, 0xF11B0F50E4F32698ULL, 0xA5F276C2B823D795ULL,
+	0x58C9FC745D52C482ULL, 0x0C2085E60182358FULL, 0x4088F7B85E56AF9CULL,
+	0x14618E2A02865E91ULL, 0xE95A049CE7F74D86ULL, 0xBDB37D0EBB27BC8BULL,
+	0x81F5BEDA821B752DULL, 0xD51CC748DECB8420ULL, 0x28274DFE3BBA9737ULL,
+	0x7CCE346C676A663AULL, 0x50AACA5649C3047BULL, 0x0443B3C41513F576ULL,
+	0xF9783972F062E661ULL, 0xAD9140E0ACB2176CULL, 0x91D78334958EDECAULL,
+	0xC53EFAA6C95E2FC7ULL, 0x380570102C2F3CD0ULL, 0x6CEC098270FFCDDDULL,
+	0x60CC8C64717DF852ULL, 0x3425F5F62DAD095FULL, 0xC91E7F40C8DC1A48ULL,
+	0x9DF706D2940CEB45ULL, 0xA1B1C506AD3022E3ULL, 0xF558BC94F1E0D3EEULL,
+	0x086336221491C0F9ULL, 0x5C8A4FB0484131F4ULL, 0x70EEB18A66E853B5ULL,
+	0x2407C8183A38A2B8ULL, 0xD93C42AEDF49B1AFULL, 0x8DD53B3C839940A2ULL,
+	0xB193F8E8BAA58904ULL, 0xE57A817AE6757809ULL, 0x18410BCC03046B1EULL,
+	0x4CA8725E5FD49A13ULL, 0x8111EF70BCAD5F38ULL, 0xD5F896E2E07DAE35ULL,
+	0x28C31C54050CBD22ULL, 0x7C2A65C659DC4C2FULL, 0x406CA61260E08589ULL,
+	0x1485DF803C307484ULL, 0xE9BE5536D9416793ULL, 0xBD572CA48591969EULL,
+	0x9133D29EAB38F4DFULL, 0xC5DAAB0CF7E805D2ULL, 0x38E121BA129916C5ULL,
+	0x6C0858284E49E7C8ULL, 0x504E9BFC77752E6EULL, 0x04A7E26E2BA5DF63ULL,
+	0xF99C68D8CED4CC74ULL, 0xAD75114A92043D79ULL, 0xA15594AC938608F6ULL,
+	0xF5BCED3ECF56F9FBULL, 0x088767882A27EAECULL, 0x5C6E1E1A76F71BE1ULL,
+	0x6028DDCE4FCBD247ULL, 0x34C1A45C131B234AULL, 0xC9FA2EEAF66A305DULL,
+	0x9D135778AABAC150ULL, 0xB177A9428413A311ULL, 0xE59ED0D0D8C3521CULL,
+	0x18A55A663DB2410BULL, 0x4C4C23F46162B006ULL, 0x700AE020585E79A0ULL,
+	0x24E399B2048E88ADULL, 0xD9D81304E1FF9BBAULL, 0x8D316A96BD2F6AB7ULL,
+	0xC19918C8E2FBF0A4ULL, 0x9570615ABE2B01A9ULL, 0x684BEBEC5B5A12BEULL,
+	0x3CA2927E078AE3B3ULL, 0x00E451AA3EB62A15ULL, 0x540D28386266DB18ULL,
+	0xA936A28E8717C80FULL, 0xFDDFDB1CDBC73902ULL, 0xD1BB2526F56E5B43ULL,
+	0x85525CB4A9BEAA4EULL, 0x7869D6024CCFB959ULL, 0x2C80AF90101F4854ULL,
+	0x10C66C44292381F2ULL, 0x442F15D675F370FFULL, 0xB9149F60908263E8ULL,
+	0xEDFDE6F2CC5292E5ULL, 0xE1DD6314CDD0A76AULL, 0xB5341A8691005667ULL,
+	0x480F903074714570ULL, 0x1CE6E9A228A1B47DULL, 0x20A02A76119D7DDBULL,
+	0x744953E44D4D8CD6ULL, 0x8972D952A83C9FC1ULL, 0xDD9BA0C0F4EC6ECCULL,
+	0xF1FF5EFADA450C8DULL, 0xA51627688695FD80ULL, 0x582DADDE63E4EE97ULL,
+	0x0CC4D44C3F341F9AULL, 0x308217980608D63CULL, 0x646B6E0A5AD82731ULL,
+	0x9950E4BCBFA93426ULL, 0xCDB99D2EE379C52BULL, 0x90FB71CAD654A0F5ULL,
+	0xC41208588A8451F8ULL, 0x392982EE6FF542EFULL, 0x6DC0FB7C3325B3E2ULL,
+	0x518638A80A197A44ULL, 0x056F413A56C98B49ULL, 0xF854CB8CB3B8985EULL,
+	0xACBDB21EEF686953ULL, 0x80D94C24C1C10B12ULL, 0xD43035B69D11FA1FULL,
+	0x290BBF007860E908ULL, 0x7DE2C69224B01805ULL, 0x41A405461D8CD1A3ULL,
+	0x154D7CD4415C20AEULL, 0xE876F662A42D33B9ULL, 0xBC9F8FF0F8FDC2B4ULL,
+	0xB0BF0A16F97FF73BULL, 0xE4567384A5AF0636ULL, 0x196DF93240DE1521ULL,
+	0x4D8480A01C0EE42CULL, 0x71C2437425322D8AULL, 0x252B3AE679E2DC87ULL,
+	0xD810B0509C93CF90ULL, 0x8CF9C9C2C0433E9DULL, 0xA09D37F8EEEA5CDCULL,
+	0xF4744E6AB23AADD1ULL, 0x094FC4DC574BBEC6ULL, 0x5DA6BD4E0B9B4FCBULL,
+	0x61E07E9A32A7866DULL, 0x350907086E777760ULL, 0xC8328DBE8B066477ULL,
+	0x9CDBF42CD7D6957AULL, 0xD073867288020F69ULL, 0x849AFFE0D4D2FE64ULL,
+	0x79A1755631A3ED73ULL, 0x2D480CC46D731C7EULL, 0x110ECF10544FD5D8ULL,
+	0x45E7B682089F24D5ULL, 0xB8DC3C34EDEE37C2ULL, 0xEC3545A6B13EC6CFULL,
+	0xC051BB9C9F97A48EULL, 0x94B8C20EC3475583ULL, 0x698348B826364694ULL,
+	0x3D6A312A7AE6B799ULL, 0x012CF2FE43DA7E3FULL, 0x55C58B6C1F0A8F32ULL,
+	0xA8FE01DAFA7B9C25ULL, 0xFC177848A6AB6D28ULL, 0xF037FDAEA72958A7ULL,
+	0xA4DE843CFBF9A9AAULL, 0x59E50E8A1E88BABDULL, 0x0D0C771842584BB0ULL,
+	0x314AB4CC7B648216ULL, 0x65A3CD5E27B4731BULL, 0x989847E8C2C5600CULL,
+	0xCC713E7A9E159101ULL, 0xE015C040B0BCF340ULL, 0xB4FCB9D2EC6C024DULL,
+	0x49C73364091D115AULL, 0x1D2E4AF655CDE057ULL, 0x216889226CF129F1ULL,
+	0x7581F0B03021D8FCULL, 0x88BA7A06D550CBEBULL, 0xDC53039489803AE6ULL,
+	0x11EA9EBA6AF9FFCDULL, 0x4503E72836290EC0ULL, 0xB8386D9ED3581DD7ULL,
+	0xECD1140C8F88ECDAULL, 0xD097D7D8B6B4257CULL, 0x847EAE4AEA64D471ULL,
+	0x794524FC0F15C766ULL, 0x2DAC5D6E53C5366BULL, 0x01C8A3547D6C542AULL,
+	0x5521DAC621BCA527ULL, 0xA81A5070C4CDB630ULL, 0xFCF329E2981D473DULL,
+	0xC0B5EA36A1218E9BULL, 0x945C93A4FDF17F96ULL, 0x6967191218806C81ULL,
+	0x3D8E608044509D8CULL, 0x31AEE56645D2A803ULL, 0x65479CF41902590EULL,
+	0x987C1642FC734A19ULL, 0xCC956FD0A0A3BB14ULL, 0xF0D3AC04999F72B2ULL,
+	0xA43AD596C54F83BFULL, 0x59015F20203E90A8ULL, 0x0DE826B27CEE61A5ULL,
+	0x218CD888524703E4ULL, 0x7565A11A0E97F2E9ULL, 0x885E2BACEBE6E1FEULL,
+	0xDCB7523EB73610F3ULL, 0xE0F191EA8E0AD955ULL, 0xB418E878D2DA2858ULL,
+	0x492362CE37AB3B4FULL, 0x1DCA1B5C6B7BCA42ULL, 0x5162690234AF5051ULL,
+	0x058B1090687FA15CULL, 0xF8B09A268D0EB24BULL, 0xAC59E3B4D1DE4346ULL,
+	0x901F2060E8E28AE0ULL, 0xC4F659F2B4327BEDULL, 0x39CDD344514368FAULL,
+	0x6D24AAD60D9399F7ULL, 0x414054EC233AFBB6ULL, 0x15A92D7E7FEA0ABBULL,
+	0xE892A7C89A9B19ACULL, 0xBC7BDE5AC64BE8A1ULL, 0x803D1D8EFF772107ULL,
+	0xD4D4641CA3A7D00AULL, 0x29EFEEAA46D6C31DULL, 0x7D0697381A063210ULL,
+	0x712612DE1B84079FULL, 0x25CF6B4C4754F692ULL, 0xD8F4E1FAA225E585ULL,
+	0x8C1D9868FEF51488ULL, 0xB05B5BBCC7C9DD2EULL, 0xE4B2222E9B192C23ULL,
+	0x1989A8987E683F34ULL, 0x4D60D10A22B8CE39ULL, 0x61042F300C11AC78ULL,
+	0x35ED56A250C15D75ULL, 0xC8D6DC14B5B04E62ULL, 0x9C3FA586E960BF6FULL,
+	0xA0796652D05C76C9ULL, 0xF4901FC08C8C87C4ULL, 0x09AB957669FD94D3ULL,
+	0x5D42ECE4352D65DEULL,
+    },
+    {
+	0x0000000000000000ULL, 0x3F0BE14A916A6DCBULL, 0x7E17C29522D4DB96ULL,
+	0x411C23DFB3BEB65DULL, 0xFC2F852A45A9B72CULL, 0xC3246460D4C3DAE7ULL,
+	0x823847BF677D6CBAULL, 0xBD33A6F5F6170171ULL, 0x6A87A57F245D70DDULL,
+	0x558C4435B5371D16ULL, 0x149067EA0689AB4BULL, 0x2B9B86A097E3C680ULL,
+	0x96A8205561F4C7F1ULL, 0xA9A3C11FF09EAA3AULL, 0xE8BFE2C043201C67ULL,
+	0xD7B4038AD24A71ACULL, 0xD50F4AFE48BAE1BAULL, 0xEA04ABB4D9D08C71ULL,
+	0xAB18886B6A6E3A2CULL, 0x94136921FB0457E7ULL, 0x2920CFD40D135696ULL,
+	0x162B2E9E9C793B5DULL, 0x57370D412FC78D00ULL, 0x683CEC0BBEADE0CBULL,
+	0xBF88EF816CE79167ULL, 0x80830ECBFD8DFCACULL, 0xC19F2D144E334AF1ULL,
+	0xFE94CC5EDF59273AULL, 0x43A76AAB294E264BULL, 0x7CAC8BE1B8244B80ULL,
+	0x3DB0A83E0B9AFDDDULL, 0x02BB49749AF09016ULL, 0x38C63AD73E7BDDF1ULL,
+	0x07CDDB9DAF11B03AULL, 0x46D1F8421CAF0667ULL, 0x79DA19088DC56BACULL,
+	0xC4E9BFFD7BD26ADDULL, 0xFBE25EB7EAB80716ULL, 0xBAFE7D685906B14BULL,
+	0x85F59C22C86CDC80ULL, 0x52419FA81A26AD2CULL, 0x6D4A7EE28B4CC0E7ULL,
+	0x2C565D3D38F276BAULL, 0x135DBC77A9981B71ULL, 0xAE6E1A825F8F1A00ULL,
+	0x9165FBC8CEE577CBULL, 0xD079D8177D5BC196ULL, 0xEF72395DEC31AC5DULL,
+	0xEDC9702976C13C4BULL, 0xD2C29163E7AB5180ULL, 0x93DEB2BC5415E7DDULL,
+	0xACD553F6C57F8A16ULL, 0x11E6F50333688B67ULL, 0x2EED1449A202E6ACULL,
+	0x6FF1379611BC50F1ULL, 0x50FAD6DC80D63D3AULL, 0x874ED556529C4C96ULL,
+	0xB845341CC3F6215DULL, 0xF95917C370489700ULL, 0xC652F689E122FACBULL,
+	0x7B61507C1735FBBAULL, 0x446AB136865F9671ULL, 0x057692E935E1202CULL,
+	0x3A7D73A3A48B4DE7ULL, 0x718C75AE7CF7BBE2ULL, 0x4E8794E4ED9DD629ULL,
+	0x0F9BB73B5E236074ULL, 0x30905671CF490DBFULL, 0x8DA3F084395E0CCEULL,
+	0xB2A811CEA8346105ULL, 0xF3B432111B8AD758ULL, 0xCCBFD35B8AE0BA93ULL,
+	0x1B0BD0D158AACB3FULL, 0x2400319BC9C0A6F4ULL, 0x651C12447A7E10A9ULL,
+	0x5A17F30EEB147D62ULL, 0xE72455FB1D037C13ULL, 0xD82FB4B18C6911D8ULL,
+	0x9933976E3FD7A785ULL, 0xA6387624AEBDCA4EULL, 0xA4833F50344D5A58ULL,
+	0x9B88DE1AA5273793ULL, 0xDA94FDC5169981CEULL, 0xE59F1C8F87F3EC05ULL,
+	0x58ACBA7A71E4ED74ULL, 0x67A75B30E08E80BFULL, 0x26BB78EF533036E2ULL,
+	0x19B099A5C25A5B29ULL, 0xCE049A2F10102A85ULL, 0xF10F7B65817A474EULL,
+	0xB01358BA32C4F113ULL, 0x8F18B9F0A3AE9CD8ULL, 0x322B1F0555B99DA9ULL,
+	0x0D20FE4FC4D3F062ULL, 0x4C3CDD90776D463FULL, 0x73373CDAE6072BF4ULL,
+	0x494A4F79428C6613ULL, 0x7641AE33D3E60BD8ULL, 0x375D8DEC6058BD85ULL,
+	0x08566CA6F132D04EULL, 0xB565CA530725D13FULL, 0x8A6E2B19964FBCF4ULL,
+	0xCB7208C625F10AA9ULL, 0xF479E98CB49B6762ULL, 0x23CDEA0666D116CEULL,
+	0x1CC60B4CF7BB7B05ULL, 0x5DDA28934405CD58ULL, 0x62D1C9D9D56FA093ULL,
+	0xDFE26F2C2378A1E2ULL, 0xE0E98E66B212CC29ULL, 0xA1F5ADB901AC7A74ULL,
+	0x9EFE4CF390C617BFULL, 0x9C4505870A3687A9ULL, 0xA34EE4CD9B5CEA62ULL,
+	0xE252C71228E25C3FULL, 0xDD592658B98831F4ULL, 0x606A80AD4F9F3085ULL,
+	0x5F6161E7DEF55D4EULL, 0x1E7D42386D4BEB13ULL, 0x2176A372FC2186D8ULL,
+	0xF6C2A0F82E6BF774ULL, 0xC9C941B2BF019ABFULL, 0x88D5626D0CBF2CE2ULL,
+	0xB7DE83279DD54129ULL, 0x0AED25D26BC24058ULL, 0x35E6C498FAA82D93ULL,
+	0x74FAE74749169BCEULL, 0x4BF1060DD87CF605ULL, 0xE318EB5CF9EF77C4ULL,
+	0xDC130A1668851A0FULL, 0x9D0F29C9DB3BAC52ULL, 0xA204C8834A51C199ULL,
+	0x1F376E76BC46C0E8ULL, 0x203C8F3C2D2CAD23ULL, 0x6120ACE39E921B7EULL,
+	0x5E2B4DA90FF876B5ULL, 0x899F4E23DDB20719ULL, 0xB694AF694CD86AD2ULL,
+	0xF7888CB6FF66DC8FULL, 0xC8836DFC6E0CB144ULL, 0x75B0CB09981BB035ULL,
+	0x4ABB2A430971DDFEULL, 0x0BA7099CBACF6BA3ULL, 0x34ACE8D62BA50668ULL,
+	0x3617A1A2B155967EULL, 0x091C40E8203FFBB5ULL, 0x4800633793814DE8ULL,
+	0x770B827D02EB2023ULL, 0xCA382488F4FC2152ULL, 0xF533C5C265964C99ULL,
+	0xB42FE61DD628FAC4ULL, 0x8B2407574742970FULL, 0x5C9004DD9508E6A3ULL,
+	0x639BE59704628B68ULL, 0x2287C648B7DC3D35ULL, 0x1D8C270226B650FEULL,
+	0xA0BF81F7D0A1518FULL, 0x9FB460BD41CB3C44ULL, 0xDEA84362F2758A19ULL,
+	0xE1A3A228631FE7D2ULL, 0xDBDED18BC794AA35ULL, 0xE4D530C156FEC7FEULL,
+	0xA5C9131EE54071A3ULL, 0x9AC2F254742A1C68ULL, 0x27F154A1823D1D19ULL,
+	0x18FAB5EB135770D2ULL, 0x59E69634A0E9C68FULL, 0x66ED777E3183AB44ULL,
+	0xB15974F4E3C9DAE8ULL, 0x8E5295BE72A3B723ULL, 0xCF4EB661C11D017EULL,
+	0xF045572B50776CB5ULL, 0x4D76F1DEA6606DC4ULL, 0x727D1094370A000FULL,
+	0x3361334B84B4B652ULL, 0x0C6AD20115DEDB99ULL, 0x0ED19B758F2E4B8FULL,
+	0x31DA7A3F1E442644ULL, 0x70C659E0ADFA9019ULL, 0x4FCDB8AA3C90FDD2ULL,
+	0xF2FE1E5FCA87FCA3ULL, 0xCDF5FF155BED9168ULL, 0x8CE9DCCAE8532735ULL,
+	0xB3E23D8079394AFEULL, 0x64563E0AAB733B52ULL, 0x5B5DDF403A195699ULL,
+	0x1A41FC9F89A7E0C4ULL, 0x254A1DD518CD8D0FULL, 0x9879BB20EEDA8C7EULL,
+	0xA7725A6A7FB0E1B5ULL, 0xE66E79B5CC0E57E8ULL, 0xD96598FF5D643A23ULL,
+	0x92949EF28518CC26ULL, 0xAD9F7FB81472A1EDULL, 0xEC835C67A7CC17B0ULL,
+	0xD388BD2D36A67A7BULL, 0x6EBB1BD8C0B17B0AULL, 0x51B0FA9251DB16C1ULL,
+	0x10ACD94DE265A09CULL, 0x2FA73807730FCD57ULL, 0xF8133B8DA145BCFBULL,
+	0xC718DAC7302FD130ULL, 0x8604F9188391676DULL, 0xB90F185212FB0AA6ULL,
+	0x043CBEA7E4EC0BD7ULL, 0x3B375FED7586661CULL, 0x7A2B7C32C638D041ULL,
+	0x45209D785752BD8AULL, 0x479BD40CCDA22D9CULL, 0x789035465CC84057ULL,
+	0x398C1699EF76F60AULL, 0x0687F7D37E1C9BC1ULL, 0xBBB45126880B9AB0ULL,
+	0x84BFB06C1961F77BULL, 0xC5A393B3AADF4126ULL, 0xFAA872F93BB52CEDULL,
+	0x2D1C7173E9FF5D41ULL, 0x121790397895308AULL, 0x530BB3E6CB2B86D7ULL,
+	0x6C0052AC5A41EB1CULL, 0xD133F459AC56EA6DULL, 0xEE3815133D3C87A6ULL,
+	0xAF2436CC8E8231FBULL, 0x902FD7861FE85C30ULL, 0xAA52A425BB6311D7ULL,
+	0x9559456F2A097C1CULL, 0xD44566B099B7CA41ULL, 0xEB4E87FA08DDA78AULL,
+	0x567D210FFECAA6FBULL, 0x6976C0456FA0CB30ULL, 0x286AE39ADC1E7D6DULL,
+	0x176102D04D7410A6ULL, 0xC0D5015A9F3E610AULL, 0xFFDEE0100E540CC1ULL,
+	0xBEC2C3CFBDEABA9CULL, 0x81C922852C80D757ULL, 0x3CFA8470DA97D626ULL,
+	0x03F1653A4BFDBBEDULL, 0x42ED46E5F8430DB0ULL, 0x7DE6A7AF6929607BULL,
+	0x7F5DEEDBF3D9F06DULL, 0x40560F9162B39DA6ULL, 0x014A2C4ED10D2BFBULL,
+	0x3E41CD0440674630ULL, 0x83726BF1B6704741ULL, 0xBC798ABB271A2A8AULL,
+	0xFD65A96494A49CD7ULL, 0xC26E482E05CEF11CULL, 0x15DA4BA4D78480B0ULL,
+	0x2AD1AAEE46EEED7BULL, 0x6BCD8931F5505B26ULL, 0x54C6687B643A36EDULL,
+	0xE9F5CE8E922D379CULL, 0xD6FE2FC403475A57ULL, 0x97E20C1BB0F9EC0AULL,
+	0xA8E9ED51219381C1ULL,
+    },
+    {
+	0x0000000000000000ULL, 0x1DEE8A5E222CA1DCULL, 0x3BDD14BC445943B8ULL,
+	0x26339EE26675E264ULL, 0x77BA297888B28770ULL, 0x6A54A326AA9E26ACULL,
+	0x4C673DC4CCEBC4C8ULL, 0x5189B79AEEC76514ULL, 0xEF7452F111650EE0ULL,
+	0xF29AD8AF3349AF3CULL, 0xD4A9464D553C4D58ULL, 0xC947CC137710EC84ULL,
+	0x98CE7B8999D78990ULL, 0x8520F1D7BBFB284CULL, 0xA3136F35DD8ECA28ULL,
+	0xBEFDE56BFFA26BF4ULL, 0x4C300AC98DC40345ULL, 0x51DE8097AFE8A299ULL,
+	0x77ED1E75C99D40FDULL, 0x6A03942BEBB1E121ULL, 0x3B8A23B105768435ULL,
+	0x2664A9EF275A25E9ULL, 0x0057370D412FC78DULL, 0x1DB9BD5363036651ULL,
+	0xA34458389CA10DA5ULL, 0xBEAAD266BE8DAC79ULL, 0x98994C84D8F84E1DULL,
+	0x8577C6DAFAD4EFC1ULL, 0xD4FE714014138AD5ULL, 0xC910FB1E363F2B09ULL,
+	0xEF2365FC504AC96DULL, 0xF2CDEFA2726668B1ULL, 0x986015931B88068AULL,
+	0x858E9FCD39A4A756ULL, 0xA3BD012F5FD14532ULL, 0xBE538B717DFDE4EEULL,
+	0xEFDA3CEB933A81FAULL, 0xF234B6B5B1162026ULL, 0xD4072857D763C242ULL,
+	0xC9E9A209F54F639EULL, 0x771447620AED086AULL, 0x6AFACD3C28C1A9B6ULL,
+	0x4CC953DE4EB44BD2ULL, 0x5127D9806C98EA0EULL, 0x00AE6E1A825F8F1AULL,
+	0x1D40E444A0732EC6ULL, 0x3B737AA6C606CCA2ULL, 0x269DF0F8E42A6D7EULL,
+	0xD4501F5A964C05CFULL, 0xC9BE9504B460A413ULL, 0xEF8D0BE6D2154677ULL,
+	0xF26381B8F039E7ABULL, 0xA3EA36221EFE82BFULL, 0xBE04BC7C3CD22363ULL,
+	0x9837229E5AA7C107ULL, 0x85D9A8C0788B60DBULL, 0x3B244DAB87290B2FULL,
+	0x26CAC7F5A505AAF3ULL, 0x00F95917C3704897ULL, 0x1D17D349E15CE94BULL,
+	0x4C9E64D30F9B8C5FULL, 0x5170EE8D2DB72D83ULL, 0x7743706F4BC2CFE7ULL,
+	0x6AADFA3169EE6E3BULL, 0xA218840D981E1391ULL, 0xBFF60E53BA32B24DULL,
+	0x99C590B1DC475029ULL, 0x842B1AEFFE6BF1F5ULL, 0xD5A2AD7510AC94E1ULL,
+	0xC84C272B3280353DULL, 0xEE7FB9C954F5D759ULL, 0xF391339776D97685ULL,
+	0x4D6CD6FC897B1D71ULL, 0x50825CA2AB57BCADULL, 0x76B1C240CD225EC9ULL,
+	0x6B5F481EEF0EFF15ULL, 0x3AD6FF8401C99A01ULL, 0x273875DA23E53BDDULL,
+	0x010BEB384590D9B9ULL, 0x1CE5616667BC7865ULL, 0xEE288EC415DA10D4ULL,
+	0xF3C6049A37F6B108ULL, 0xD5F59A785183536CULL, 0xC81B102673AFF2B0ULL,
+	0x9992A7BC9D6897A4ULL, 0x847C2DE2BF443678ULL, 0xA24FB300D931D41CULL,
+	0xBFA1395EFB1D75C0ULL, 0x015CDC3504BF1E34ULL, 0x1CB2566B2693BFE8ULL,
+	0x3A81C88940E65D8CULL, 0x276F42D762CAFC50ULL, 0x76E6F54D8C0D9944ULL,
+	0x6B087F13AE213898ULL, 0x4D3BE1F1C854DAFCULL, 0x50D56BAFEA787B20ULL,
+	0x3A78919E8396151BULL, 0x27961BC0A1BAB4C7ULL, 0x01A58522C7CF56A3ULL,
+	0x1C4B0F7CE5E3F77FULL, 0x4DC2B8E60B24926BULL, 0x502C32B8290833B7ULL,
+	0x761FAC5A4F7DD1D3ULL, 0x6BF126046D51700FULL, 0xD50CC36F92F31BFBULL,
+	0xC8E24931B0DFBA27ULL, 0xEED1D7D3D6AA5843ULL, 0xF33F5D8DF486F99FULL,
+	0xA2B6EA171A419C8BULL, 0xBF586049386D3D57ULL, 0x996BFEAB5E18DF33ULL,
+	0x848574F57C347EEFULL, 0x76489B570E52165EULL, 0x6BA611092C7EB782ULL,
+	0x4D958FEB4A0B55E6ULL, 0x507B05B56827F43AULL, 0x01F2B22F86E0912EULL,
+	0x1C1C3871A4CC30F2ULL, 0x3A2FA693C2B9D296ULL, 0x27C12CCDE095734AULL,
+	0x993CC9A61F3718BEULL, 0x84D243F83D1BB962ULL, 0xA2E1DD1A5B6E5B06ULL,
+	0xBF0F57447942FADAULL, 0xEE86E0DE97859FCEULL, 0xF3686A80B5A93E12ULL,
+	0xD55BF462D3DCDC76ULL, 0xC8B57E3CF1F07DAAULL, 0xD6E9A7309F3239A7ULL,
+	0xCB072D6EBD1E987BULL, 0xED34B38CDB6B7A1FULL, 0xF0DA39D2F947DBC3ULL,
+	0xA1538E481780BED7ULL, 0xBCBD041635AC1F0BULL, 0x9A8E9AF453D9FD6FULL,
+	0x876010AA71F55CB3ULL, 0x399DF5C18E573747ULL, 0x24737F9FAC7B969BULL,
+	0x0240E17DCA0E74FFULL, 0x1FAE6B23E822D523ULL, 0x4E27DCB906E5B037ULL,
+	0x53C956E724C911EBULL, 0x75FAC80542BCF38FULL, 0x6814425B60905253ULL,
+	0x9AD9ADF912F63AE2ULL, 0x873727A730DA9B3EULL, 0xA104B94556AF795AULL,
+	0xBCEA331B7483D886ULL, 0xED6384819A44BD92ULL, 0xF08D0EDFB8681C4EULL,
+	0xD6BE903DDE1DFE2AULL, 0xCB501A63FC315FF6ULL, 0x75ADFF0803933402ULL,
+	0x6843755621BF95DEULL, 0x4E70EBB447CA77BAULL, 0x539E61EA65E6D666ULL,
+	0x0217D6708B21B372ULL, 0x1FF95C2EA90D12AEULL, 0x39CAC2CCCF78F0CAULL,
+	0x24244892ED545116ULL, 0x4E89B2A384BA3F2DULL, 0x536738FDA6969EF1ULL,
+	0x7554A61FC0E37C95ULL, 0x68BA2C41E2CFDD49ULL, 0x39339BDB0C08B85DULL,
+	0x24DD11852E241981ULL, 0x02EE8F674851FBE5ULL, 0x1F0005396A7D5A39ULL,
+	0xA1FDE05295DF31CDULL, 0xBC136A0CB7F39011ULL, 0x9A20F4EED1867275ULL,
+	0x87CE7EB0F3AAD3A9ULL, 0xD647C92A1D6DB6BDULL, 0xCBA943743F411761ULL,
+	0xED9ADD965934F505ULL, 0xF07457C87B1854D9ULL, 0x02B9B86A097E3C68ULL,
+	0x1F5732342B529DB4ULL, 0x3964ACD64D277FD0ULL, 0x248A26886F0BDE0CULL,
+	0x7503911281CCBB18ULL, 0x68ED1B4CA3E01AC4ULL, 0x4EDE85AEC595F8A0ULL,
+	0x53300FF0E7B9597CULL, 0xEDCDEA9B181B3288ULL, 0xF02360C53A379354ULL,
+	0xD610FE275C427130ULL, 0xCBFE74797E6ED0ECULL, 0x9A77C3E390A9B5F8ULL,
+	0x879949BDB2851424ULL, 0xA1AAD75FD4F0F640ULL, 0xBC445D01F6DC579CULL,
+	0x74F1233D072C2A36ULL, 0x691FA96325008BEAULL, 0x4F2C37814375698EULL,
+	0x52C2BDDF6159C852ULL, 0x034B0A458F9EAD46ULL, 0x1EA5801BADB20C9AULL,
+	0x38961EF9CBC7EEFEULL, 0x257894A7E9EB4F22ULL, 0x9B8571CC164924D6ULL,
+	0x866BFB923465850AULL, 0xA05865705210676EULL, 0xBDB6EF2E703CC6B2ULL,
+	0xEC3F58B49EFBA3A6ULL, 0xF1D1D2EABCD7027AULL, 0xD7E24C08DAA2E01EULL,
+	0xCA0CC656F88E41C2ULL, 0x38C129F48AE82973ULL, 0x252FA3AAA8C488AFULL,
+	0x031C3D48CEB16ACBULL, 0x1EF2B716EC9DCB17ULL, 0x4F7B008C025AAE03ULL,
+	0x52958AD220760FDFULL, 0x74A614304603EDBBULL, 0x69489E6E642F4C67ULL,
+	0xD7B57B059B8D2793ULL, 0xCA5BF15BB9A1864FULL, 0xEC686FB9DFD4642BULL,
+	0xF186E5E7FDF8C5F7ULL, 0xA00F527D133FA0E3ULL, 0xBDE1D8233113013FULL,
+	0x9BD246C15766E35BULL, 0x863CCC9F754A4287ULL, 0xEC9136AE1CA42CBCULL,
+	0xF17FBCF03E888D60ULL, 0xD74C221258FD6F04ULL, 0xCAA2A84C7AD1CED8ULL,
+	0x9B2B1FD69416ABCCULL, 0x86C59588B63A0A10ULL, 0xA0F60B6AD04FE874ULL,
+	0xBD188134F26349A8ULL, 0x03E5645F0DC1225CULL, 0x1E0BEE012FED8380ULL,
+	0x383870E3499861E4ULL, 0x25D6FABD6BB4C038ULL, 0x745F4D278573A52CULL,
+	0x69B1C779A75F04F0ULL, 0x4F82599BC12AE694ULL, 0x526CD3C5E3064748ULL,
+	0xA0A13C6791602FF9ULL, 0xBD4FB639B34C8E25ULL, 0x9B7C28DBD5396C41ULL,
+	0x8692A285F715CD9DULL, 0xD71B151F19D2A889ULL, 0xCAF59F413BFE0955ULL,
+	0xECC601A35D8BEB31ULL, 0xF1288BFD7FA74AEDULL, 0x4FD56E9680052119ULL,
+	0x523BE4C8A22980C5ULL, 0x74087A2AC45C62A1ULL, 0x69E6F074E670C37DULL,
+	0x386F47EE08B7A669ULL, 0x2581CDB02A9B07B5ULL, 0x03B253524CEEE5D1ULL,
+	0x1E5CD90C6EC2440DULL,
+    },
+    {
+	0x0000000000000000ULL, 0x5C2D776033C4205EULL, 0xB85AEEC0678840BCULL,
+	0xE47799A0544C60E2ULL, 0xE26D72AB601E9FFDULL, 0xBE4005CB53DABFA3ULL,
+	0x5A379C6B0796DF41ULL, 0x061AEB0B3452FF1FULL, 0x56024A7D6F33217FULL,
+	0x0A2F3D1D5CF70121ULL, 0xEE58A4BD08BB61C3ULL, 0xB275D3DD3B7F419DULL,
+	0xB46F38D60F2DBE82ULL, 0xE8424FB63CE99EDCULL, 0x0C35D61668A5FE3EULL,
+	0x5018A1765B61DE60ULL, 0xAC0494FADE6642FEULL, 0xF029E39AEDA262A0ULL,
+	0x145E7A3AB9EE0242ULL, 0x48730D5A8A2A221CULL, 0x4E69E651BE78DD03ULL,
+	0x124491318DBCFD5DULL, 0xF6330891D9F09DBFULL, 0xAA1E7FF1EA34BDE1ULL,
+	0xFA06DE87B1556381ULL, 0xA62BA9E7829143DFULL, 0x425C3047D6DD233DULL,
+	0x1E714727E5190363ULL, 0x186BAC2CD14BFC7CULL, 0x4446DB4CE28FDC22ULL,
+	0xA03142ECB6C3BCC0ULL, 0xFC1C358C85079C9EULL, 0xCAD186DE13C29B79ULL,
+	0x96FCF1BE2006BB27ULL, 0x728B681E744ADBC5ULL, 0x2EA61F7E478EFB9BULL,
+	0x28BCF47573DC0484ULL, 0x74918315401824DAULL, 0x90E61AB514544438ULL,
+	0xCCCB6DD527906466ULL, 0x9CD3CCA37CF1BA06ULL, 0xC0FEBBC34F359A58ULL,
+	0x248922631B79FABAULL, 0x78A4550328BDDAE4ULL, 0x7EBEBE081CEF25FBULL,
+	0x2293C9682F2B05A5ULL, 0xC6E450C87B676547ULL, 0x9AC927A848A34519ULL,
+	0x66D51224CDA4D987ULL, 0x3AF86544FE60F9D9ULL, 0xDE8FFCE4AA2C993BULL,
+	0x82A28B8499E8B965ULL, 0x84B8608FADBA467AULL, 0xD89517EF9E7E6624ULL,
+	0x3CE28E4FCA3206C6ULL, 0x60CFF92FF9F62698ULL, 0x30D75859A297F8F8ULL,
+	0x6CFA2F399153D8A6ULL, 0x888DB699C51FB844ULL, 0xD4A0C1F9F6DB981AULL,
+	0xD2BA2AF2C2896705ULL, 0x8E975D92F14D475BULL, 0x6AE0C432A50127B9ULL,
+	0x36CDB35296C507E7ULL, 0x077BA297888B2877ULL, 0x5B56D5F7BB4F0829ULL,
+	0xBF214C57EF0368CBULL, 0xE30C3B37DCC74895ULL, 0xE516D03CE895B78AULL,
+	0xB93BA75CDB5197D4ULL, 0x5D4C3EFC8F1DF736ULL, 0x0161499CBCD9D768ULL,
+	0x5179E8EAE7B80908ULL, 0x0D549F8AD47C2956ULL, 0xE923062A803049B4ULL,
+	0xB50E714AB3F469EAULL, 0xB3149A4187A696F5ULL, 0xEF39ED21B462B6ABULL,
+	0x0B4E7481E02ED649ULL, 0x576303E1D3EAF617ULL, 0xAB7F366D56ED6A89ULL,
+	0xF752410D65294AD7ULL, 0x1325D8AD31652A35ULL, 0x4F08AFCD02A10A6BULL,
+	0x491244C636F3F574ULL, 0x153F33A60537D52AULL, 0xF148AA06517BB5C8ULL,
+	0xAD65DD6662BF9596ULL, 0xFD7D7C1039DE4BF6ULL, 0xA1500B700A1A6BA8ULL,
+	0x452792D05E560B4AULL, 0x190AE5B06D922B14ULL, 0x1F100EBB59C0D40BULL,
+	0x433D79DB6A04F455ULL, 0xA74AE07B3E4894B7ULL, 0xFB67971B0D8CB4E9ULL,
+	0xCDAA24499B49B30EULL, 0x91875329A88D9350ULL, 0x75F0CA89FCC1F3B2ULL,
+	0x29DDBDE9CF05D3ECULL, 0x2FC756E2FB572CF3ULL, 0x73EA2182C8930CADULL,
+	0x979DB8229CDF6C4FULL, 0xCBB0CF42AF1B4C11ULL, 0x9BA86E34F47A9271ULL,
+	0xC7851954C7BEB22FULL, 0x23F280F493F2D2CDULL, 0x7FDFF794A036F293ULL,
+	0x79C51C9F94640D8CULL, 0x25E86BFFA7A02DD2ULL, 0xC19FF25FF3EC4D30ULL,
+	0x9DB2853FC0286D6EULL, 0x61AEB0B3452FF1F0ULL, 0x3D83C7D376EBD1AEULL,
+	0xD9F45E7322A7B14CULL, 0x85D9291311639112ULL, 0x83C3C21825316E0DULL,
+	0xDFEEB57816F54E53ULL, 0x3B992CD842B92EB1ULL, 0x67B45BB8717D0EEFULL,
+	0x37ACFACE2A1CD08FULL, 0x6B818DAE19D8F0D1ULL, 0x8FF6140E4D949033ULL,
+	0xD3DB636E7E50B06DULL, 0xD5C188654A024F72ULL, 0x89ECFF0579C66F2CULL,
+	0x6D9B66A52D8A0FCEULL, 0x31B611C51E4E2F90ULL, 0x0EF7452F111650EEULL,
+	0x52DA324F22D270B0ULL, 0xB6ADABEF769E1052ULL, 0xEA80DC8F455A300CULL,
+	0xEC9A37847108CF13ULL, 0xB0B740E442CCEF4DULL, 0x54C0D94416808FAFULL,
+	0x08EDAE242544AFF1ULL, 0x58F50F527E257191ULL, 0x04D878324DE151CFULL,
+	0xE0AFE19219AD312DULL, 0xBC8296F22A691173ULL, 0xBA987DF91E3BEE6CULL,
+	0xE6B50A992DFFCE32ULL, 0x02C2933979B3AED0ULL, 0x5EEFE4594A778E8EULL,
+	0xA2F3D1D5CF701210ULL, 0xFEDEA6B5FCB4324EULL, 0x1AA93F15A8F852ACULL,
+	0x468448759B3C72F2ULL, 0x409EA37EAF6E8DEDULL, 0x1CB3D41E9CAAADB3ULL,
+	0xF8C44DBEC8E6CD51ULL, 0xA4E93ADEFB22ED0FULL, 0xF4F19BA8A043336FULL,
+	0xA8DCECC893871331ULL, 0x4CAB7568C7CB73D3ULL, 0x10860208F40F538DULL,
+	0x169CE903C05DAC92ULL, 0x4AB19E63F3998CCCULL, 0xAEC607C3A7D5EC2EULL,
+	0xF2EB70A39411CC70ULL, 0xC426C3F102D4CB97ULL, 0x980BB4913110EBC9ULL,
+	0x7C7C2D31655C8B2BULL, 0x20515A515698AB75ULL, 0x264BB15A62CA546AULL,
+	0x7A66C63A510E7434ULL, 0x9E115F9A054214D6ULL, 0xC23C28FA36863488ULL,
+	0x9224898C6DE7EAE8ULL, 0xCE09FEEC5E23CAB6ULL, 0x2A7E674C0A6FAA54ULL,
+	0x7653102C39AB8A0AULL, 0x7049FB270DF97515ULL, 0x2C648C473E3D554BULL,
+	0xC81315E76A7135A9ULL, 0x943E628759B515F7ULL, 0x6822570BDCB28969ULL,
+	0x340F206BEF76A937ULL, 0xD078B9CBBB3AC9D5ULL, 0x8C55CEAB88FEE98BULL,
+	0x8A4F25A0BCAC1694ULL, 0xD66252C08F6836CAULL, 0x3215CB60DB245628ULL,
+	0x6E38BC00E8E07676ULL, 0x3E201D76B381A816ULL, 0x620D6A1680458848ULL,
+	0x867AF3B6D409E8AAULL, 0xDA5784D6E7CDC8F4ULL, 0xDC4D6FDDD39F37EBULL,
+	0x806018BDE05B17B5ULL, 0x6417811DB4177757ULL, 0x383AF67D87D35709ULL,
+	0x098CE7B8999D7899ULL, 0x55A190D8AA5958C7ULL, 0xB1D60978FE153825ULL,
+	0xEDFB7E18CDD1187BULL, 0xEBE19513F983E764ULL, 0xB7CCE273CA47C73AULL,
+	0x53BB7BD39E0BA7D8ULL, 0x0F960CB3ADCF8786ULL, 0x5F8EADC5F6AE59E6ULL,
+	0x03A3DAA5C56A79B8ULL, 0xE7D443059126195AULL, 0xBBF93465A2E23904ULL,
+	0xBDE3DF6E96B0C61BULL, 0xE1CEA80EA574E645ULL, 0x05B931AEF13886A7ULL,
+	0x599446CEC2FCA6F9ULL, 0xA588734247FB3A67ULL, 0xF9A50422743F1A39ULL,
+	0x1DD29D8220737ADBULL, 0x41FFEAE213B75A85ULL, 0x47E501E927E5A59AULL,
+	0x1BC87689142185C4ULL, 0xFFBFEF29406DE526ULL, 0xA392984973A9C578ULL,
+	0xF38A393F28C81B18ULL, 0xAFA74E5F1B0C3B46ULL, 0x4BD0D7FF4F405BA4ULL,
+	0x17FDA09F7C847BFAULL, 0x11E74B9448D684E5ULL, 0x4DCA3CF47B12A4BBULL,
+	0xA9BDA5542F5EC459ULL, 0xF590D2341C9AE407ULL, 0xC35D61668A5FE3E0ULL,
+	0x9F701606B99BC3BEULL, 0x7B078FA6EDD7A35CULL, 0x272AF8C6DE138302ULL,
+	0x213013CDEA417C1DULL, 0x7D1D64ADD9855C43ULL, 0x996AFD0D8DC93CA1ULL,
+	0xC5478A6DBE0D1CFFULL, 0x955F2B1BE56CC29FULL, 0xC9725C7BD6A8E2C1ULL,
+	0x2D05C5DB82E48223ULL, 0x7128B2BBB120A27DULL, 0x773259B085725D62ULL,
+	0x2B1F2ED0B6B67D3CULL, 0xCF68B770E2FA1DDEULL, 0x9345C010D13E3D80ULL,
+	0x6F59F59C5439A11EULL, 0x337482FC67FD8140ULL, 0xD7031B5C33B1E1A2ULL,
+	0x8B2E6C3C0075C1FCULL, 0x8D34873734273EE3ULL, 0xD119F05707E31EBDULL,
+	0x356E69F753AF7E5FULL, 0x69431E97606B5E01ULL, 0x395BBFE13B0A8061ULL,
+	0x6576C88108CEA03FULL, 0x810151215C82C0DDULL, 0xDD2C26416F46E083ULL,
+	0xDB36CD4A5B141F9CULL, 0x871BBA2A68D03FC2ULL, 0x636C238A3C9C5F20ULL,
+	0x3F4154EA0F587F7EULL,
+    },
+    {
+	0x0000000000000000ULL, 0x6184D55F721267C6ULL, 0xC309AABEE424CF8CULL,
+	0xA28D7FE19636A84AULL, 0x14CBFA566747819DULL, 0x754F2F091555E65BULL,
+	0xD7C250E883634E11ULL, 0xB64685B7F17129D7ULL, 0x2997F4ACCE8F033AULL,
+	0x481321F3BC9D64FCULL, 0xEA9E5E122AABCCB6ULL, 0x8B1A8B4D58B9AB70ULL,
+	0x3D5C0EFAA9C882A7ULL, 0x5CD8DBA5DBDAE561ULL, 0xFE55A4444DEC4D2BULL,
+	0x9FD1711B3FFE2AEDULL, 0x532FE9599D1E0674ULL, 0x32AB3C06EF0C61B2ULL,
+	0x902643E7793AC9F8ULL, 0xF1A296B80B28AE3EULL, 0x47E4130FFA5987E9ULL,
+	0x2660C650884BE02FULL, 0x84EDB9B11E7D4865ULL, 0xE5696CEE6C6F2FA3ULL,
+	0x7AB81DF55391054EULL, 0x1B3CC8AA21836288ULL, 0xB9B1B74BB7B5CAC2ULL,
+	0xD8356214C5A7AD04ULL, 0x6E73E7A334D684D3ULL, 0x0FF732FC46C4E315ULL,
+	0xAD7A4D1DD0F24B5FULL, 0xCCFE9842A2E02C99ULL, 0xA65FD2B33A3C0CE8ULL,
+	0xC7DB07EC482E6B2EULL, 0x6556780DDE18C364ULL, 0x04D2AD52AC0AA4A2ULL,
+	0xB29428E55D7B8D75ULL, 0xD310FDBA2F69EAB3ULL, 0x719D825BB95F42F9ULL,
+	0x10195704CB4D253FULL, 0x8FC8261FF4B30FD2ULL, 0xEE4CF34086A16814ULL,
+	0x4CC18CA11097C05EULL, 0x2D4559FE6285A798ULL, 0x9B03DC4993F48E4FULL,
+	0xFA870916E1E6E989ULL, 0x580A76F777D041C3ULL, 0x398EA3A805C22605ULL,
+	0xF5703BEAA7220A9CULL, 0x94F4EEB5D5306D5AULL, 0x367991544306C510ULL,
+	0x57FD440B3114A2D6ULL, 0xE1BBC1BCC0658B01ULL, 0x803F14E3B277ECC7ULL,
+	0x22B26B022441448DULL, 0x4336BE5D5653234BULL, 0xDCE7CF4669AD09A6ULL,
+	0xBD631A191BBF6E60ULL, 0x1FEE65F88D89C62AULL, 0x7E6AB0A7FF9BA1ECULL,
+	0xC82C35100EEA883BULL, 0xA9A8E04F7CF8EFFDULL, 0x0B259FAEEACE47B7ULL,
+	0x6AA14AF198DC2071ULL, 0xDE670A4DDB760755ULL, 0xBFE3DF12A9646093ULL,
+	0x1D6EA0F33F52C8D9ULL, 0x7CEA75AC4D40AF1FULL, 0xCAACF01BBC3186C8ULL,
+	0xAB282544CE23E10EULL, 0x09A55AA558154944ULL, 0x68218FFA2A072E82ULL,
+	0xF7F0FEE115F9046FULL, 0x96742BBE67EB63A9ULL, 0x34F9545FF1DDCBE3ULL,
+	0x557D810083CFAC25ULL, 0xE33B04B772BE85F2ULL, 0x82BFD1E800ACE234ULL,
+	0x2032AE09969A4A7EULL, 0x41B67B56E4882DB8ULL, 0x8D48E31446680121ULL,
+	0xECCC364B347A66E7ULL, 0x4E4149AAA24CCEADULL, 0x2FC59CF5D05EA96BULL,
+	0x99831942212F80BCULL, 0xF807CC1D533DE77AULL, 0x5A8AB3FCC50B4F30ULL,
+	0x3B0E66A3B71928F6ULL, 0xA4DF17B888E7021BULL, 0xC55BC2E7FAF565DDULL,
+	0x67D6BD066CC3CD97ULL, 0x065268591ED1AA51ULL, 0xB014EDEEEFA08386ULL,
+	0xD19038B19DB2E440ULL, 0x731D47500B844C0AULL, 0x1299920F79962BCCULL,
+	0x7838D8FEE14A0BBDULL, 0x19BC0DA193586C7BULL, 0xBB317240056EC431ULL,
+	0xDAB5A71F777CA3F7ULL, 0x6CF322A8860D8A20ULL, 0x0D77F7F7F41FEDE6ULL,
+	0xAFFA8816622945ACULL, 0xCE7E5D49103B226AULL, 0x51AF2C522FC50887ULL,
+	0x302BF90D5DD76F41ULL, 0x92A686ECCBE1C70BULL, 0xF32253B3B9F3A0CDULL,
+	0x4564D6044882891AULL, 0x24E0035B3A90EEDCULL, 0x866D7CBAACA64696ULL,
+	0xE7E9A9E5DEB42150ULL, 0x2B1731A77C540DC9ULL, 0x4A93E4F80E466A0FULL,
+	0xE81E9B199870C245ULL, 0x899A4E46EA62A583ULL, 0x3FDCCBF11B138C54ULL,
+	0x5E581EAE6901EB92ULL, 0xFCD5614FFF3743D8ULL, 0x9D51B4108D25241EULL,
+	0x0280C50BB2DB0EF3ULL, 0x63041054C0C96935ULL, 0xC1896FB556FFC17FULL,
+	0xA00DBAEA24EDA6B9ULL, 0x164B3F5DD59C8F6EULL, 0x77CFEA02A78EE8A8ULL,
+	0xD54295E331B840E2ULL, 0xB4C640BC43AA2724ULL, 0x2E16BBB019E2102FULL,
+	0x4F926EEF6BF077E9ULL, 0xED1F110EFDC6DFA3ULL, 0x8C9BC4518FD4B865ULL,
+	0x3ADD41E67EA591B2ULL, 0x5B5994B90CB7F674ULL, 0xF9D4EB589A815E3EULL,
+	0x98503E07E89339F8ULL, 0x07814F1CD76D1315ULL, 0x66059A43A57F74D3ULL,
+	0xC488E5A23349DC99ULL, 0xA50C30FD415BBB5FULL, 0x134AB54AB02A9288ULL,
+	0x72CE6015C238F54EULL, 0xD0431FF4540E5D04ULL, 0xB1C7CAAB261C3AC2ULL,
+	0x7D3952E984FC165BULL, 0x1CBD87B6F6EE719DULL, 0xBE30F85760D8D9D7ULL,
+	0xDFB42D0812CABE11ULL, 0x69F2A8BFE3BB97C6ULL, 0x08767DE091A9F000ULL,
+	0xAAFB0201079F584AULL, 0xCB7FD75E758D3F8CULL, 0x54AEA6454A731561ULL,
+	0x352A731A386172A7ULL, 0x97A70CFBAE57DAEDULL, 0xF623D9A4DC45BD2BULL,
+	0x40655C132D3494FCULL, 0x21E1894C5F26F33AULL, 0x836CF6ADC9105B70ULL,
+	0xE2E823F2BB023CB6ULL, 0x8849690323DE1CC7ULL, 0xE9CDBC5C51CC7B01ULL,
+	0x4B40C3BDC7FAD34BULL, 0x2AC416E2B5E8B48DULL, 0x9C82935544999D5AULL,
+	0xFD06460A368BFA9CULL, 0x5F8B39EBA0BD52D6ULL, 0x3E0FECB4D2AF3510ULL,
+	0xA1DE9DAFED511FFDULL, 0xC05A48F09F43783BULL, 0x62D737110975D071ULL,
+	0x0353E24E7B67B7B7ULL, 0xB51567F98A169E60ULL, 0xD491B2A6F804F9A6ULL,
+	0x761CCD476E3251ECULL, 0x179818181C20362AULL, 0xDB66805ABEC01AB3ULL,
+	0xBAE25505CCD27D75ULL, 0x186F2AE45AE4D53FULL, 0x79EBFFBB28F6B2F9ULL,
+	0xCFAD7A0CD9879B2EULL, 0xAE29AF53AB95FCE8ULL, 0x0CA4D0B23DA354A2ULL,
+	0x6D2005ED4FB13364ULL, 0xF2F174F6704F1989ULL, 0x9375A1A9025D7E4FULL,
+	0x31F8DE48946BD605ULL, 0x507C0B17E679B1C3ULL, 0xE63A8EA017089814ULL,
+	0x87BE5BFF651AFFD2ULL, 0x2533241EF32C5798ULL, 0x44B7F141813E305EULL,
+	0xF071B1FDC294177AULL, 0x91F564A2B08670BCULL, 0x33781B4326B0D8F6ULL,
+	0x52FCCE1C54A2BF30ULL, 0xE4BA4BABA5D396E7ULL, 0x853E9EF4D7C1F121ULL,
+	0x27B3E11541F7596BULL, 0x4637344A33E53EADULL, 0xD9E645510C1B1440ULL,
+	0xB862900E7E097386ULL, 0x1AEFEFEFE83FDBCCULL, 0x7B6B3AB09A2DBC0AULL,
+	0xCD2DBF076B5C95DDULL, 0xACA96A58194EF21BULL, 0x0E2415B98F785A51ULL,
+	0x6FA0C0E6FD6A3D97ULL, 0xA35E58A45F8A110EULL, 0xC2DA8DFB2D9876C8ULL,
+	0x6057F21ABBAEDE82ULL, 0x01D32745C9BCB944ULL, 0xB795A2F238CD9093ULL,
+	0xD61177AD4ADFF755ULL, 0x749C084CDCE95F1FULL, 0x1518DD13AEFB38D9ULL,
+	0x8AC9AC0891051234ULL, 0xEB4D7957E31775F2ULL, 0x49C006B67521DDB8ULL,
+	0x2844D3E90733BA7EULL, 0x9E02565EF64293A9ULL, 0xFF8683018450F46FULL,
+	0x5D0BFCE012665C25ULL, 0x3C8F29BF60743BE3ULL, 0x562E634EF8A81B92ULL,
+	0x37AAB6118ABA7C54ULL, 0x9527C9F01C8CD41EULL, 0xF4A31CAF6E9EB3D8ULL,
+	0x42E599189FEF9A0FULL, 0x23614C47EDFDFDC9ULL, 0x81EC33A67BCB5583ULL,
+	0xE068E6F909D93245ULL, 0x7FB997E2362718A8ULL, 0x1E3D42BD44357F6EULL,
+	0xBCB03D5CD203D724ULL, 0xDD34E803A011B0E2ULL, 0x6B726DB451609935ULL,
+	0x0AF6B8EB2372FEF3ULL, 0xA87BC70AB54456B9ULL, 0xC9FF1255C756317FULL,
+	0x05018A1765B61DE6ULL, 0x64855F4817A47A20ULL, 0xC60820A98192D26AULL,
+	0xA78CF5F6F380B5ACULL, 0x11CA704102F19C7BULL, 0x704EA51E70E3FBBDULL,
+	0xD2C3DAFFE6D553F7ULL, 0xB3470FA094C73431ULL, 0x2C967EBBAB391EDCULL,
+	0x4D12ABE4D92B791AULL, 0xEF9FD4054F1DD150ULL, 0x8E1B015A3D0FB696ULL,
+	0x385D84EDCC7E9F41ULL, 0x59D951B2BE6CF887ULL, 0xFB542E53285A50CDULL,
+	0x9AD0FB0C5A48370BULL,
+    },
+    {
+	0x0000000000000000ULL, 0x22EF0D5934F964ECULL, 0x45DE1AB269F2C9D8ULL,
+	0x673117EB5D0BAD34ULL, 0x8BBC3564D3E593B0ULL, 0xA953383DE71CF75CULL,
+	0xCE622FD6BA175A68ULL, 0xEC8D228F8EEE3E84ULL, 0x85A0C5E208C539E5ULL,
+	0xA74FC8BB3C3C5D09ULL, 0xC07EDF506137F03DULL, 0xE291D20955CE94D1ULL,
+	0x0E1CF086DB20AA55ULL, 0x2CF3FDDFEFD9CEB9ULL, 0x4BC2EA34B2D2638DULL,
+	0x692DE76D862B0761ULL, 0x999924EFBE846D4FULL, 0xBB7629B68A7D09A3ULL,
+	0xDC473E5DD776A497ULL, 0xFEA83304E38FC07BULL, 0x1225118B6D61FEFFULL,
+	0x30CA1CD259989A13ULL, 0x57FB0B3904933727ULL, 0x75140660306A53CBULL,
+	0x1C39E10DB64154AAULL, 0x3ED6EC5482B83046ULL, 0x59E7FBBFDFB39D72ULL,
+	0x7B08F6E6EB4AF99EULL, 0x9785D46965A4C71AULL, 0xB56AD930515DA3F6ULL,
+	0xD25BCEDB0C560EC2ULL, 0xF0B4C38238AF6A2EULL, 0xA1EAE6F4D206C41BULL,
+	0x8305EBADE6FFA0F7ULL, 0xE434FC46BBF40DC3ULL, 0xC6DBF11F8F0D692FULL,
+	0x2A56D39001E357ABULL, 0x08B9DEC9351A3347ULL, 0x6F88C92268119E73ULL,
+	0x4D67C47B5CE8FA9FULL, 0x244A2316DAC3FDFEULL, 0x06A52E4FEE3A9912ULL,
+	0x619439A4B3313426ULL, 0x437B34FD87C850CAULL, 0xAFF6167209266E4EULL,
+	0x8D191B2B3DDF0AA2ULL, 0xEA280CC060D4A796ULL, 0xC8C70199542DC37AULL,
+	0x3873C21B6C82A954ULL, 0x1A9CCF42587BCDB8ULL, 0x7DADD8A90570608CULL,
+	0x5F42D5F031890460ULL, 0xB3CFF77FBF673AE4ULL, 0x9120FA268B9E5E08ULL,
+	0xF611EDCDD695F33CULL, 0xD4FEE094E26C97D0ULL, 0xBDD307F9644790B1ULL,
+	0x9F3C0AA050BEF45DULL, 0xF80D1D4B0DB55969ULL, 0xDAE21012394C3D85ULL,
+	0x366F329DB7A20301ULL, 0x14803FC4835B67EDULL, 0x73B1282FDE50CAD9ULL,
+	0x515E2576EAA9AE35ULL, 0xD10D62C20B0396B3ULL, 0xF3E26F9B3FFAF25FULL,
+	0x94D3787062F15F6BULL, 0xB63C752956083B87ULL, 0x5AB157A6D8E60503ULL,
+	0x785E5AFFEC1F61EFULL, 0x1F6F4D14B114CCDBULL, 0x3D80404D85EDA837ULL,
+	0x54ADA72003C6AF56ULL, 0x7642AA79373FCBBAULL, 0x1173BD926A34668EULL,
+	0x339CB0CB5ECD0262ULL, 0xDF119244D0233CE6ULL, 0xFDFE9F1DE4DA580AULL,
+	0x9ACF88F6B9D1F53EULL, 0xB82085AF8D2891D2ULL, 0x4894462DB587FBFCULL,
+	0x6A7B4B74817E9F10ULL, 0x0D4A5C9FDC753224ULL, 0x2FA551C6E88C56C8ULL,
+	0xC32873496662684CULL, 0xE1C77E10529B0CA0ULL, 0x86F669FB0F90A194ULL,
+	0xA41964A23B69C578ULL, 0xCD3483CFBD42C219ULL, 0xEFDB8E9689BBA6F5ULL,
+	0x88EA997DD4B00BC1ULL, 0xAA059424E0496F2DULL, 0x4688B6AB6EA751A9ULL,
+	0x6467BBF25A5E3545ULL, 0x0356AC1907559871ULL, 0x21B9A14033ACFC9DULL,
+	0x70E78436D90552A8ULL, 0x5208896FEDFC3644ULL, 0x35399E84B0F79B70ULL,
+	0x17D693DD840EFF9CULL, 0xFB5BB1520AE0C118ULL, 0xD9B4BC0B3E19A5F4ULL,
+	0xBE85ABE0631208C0ULL, 0x9C6AA6B957EB6C2CULL, 0xF54741D4D1C06B4DULL,
+	0xD7A84C8DE5390FA1ULL, 0xB0995B66B832A295ULL, 0x9276563F8CCBC679ULL,
+	0x7EFB74B00225F8FDULL, 0x5C1479E936DC9C11ULL, 0x3B256E026BD73125ULL,
+	0x19CA635B5F2E55C9ULL, 0xE97EA0D967813FE7ULL, 0xCB91AD8053785B0BULL,
+	0xACA0BA6B0E73F63FULL, 0x8E4FB7323A8A92D3ULL, 0x62C295BDB464AC57ULL,
+	0x402D98E4809DC8BBULL, 0x271C8F0FDD96658FULL, 0x05F38256E96F0163ULL,
+	0x6CDE653B6F440602ULL, 0x4E3168625BBD62EEULL, 0x29007F8906B6CFDAULL,
+	0x0BEF72D0324FAB36ULL, 0xE762505FBCA195B2ULL, 0xC58D5D068858F15EULL,
+	0xA2BC4AEDD5535C6AULL, 0x805347B4E1AA3886ULL, 0x30C26AAFB90933E3ULL,
+	0x122D67F68DF0570FULL, 0x751C701DD0FBFA3BULL, 0x57F37D44E4029ED7ULL,
+	0xBB7E5FCB6AECA053ULL, 0x999152925E15C4BFULL, 0xFEA04579031E698BULL,
+	0xDC4F482037E70D67ULL, 0xB562AF4DB1CC0A06ULL, 0x978DA21485356EEAULL,
+	0xF0BCB5FFD83EC3DEULL, 0xD253B8A6ECC7A732ULL, 0x3EDE9A29622999B6ULL,
+	0x1C31977056D0FD5AULL, 0x7B00809B0BDB506EULL, 0x59EF8DC23F223482ULL,
+	0xA95B4E40078D5EACULL, 0x8BB4431933743A40ULL, 0xEC8554F26E7F9774ULL,
+	0xCE6A59AB5A86F398ULL, 0x22E77B24D468CD1CULL, 0x0008767DE091A9F0ULL,
+	0x67396196BD9A04C4ULL, 0x45D66CCF89636028ULL, 0x2CFB8BA20F486749ULL,
+	0x0E1486FB3BB103A5ULL, 0x6925911066BAAE91ULL, 0x4BCA9C495243CA7DULL,
+	0xA747BEC6DCADF4F9ULL, 0x85A8B39FE8549015ULL, 0xE299A474B55F3D21ULL,
+	0xC076A92D81A659CDULL, 0x91288C5B6B0FF7F8ULL, 0xB3C781025FF69314ULL,
+	0xD4F696E902FD3E20ULL, 0xF6199BB036045ACCULL, 0x1A94B93FB8EA6448ULL,
+	0x387BB4668C1300A4ULL, 0x5F4AA38DD118AD90ULL, 0x7DA5AED4E5E1C97CULL,
+	0x148849B963CACE1DULL, 0x366744E05733AAF1ULL, 0x5156530B0A3807C5ULL,
+	0x73B95E523EC16329ULL, 0x9F347CDDB02F5DADULL, 0xBDDB718484D63941ULL,
+	0xDAEA666FD9DD9475ULL, 0xF8056B36ED24F099ULL, 0x08B1A8B4D58B9AB7ULL,
+	0x2A5EA5EDE172FE5BULL, 0x4D6FB206BC79536FULL, 0x6F80BF5F88803783ULL,
+	0x830D9DD0066E0907ULL, 0xA1E2908932976DEBULL, 0xC6D387626F9CC0DFULL,
+	0xE43C8A3B5B65A433ULL, 0x8D116D56DD4EA352ULL, 0xAFFE600FE9B7C7BEULL,
+	0xC8CF77E4B4BC6A8AULL, 0xEA207ABD80450E66ULL, 0x06AD58320EAB30E2ULL,
+	0x2442556B3A52540EULL, 0x437342806759F93AULL, 0x619C4FD953A09DD6ULL,
+	0xE1CF086DB20AA550ULL, 0xC320053486F3C1BCULL, 0xA41112DFDBF86C88ULL,
+	0x86FE1F86EF010864ULL, 0x6A733D0961EF36E0ULL, 0x489C30505516520CULL,
+	0x2FAD27BB081DFF38ULL, 0x0D422AE23CE49BD4ULL, 0x646FCD8FBACF9CB5ULL,
+	0x4680C0D68E36F859ULL, 0x21B1D73DD33D556DULL, 0x035EDA64E7C43181ULL,
+	0xEFD3F8EB692A0F05ULL, 0xCD3CF5B25DD36BE9ULL, 0xAA0DE25900D8C6DDULL,
+	0x88E2EF003421A231ULL, 0x78562C820C8EC81FULL, 0x5AB921DB3877ACF3ULL,
+	0x3D883630657C01C7ULL, 0x1F673B695185652BULL, 0xF3EA19E6DF6B5BAFULL,
+	0xD10514BFEB923F43ULL, 0xB6340354B6999277ULL, 0x94DB0E0D8260F69BULL,
+	0xFDF6E960044BF1FAULL, 0xDF19E43930B29516ULL, 0xB828F3D26DB93822ULL,
+	0x9AC7FE8B59405CCEULL, 0x764ADC04D7AE624AULL, 0x54A5D15DE35706A6ULL,
+	0x3394C6B6BE5CAB92ULL, 0x117BCBEF8AA5CF7EULL, 0x4025EE99600C614BULL,
+	0x62CAE3C054F505A7ULL, 0x05FBF42B09FEA893ULL, 0x2714F9723D07CC7FULL,
+	0xCB99DBFDB3E9F2FBULL, 0xE976D6A487109617ULL, 0x8E47C14FDA1B3B23ULL,
+	0xACA8CC16EEE25FCFULL, 0xC5852B7B68C958AEULL, 0xE76A26225C303C42ULL,
+	0x805B31C9013B9176ULL, 0xA2B43C9035C2F59AULL, 0x4E391E1FBB2CCB1EULL,
+	0x6CD613468FD5AFF2ULL, 0x0BE704ADD2DE02C6ULL, 0x290809F4E627662AULL,
+	0xD9BCCA76DE880C04ULL, 0xFB53C72FEA7168E8ULL, 0x9C62D0C4B77AC5DCULL,
+	0xBE8DDD9D8383A130ULL, 0x5200FF120D6D9FB4ULL, 0x70EFF24B3994FB58ULL,
+	0x17DEE5A0649F566CULL, 0x3531E8F950663280ULL, 0x5C1C0F94D64D35E1ULL,
+	0x7EF302CDE2B4510DULL, 0x19C21526BFBFFC39ULL, 0x3B2D187F8B4698D5ULL,
+	0xD7A03AF005A8A651ULL, 0xF54F37A93151C2BDULL, 0x927E20426C5A6F89ULL,
+	0xB0912D1B58A30B65ULL,
+    },
+    {
+	0x0000000000000000ULL, 0xDABE95AFC7875F40ULL, 0x27A584742000A005ULL,
+	0xFD1B11DBE787FF45ULL, 0x4F4B08E84001400AULL, 0x95F59D4787861F4AULL,
+	0x68EE8C9C6001E00FULL, 0xB2501933A786BF4FULL, 0x9E9611D080028014ULL,
+	0x4428847F4785DF54ULL, 0xB93395A4A0022011ULL, 0x638D000B67857F51ULL,
+	0xD1DD1938C003C01EULL, 0x0B638C9707849F5EULL, 0xF6789D4CE003601BULL,
+	0x2CC608E327843F5BULL, 0xAFF48C8AAF0B1EADULL, 0x754A1925688C41EDULL,
+	0x885108FE8F0BBEA8ULL, 0x52EF9D51488CE1E8ULL, 0xE0BF8462EF0A5EA7ULL,
+	0x3A0111CD288D01E7ULL, 0xC71A0016CF0AFEA2ULL, 0x1DA495B9088DA1E2ULL,
+	0x31629D5A2F099EB9ULL, 0xEBDC08F5E88EC1F9ULL, 0x16C7192E0F093EBCULL,
+	0xCC798C81C88E61FCULL, 0x7E2995B26F08DEB3ULL, 0xA497001DA88F81F3ULL,
+	0x598C11C64F087EB6ULL, 0x83328469888F21F6ULL, 0xCD31B63EF11823DFULL,
+	0x178F2391369F7C9FULL, 0xEA94324AD11883DAULL, 0x302AA7E5169FDC9AULL,
+	0x827ABED6B11963D5ULL, 0x58C42B79769E3C95ULL, 0xA5DF3AA29119C3D0ULL,
+	0x7F61AF0D569E9C90ULL, 0x53A7A7EE711AA3CBULL, 0x89193241B69DFC8BULL,
+	0x7402239A511A03CEULL, 0xAEBCB635969D5C8EULL, 0x1CECAF06311BE3C1ULL,
+	0xC6523AA9F69CBC81ULL, 0x3B492B72111B43C4ULL, 0xE1F7BEDDD69C1C84ULL,
+	0x62C53AB45E133D72ULL, 0xB87BAF1B99946232ULL, 0x4560BEC07E139D77ULL,
+	0x9FDE2B6FB994C237ULL, 0x2D8E325C1E127D78ULL, 0xF730A7F3D9952238ULL,
+	0x0A2BB6283E12DD7DULL, 0xD0952387F995823DULL, 0xFC532B64DE11BD66ULL,
+	0x26EDBECB1996E226ULL, 0xDBF6AF10FE111D63ULL, 0x01483ABF39964223ULL,
+	0xB318238C9E10FD6CULL, 0x69A6B6235997A22CULL, 0x94BDA7F8BE105D69ULL,
+	0x4E03325779970229ULL, 0x08BBC3564D3E593BULL, 0xD20556F98AB9067BULL,
+	0x2F1E47226D3EF93EULL, 0xF5A0D28DAAB9A67EULL, 0x47F0CBBE0D3F1931ULL,
+	0x9D4E5E11CAB84671ULL, 0x60554FCA2D3FB934ULL, 0xBAEBDA65EAB8E674ULL,
+	0x962DD286CD3CD92FULL, 0x4C9347290ABB866FULL, 0xB18856F2ED3C792AULL,
+	0x6B36C35D2ABB266AULL, 0xD966DA6E8D3D9925ULL, 0x03D84FC14ABAC665ULL,
+	0xFEC35E1AAD3D3920ULL, 0x247DCBB56ABA6660ULL, 0xA74F4FDCE2354796ULL,
+	0x7DF1DA7325B218D6ULL, 0x80EACBA8C235E793ULL, 0x5A545E0705B2B8D3ULL,
+	0xE8044734A234079CULL, 0x32BAD29B65B358DCULL, 0xCFA1C3408234A799ULL,
+	0x151F56EF45B3F8D9ULL, 0x39D95E0C6237C782ULL, 0xE367CBA3A5B098C2ULL,
+	0x1E7CDA7842376787ULL, 0xC4C24FD785B038C7ULL, 0x769256E422368788ULL,
+	0xAC2CC34BE5B1D8C8ULL, 0x5137D2900236278DULL, 0x8B89473FC5B178CDULL,
+	0xC58A7568BC267AE4ULL, 0x1F34E0C77BA125A4ULL, 0xE22FF11C9C26DAE1ULL,
+	0x389164B35BA185A1ULL, 0x8AC17D80FC273AEEULL, 0x507FE82F3BA065AEULL,
+	0xAD64F9F4DC279AEBULL, 0x77DA6C5B1BA0C5ABULL, 0x5B1C64B83C24FAF0ULL,
+	0x81A2F117FBA3A5B0ULL, 0x7CB9E0CC1C245AF5ULL, 0xA6077563DBA305B5ULL,
+	0x14576C507C25BAFAULL, 0xCEE9F9FFBBA2E5BAULL, 0x33F2E8245C251AFFULL,
+	0xE94C7D8B9BA245BFULL, 0x6A7EF9E2132D6449ULL, 0xB0C06C4DD4AA3B09ULL,
+	0x4DDB7D96332DC44CULL, 0x9765E839F4AA9B0CULL, 0x2535F10A532C2443ULL,
+	0xFF8B64A594AB7B03ULL, 0x0290757E732C8446ULL, 0xD82EE0D1B4ABDB06ULL,
+	0xF4E8E832932FE45DULL, 0x2E567D9D54A8BB1DULL, 0xD34D6C46B32F4458ULL,
+	0x09F3F9E974A81B18ULL, 0xBBA3E0DAD32EA457ULL, 0x611D757514A9FB17ULL,
+	0x9C0664AEF32E0452ULL, 0x46B8F10134A95B12ULL, 0x117786AC9A7CB276ULL,
+	0xCBC913035DFBED36ULL, 0x36D202D8BA7C1273ULL, 0xEC6C97777DFB4D33ULL,
+	0x5E3C8E44DA7DF27CULL, 0x84821BEB1DFAAD3CULL, 0x79990A30FA7D5279ULL,
+	0xA3279F9F3DFA0D39ULL, 0x8FE1977C1A7E3262ULL, 0x555F02D3DDF96D22ULL,
+	0xA84413083A7E9267ULL, 0x72FA86A7FDF9CD27ULL, 0xC0AA9F945A7F7268ULL,
+	0x1A140A3B9DF82D28ULL, 0xE70F1BE07A7FD26DULL, 0x3DB18E4FBDF88D2DULL,
+	0xBE830A263577ACDBULL, 0x643D9F89F2F0F39BULL, 0x99268E5215770CDEULL,
+	0x43981BFDD2F0539EULL, 0xF1C802CE7576ECD1ULL, 0x2B769761B2F1B391ULL,
+	0xD66D86BA55764CD4ULL, 0x0CD3131592F11394ULL, 0x20151BF6B5752CCFULL,
+	0xFAAB8E5972F2738FULL, 0x07B09F8295758CCAULL, 0xDD0E0A2D52F2D38AULL,
+	0x6F5E131EF5746CC5ULL, 0xB5E086B132F33385ULL, 0x48FB976AD574CCC0ULL,
+	0x924502C512F39380ULL, 0xDC4630926B6491A9ULL, 0x06F8A53DACE3CEE9ULL,
+	0xFBE3B4E64B6431ACULL, 0x215D21498CE36EECULL, 0x930D387A2B65D1A3ULL,
+	0x49B3ADD5ECE28EE3ULL, 0xB4A8BC0E0B6571A6ULL, 0x6E1629A1CCE22EE6ULL,
+	0x42D02142EB6611BDULL, 0x986EB4ED2CE14EFDULL, 0x6575A536CB66B1B8ULL,
+	0xBFCB30990CE1EEF8ULL, 0x0D9B29AAAB6751B7ULL, 0xD725BC056CE00EF7ULL,
+	0x2A3EADDE8B67F1B2ULL, 0xF08038714CE0AEF2ULL, 0x73B2BC18C46F8F04ULL,
+	0xA90C29B703E8D044ULL, 0x5417386CE46F2F01ULL, 0x8EA9ADC323E87041ULL,
+	0x3CF9B4F0846ECF0EULL, 0xE647215F43E9904EULL, 0x1B5C3084A46E6F0BULL,
+	0xC1E2A52B63E9304BULL, 0xED24ADC8446D0F10ULL, 0x379A386783EA5050ULL,
+	0xCA8129BC646DAF15ULL, 0x103FBC13A3EAF055ULL, 0xA26FA520046C4F1AULL,
+	0x78D1308FC3EB105AULL, 0x85CA2154246CEF1FULL, 0x5F74B4FBE3EBB05FULL,
+	0x19CC45FAD742EB4DULL, 0xC372D05510C5B40DULL, 0x3E69C18EF7424B48ULL,
+	0xE4D7542130C51408ULL, 0x56874D129743AB47ULL, 0x8C39D8BD50C4F407ULL,
+	0x7122C966B7430B42ULL, 0xAB9C5CC970C45402ULL, 0x875A542A57406B59ULL,
+	0x5DE4C18590C73419ULL, 0xA0FFD05E7740CB5CULL, 0x7A4145F1B0C7941CULL,
+	0xC8115CC217412B53ULL, 0x12AFC96DD0C67413ULL, 0xEFB4D8B637418B56ULL,
+	0x350A4D19F0C6D416ULL, 0xB638C9707849F5E0ULL, 0x6C865CDFBFCEAAA0ULL,
+	0x919D4D04584955E5ULL, 0x4B23D8AB9FCE0AA5ULL, 0xF973C1983848B5EAULL,
+	0x23CD5437FFCFEAAAULL, 0xDED645EC184815EFULL, 0x0468D043DFCF4AAFULL,
+	0x28AED8A0F84B75F4ULL, 0xF2104D0F3FCC2AB4ULL, 0x0F0B5CD4D84BD5F1ULL,
+	0xD5B5C97B1FCC8AB1ULL, 0x67E5D048B84A35FEULL, 0xBD5B45E77FCD6ABEULL,
+	0x4040543C984A95FBULL, 0x9AFEC1935FCDCABBULL, 0xD4FDF3C4265AC892ULL,
+	0x0E43666BE1DD97D2ULL, 0xF35877B0065A6897ULL, 0x29E6E21FC1DD37D7ULL,
+	0x9BB6FB2C665B8898ULL, 0x41086E83A1DCD7D8ULL, 0xBC137F58465B289DULL,
+	0x66ADEAF781DC77DDULL, 0x4A6BE214A6584886ULL, 0x90D577BB61DF17C6ULL,
+	0x6DCE66608658E883ULL, 0xB770F3CF41DFB7C3ULL, 0x0520EAFCE659088CULL,
+	0xDF9E7F5321DE57CCULL, 0x22856E88C659A889ULL, 0xF83BFB2701DEF7C9ULL,
+	0x7B097F4E8951D63FULL, 0xA1B7EAE14ED6897FULL, 0x5CACFB3AA951763AULL,
+	0x86126E956ED6297AULL, 0x344277A6C9509635ULL, 0xEEFCE2090ED7C975ULL,
+	0x13E7F3D2E9503630ULL, 0xC959667D2ED76970ULL, 0xE59F6E9E0953562BULL,
+	0x3F21FB31CED4096BULL, 0xC23AEAEA2953F62EULL, 0x18847F45EED4A96EULL,
+	0xAAD4667649521621ULL, 0x706AF3D98ED54961ULL, 0x8D71E2026952B624ULL,
+	0x57CF77ADAED5E964ULL,
+    },
+};
+
+static uint64_t
+crc64_slice8(const uint8_t *p, size_t size, uint64_t crc)
+{
+	uint64_t v;
+
+	while (size && ((uintptr_t)p & 7)) {
+		crc = crc64Table[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+		--size;
+	}
+	while (size >= 8) {
+		v = crc ^ ((uint64_t)p[0] | (uint64_t)p[1] << 8 |
+			   (uint64_t)p[2] << 16 | (uint64_t)p[3] << 24 |
+			   (uint64_t)p[4] << 32 | (uint64_t)p[5] << 40 |
+			   (uint64_t)p[6] << 48 | (uint64_t)p[7] << 56);
+		crc = crc64Table[7][v & 0xff] ^
+		      crc64Table[6][(v >> 8) & 0xff] ^
+		      crc64Table[5][(v >> 16) & 0xff] ^
+		      crc64Table[4][(v >> 24) & 0xff] ^
+		      crc64Table[3][(v >> 32) & 0xff] ^
+		      crc64Table[2][(v >> 40) & 0xff] ^
+		      crc64Table[1][(v >> 48) & 0xff] ^
+		      crc64Table[0][v >> 56];
+		p += 8;
+		size -= 8;
+	}
+	while (size--)
+		crc = crc64Table[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+	return (crc);
+}
+
+uint64_t
+crc64(const void *buf, size_t size)
+{
+	return (crc64_slice8(buf, size, ~(uint64_t)0) ^ ~(uint64_t)0);
+}
+
+uint64_t
+crc64_ext(const void *buf, size_t size, uint64_t crc)
+{
+	return (crc64_slice8(buf, size, crc ^ ~(uint64_t)0) ^ ~(uint64_t)0);
+}
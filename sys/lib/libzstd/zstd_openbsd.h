@@ -0,0 +1,58 @@
+/*	$OpenBSD$	*/
+
+/*
+ * Kernel environment for the zstd sources.  Every libc header the
+ * upstream files pull in is redirected here when _KERNEL is defined.
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef _LIB_LIBZSTD_ZSTD_OPENBSD_H_
+#define _LIB_LIBZSTD_ZSTD_OPENBSD_H_
+
+#include <sys/param.h>
+#include <sys/systm.h>
+#include <sys/malloc.h>
+#include <sys/stdint.h>
+#include <sys/limits.h>
+
+#ifndef _PTRDIFF_T_DEFINED_
+#define _PTRDIFF_T_DEFINED_
+typedef __ptrdiff_t	ptrdiff_t;
+#endif
+
+#ifndef alignas
+#define alignas		_Alignas
+#endif
+
+/*
+ * No FPU/SIMD state in the kernel, no runtime CPU dispatch, no
+ * hand-written assembly and no tracing hooks.
+ */
+#ifndef ZSTD_NO_INTRINSICS
+#define ZSTD_NO_INTRINSICS
+#endif
+#ifndef ZSTD_DISABLE_ASM
+#define ZSTD_DISABLE_ASM	1
+#endif
+#ifndef DYNAMIC_BMI2
+#define DYNAMIC_BMI2		0
+#endif
+#ifndef ZSTD_TRACE
+#define ZSTD_TRACE		0
+#endif
+#ifndef XXH_NO_STDLIB
+#define XXH_NO_STDLIB
+#endif
+
+#endif /* _LIB_LIBZSTD_ZSTD_OPENBSD_H_ */
@@ -360,5 +360,7 @@ int	_kernel_lock_held(void);
 
 uint32_t iscsi_crc32(const void *buf, size_t size);
 uint32_t iscsi_crc32_ext(const void *buf, size_t size, uint32_t ocrc);
+uint64_t crc64(const void *buf, size_t size);
+uint64_t crc64_ext(const void *buf, size_t size, uint64_t ocrc);
 
 #endif /* __SYSTM_H__ */